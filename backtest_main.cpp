@@ -0,0 +1,179 @@
+// Headless backtest runner: no window, no network, just candles through the engine.
+//   backtest <candles.csv|candles.bin|--synthetic N> [sma FAST SLOW | rsi PERIOD LOW HIGH | hold] [options]
+// Binary candle files are memory-mapped and shared by every run of a sweep.
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include "src/backtest/backtest.h"
+#include "src/backtest/optimizer.h"
+#include "src/backtest/strategies.h"
+#include "src/integration/candle_series.h"
+
+using namespace std;
+
+static void printUsage(const char* program) {
+    cerr << "usage: " << program << " <candles.csv|candles.bin|--synthetic N>\n"
+         << "  [sma FAST SLOW | rsi PERIOD LOW HIGH | hold]\n"
+         << "  --commission PER_SHARE   --slippage BPS   --equity out.csv\n"
+         << "  --save-binary out.bin                      convert the input and exit\n"
+         << "  --sweep FAST_MIN FAST_MAX SLOW_MIN SLOW_MAX STEP\n"
+         << "  --walk-forward TRAIN_BARS TEST_BARS         (with --sweep ranges)\n"
+         << "  --threads N   --csv results.csv" << endl;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    CandleSeries owned;
+    MappedCandles mapped;
+    CandleView candles;
+    int arg = 1;
+    if (strcmp(argv[arg], "--synthetic") == 0 && arg + 1 < argc) {
+        owned = syntheticCandles(stoul(argv[arg + 1]));
+        candles = owned.view();
+        arg += 2;
+    } else if (mapped.open(argv[arg])) {
+        candles = mapped.view();
+        arg += 1;
+    } else {
+        if (!loadCandlesCsv(argv[arg], owned)) {
+            cerr << "Could not read " << argv[arg] << endl;
+            return 1;
+        }
+        candles = owned.view();
+        arg += 1;
+    }
+
+    unique_ptr<Strategy> strategy = makeStrategy<SmaCrossover>(10, 30);
+    BacktestConfig config;
+    string equity_path, csv_path, binary_path;
+    vector<ParameterRange> sweep;
+    size_t train_bars = 0, test_bars = 0;
+    size_t threads = thread::hardware_concurrency();
+    while (arg < argc) {
+        string option = argv[arg];
+        if (option == "sma" && arg + 2 < argc) {
+            strategy = makeStrategy<SmaCrossover>(stoul(argv[arg + 1]), stoul(argv[arg + 2]));
+            arg += 3;
+        } else if (option == "rsi" && arg + 3 < argc) {
+            strategy = makeStrategy<RsiReversion>(stoul(argv[arg + 1]), stod(argv[arg + 2]), stod(argv[arg + 3]));
+            arg += 4;
+        } else if (option == "hold") {
+            strategy = makeStrategy<BuyAndHold>();
+            arg += 1;
+        } else if (option == "--commission" && arg + 1 < argc) {
+            config.costs.commission_per_share = stod(argv[arg + 1]);
+            arg += 2;
+        } else if (option == "--slippage" && arg + 1 < argc) {
+            config.costs.slippage_bps = stod(argv[arg + 1]);
+            arg += 2;
+        } else if (option == "--equity" && arg + 1 < argc) {
+            equity_path = argv[arg + 1];
+            arg += 2;
+        } else if (option == "--save-binary" && arg + 1 < argc) {
+            binary_path = argv[arg + 1];
+            arg += 2;
+        } else if (option == "--sweep" && arg + 5 < argc) {
+            double step = stod(argv[arg + 5]);
+            sweep = {{"fast", stod(argv[arg + 1]), stod(argv[arg + 2]), step},
+                     {"slow", stod(argv[arg + 3]), stod(argv[arg + 4]), step}};
+            arg += 6;
+        } else if (option == "--walk-forward" && arg + 2 < argc) {
+            train_bars = stoul(argv[arg + 1]);
+            test_bars = stoul(argv[arg + 2]);
+            arg += 3;
+        } else if (option == "--threads" && arg + 1 < argc) {
+            threads = stoul(argv[arg + 1]);
+            arg += 2;
+        } else if (option == "--csv" && arg + 1 < argc) {
+            csv_path = argv[arg + 1];
+            arg += 2;
+        } else {
+            cerr << "Unknown option " << option << endl;
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (!binary_path.empty()) {
+        CandleSeries copy;
+        copy.time.assign(candles.time, candles.time + candles.size());
+        copy.open.assign(candles.open, candles.open + candles.size());
+        copy.high.assign(candles.high, candles.high + candles.size());
+        copy.low.assign(candles.low, candles.low + candles.size());
+        copy.close.assign(candles.close, candles.close + candles.size());
+        copy.volume.assign(candles.volume, candles.volume + candles.size());
+        if (!saveCandlesBinary(binary_path, copy)) {
+            cerr << "Could not write " << binary_path << endl;
+            return 1;
+        }
+        printf("wrote %zu candles to %s\n", copy.size(), binary_path.c_str());
+        return 0;
+    }
+
+    Backtester backtester(config);
+    if (!sweep.empty()) {
+        StrategyFactory factory = [](const vector<double>& p) -> unique_ptr<Strategy> {
+            if (p[0] >= p[1]) return nullptr; // fast must be shorter than slow
+            return makeStrategy<SmaCrossover>(static_cast<size_t>(p[0]), static_cast<size_t>(p[1]));
+        };
+        WorkStealingPool pool(threads);
+        auto started = chrono::steady_clock::now();
+        size_t runs = 0;
+        if (train_bars > 0) {
+            vector<WalkForwardWindow> windows = runWalkForward(candles, sweep, factory, backtester, Objective::Sharpe,
+                                                               train_bars, test_bars, pool);
+            runs = windows.size() * (expandGrid(sweep).size() + 1);
+            for (const auto& w : windows) {
+                printf("train [%zu,%zu) fast=%g slow=%g sharpe=%.2f | test [%zu,%zu) return=%.2f%% sharpe=%.2f\n",
+                       w.train_begin, w.train_end, w.best_params[0], w.best_params[1], w.train_score, w.test_begin,
+                       w.test_end, w.test_stats.total_return * 100.0, w.test_stats.sharpe);
+            }
+            if (!csv_path.empty()) writeWalkForwardCsv(csv_path, sweep, windows);
+        } else {
+            vector<SweepResult> results = runSweep(candles, 0, candles.size(), expandGrid(sweep), factory, backtester,
+                                                   Objective::Sharpe, pool);
+            runs = results.size();
+            const SweepResult* best = nullptr;
+            for (const auto& result : results) {
+                if (result.stats.bars > 0 && (!best || result.score > best->score)) best = &result;
+            }
+            if (best) {
+                printf("best: fast=%g slow=%g sharpe=%.2f return=%.2f%%\n", best->params[0], best->params[1],
+                       best->score, best->stats.total_return * 100.0);
+            }
+            if (!csv_path.empty()) writeSweepCsv(csv_path, sweep, results);
+        }
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - started).count();
+        printf("%zu runs on %zu threads in %.3f s\n", runs, pool.size(), seconds);
+        return 0;
+    }
+
+    BacktestResult result = backtester.run(candles, *strategy);
+    const BacktestStats& stats = result.stats;
+    printf("bars:          %zu\n", stats.bars);
+    printf("fills:         %zu\n", stats.fills);
+    printf("final equity:  %.2f\n", stats.final_equity);
+    printf("total return:  %.2f%%\n", stats.total_return * 100.0);
+    printf("max drawdown:  %.2f%%\n", stats.max_drawdown * 100.0);
+    printf("sharpe:        %.2f\n", stats.sharpe);
+    printf("commissions:   %.2f\n", stats.commissions);
+    printf("elapsed:       %.3f s (%.1f M bars/sec)\n", stats.elapsed_seconds,
+           stats.elapsed_seconds > 0.0 ? static_cast<double>(stats.bars) / stats.elapsed_seconds / 1e6 : 0.0);
+
+    if (!equity_path.empty()) {
+        ofstream out(equity_path);
+        out << "time,equity\n";
+        for (size_t i = 0; i < result.equity_curve.size(); ++i) {
+            out << candles.time[i] << ',' << result.equity_curve[i] << '\n';
+        }
+    }
+    return 0;
+}
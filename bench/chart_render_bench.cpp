@@ -0,0 +1,163 @@
+// Draws the candlestick chart headlessly (ImGui/ImPlot contexts, no window or GL) and counts
+// heap allocations per frame. Once warmed up, the chart reads from the pyramid and ImGui
+// reuses its draw buffers, so a frame with no new candles should allocate nothing.
+// --rebuild copies the history into fresh column vectors every frame, as the chart used to.
+//   chart_render_bench [candles] [frames] [--rebuild]
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+#include <imgui.h>
+#include <implot.h>
+#include "../src/graph/graph_plotter.h"
+
+using namespace std;
+
+// Both operator new and ImGui's allocator hooks feed these, so ImGui/ImPlot growth is counted too
+static size_t allocations = 0;
+static size_t allocated_bytes = 0;
+
+void* operator new(size_t size) {
+    allocations++;
+    allocated_bytes += size;
+    if (void* p = malloc(size ? size : 1)) return p;
+    throw bad_alloc();
+}
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+
+static void* countedAlloc(size_t size, void*) {
+    allocations++;
+    allocated_bytes += size;
+    return malloc(size);
+}
+static void countedFree(void* p, void*) { free(p); }
+
+struct Candles {
+    vector<double> time, open, high, low, close;
+};
+
+static Candles randomWalk(size_t count) {
+    Candles candles;
+    mt19937_64 rng(42);
+    normal_distribution<double> shock(0.0, 0.002);
+    double price = 100.0;
+    for (size_t i = 0; i < count; ++i) {
+        double open = price;
+        price *= exp(shock(rng));
+        candles.time.push_back(static_cast<double>(i));
+        candles.open.push_back(open);
+        candles.close.push_back(price);
+        candles.high.push_back(max(open, price) * (1.0 + fabs(shock(rng))));
+        candles.low.push_back(min(open, price) * (1.0 - fabs(shock(rng))));
+    }
+    return candles;
+}
+
+int main(int argc, char** argv) {
+    size_t count = 1000000, frames = 600;
+    bool rebuild = false;
+    vector<string> positional;
+    for (int arg = 1; arg < argc; ++arg) {
+        if (strcmp(argv[arg], "--rebuild") == 0) {
+            rebuild = true;
+        } else {
+            positional.push_back(argv[arg]);
+        }
+    }
+    if (positional.size() > 0) count = stoul(positional[0]);
+    if (positional.size() > 1) frames = stoul(positional[1]);
+
+    ImGui::SetAllocatorFunctions(countedAlloc, countedFree);
+    ImGui::CreateContext();
+    ImPlot::CreateContext();
+    ImGuiIO& io = ImGui::GetIO();
+    io.DisplaySize = ImVec2(1600.0f, 900.0f);
+    io.IniFilename = nullptr;
+    unsigned char* pixels = nullptr;
+    int width = 0, height = 0;
+    io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height); // what a renderer backend does at startup
+
+    Candles history = randomWalk(count);
+    CandleColumns source;
+    source.time = history.time.data();
+    source.open = history.open.data();
+    source.high = history.high.data();
+    source.low = history.low.data();
+    source.close = history.close.data();
+    source.count = static_cast<int>(count);
+
+    CandlePyramid pyramid;
+    pyramid.assign(source);
+    ChartAutoRange auto_range;
+    DecimatedLine close_line;
+    CandleColumns base = pyramid.level(0);
+
+    const size_t warmup = 10;
+    size_t steady_allocations = 0, steady_bytes = 0;
+    double steady_ms = 0.0;
+    vector<double> time, open, high, low, close; // only used with --rebuild
+    for (size_t frame = 0; frame < warmup + frames; ++frame) {
+        size_t allocations_before = allocations, bytes_before = allocated_bytes;
+        auto start = chrono::steady_clock::now();
+
+        io.DeltaTime = 1.0f / 60.0f;
+        ImGui::NewFrame();
+        ImGui::SetNextWindowPos(ImVec2(0.0f, 0.0f));
+        ImGui::SetNextWindowSize(io.DisplaySize);
+        ImGui::Begin("Stock Price Chart");
+        if (ImPlot::BeginPlot("Candle Stick Chart", ImVec2(-1.0f, -1.0f))) {
+            double x_min = 0.0, x_max = static_cast<double>(count);
+            double y_min = 0.0, y_max = 0.0;
+            ImPlot::SetupAxes("Time", "Price");
+            ImPlot::SetupAxisLimits(ImAxis_X1, x_min, x_max, ImGuiCond_Always);
+            if (auto_range.limits(pyramid, x_min, x_max, y_min, y_max)) {
+                ImPlot::SetupAxisLimits(ImAxis_Y1, y_min, y_max, ImGuiCond_Always);
+            }
+            if (rebuild) {
+                time = vector<double>(history.time);
+                open = vector<double>(history.open);
+                high = vector<double>(history.high);
+                low = vector<double>(history.low);
+                close = vector<double>(history.close);
+                CandleColumns columns;
+                columns.time = time.data();
+                columns.open = open.data();
+                columns.high = high.data();
+                columns.low = low.data();
+                columns.close = close.data();
+                columns.count = static_cast<int>(time.size());
+                PlotCandlesticks("AAPL", columns);
+            } else {
+                PlotCandlesticks("AAPL", pyramid);
+            }
+            close_line.plot("Close", base.time, base.close, base.count);
+            ImPlot::EndPlot();
+        }
+        ImGui::End();
+        ImGui::Render();
+
+        double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        if (frame >= warmup) {
+            steady_allocations += allocations - allocations_before;
+            steady_bytes += allocated_bytes - bytes_before;
+            steady_ms += ms;
+        }
+    }
+
+    ImDrawData* draw_data = ImGui::GetDrawData();
+    printf("%zu candles, %zu frames%s, %d vertices in the last frame\n", count, frames,
+           rebuild ? " (rebuilding columns each frame)" : "", draw_data ? draw_data->TotalVtxCount : 0);
+    printf("Steady state: %.2f allocations/frame, %.0f bytes/frame, %.3f ms/frame\n",
+           static_cast<double>(steady_allocations) / static_cast<double>(frames),
+           static_cast<double>(steady_bytes) / static_cast<double>(frames), steady_ms / static_cast<double>(frames));
+
+    ImPlot::DestroyContext();
+    ImGui::DestroyContext();
+    return steady_allocations == 0 || rebuild ? 0 : 1;
+}
@@ -0,0 +1,77 @@
+// Order throughput of TradingEngine at 1/2/4/8 shards.
+// One gateway thread per shard feeds orders for that shard's symbols, a drain thread
+// plays the portfolio side and empties the sequencer.
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../src/engine/trading_engine.h"
+
+using namespace std;
+
+static double runOnce(size_t shard_count, size_t symbol_count, size_t orders_per_gateway) {
+    TradingEngine engine(shard_count, true);
+    vector<SymbolId> symbols;
+    for (size_t i = 0; i < symbol_count; ++i) {
+        symbols.push_back(engine.symbolId("SYM" + to_string(i)));
+        engine.onMarketPrice(symbols.back(), 100.0);
+    }
+    engine.flush();
+
+    atomic<bool> done{false};
+    atomic<uint64_t> drained{0};
+    thread drainer([&] {
+        vector<EngineEvent> events;
+        while (!done.load(memory_order_acquire)) {
+            events.clear();
+            drained += engine.pollEvents(events);
+            this_thread::yield();
+        }
+    });
+
+    auto start = chrono::steady_clock::now();
+    vector<thread> gateways;
+    for (size_t g = 0; g < shard_count; ++g) {
+        gateways.emplace_back([&, g] {
+            mt19937 rng(static_cast<unsigned>(g + 1));
+            uniform_real_distribution<double> offset(-1.0, 1.0);
+            size_t per_shard = symbol_count / shard_count;
+            for (size_t i = 0; i < orders_per_gateway; ++i) {
+                Order order;
+                order.account = static_cast<AccountId>(i % 1000);
+                order.symbol = symbols[(i % per_shard) * shard_count + g];
+                order.side = (i & 1) ? Side::Sell : Side::Buy;
+                order.type = OrderType::Limit;
+                order.price = round((100.0 + offset(rng) * 2.0) * 100.0) / 100.0; // cent ticks
+                order.quantity = 1 + static_cast<int64_t>(i % 10);
+                engine.submitOrder(order);
+            }
+        });
+    }
+    for (auto& gateway : gateways) gateway.join();
+    engine.flush();
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    done = true;
+    drainer.join();
+    return static_cast<double>(orders_per_gateway * shard_count) / seconds;
+}
+
+int main(int argc, char** argv) {
+    size_t orders_per_gateway = argc > 1 ? stoul(argv[1]) : 1000000;
+    const size_t symbol_count = 64;
+    double baseline = 0.0;
+
+    printf("%-8s %16s %10s\n", "shards", "orders/sec", "speedup");
+    for (size_t shards : {1, 2, 4, 8}) {
+        double rate = runOnce(shards, symbol_count, orders_per_gateway);
+        if (baseline == 0.0) baseline = rate;
+        printf("%-8zu %16.0f %9.2fx\n", shards, rate, rate / baseline);
+    }
+    printf("(hardware threads: %u)\n", thread::hardware_concurrency());
+    return 0;
+}
@@ -0,0 +1,71 @@
+// Writes a synthetic journal through a live engine, then times deterministic replay.
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+#include "../src/engine/trading_engine.h"
+
+using namespace std;
+
+int main(int argc, char** argv) {
+    size_t order_count = argc > 1 ? stoul(argv[1]) : 2000000;
+    const string path = "journal_replay_bench.journal";
+    remove(path.c_str());
+
+    size_t live_fills = 0;
+    {
+        Journal journal;
+        journal.open(path);
+        TradingEngine engine(4);
+        engine.attachJournal(&journal);
+
+        vector<SymbolId> symbols;
+        for (int i = 0; i < 32; ++i) symbols.push_back(engine.symbolId("SYM" + to_string(i)));
+        mt19937 rng(7);
+        uniform_real_distribution<double> offset(-1.0, 1.0);
+        vector<EngineEvent> events;
+        // Quotes get pulled after a while like a market maker would, which keeps the books bounded
+        vector<uint64_t> recent(4096, 0);
+        for (size_t i = 0; i < order_count; ++i) {
+            SymbolId symbol = symbols[i % symbols.size()];
+            if (i % 16 == 0) engine.onMarketPrice(symbol, 100.0 + offset(rng));
+            Order order;
+            order.account = static_cast<AccountId>(i % 100);
+            order.symbol = symbol;
+            order.side = (i & 1) ? Side::Sell : Side::Buy;
+            order.type = OrderType::Limit;
+            order.price = round((100.0 + offset(rng) * 2.0) * 100.0) / 100.0; // cent ticks
+            order.quantity = 1 + static_cast<int64_t>(i % 5);
+            uint64_t& slot = recent[i % recent.size()];
+            if (slot != 0) engine.cancelOrder(symbols[(i - recent.size()) % symbols.size()], slot);
+            slot = engine.submitOrder(order);
+            if (i % 4096 == 0) engine.pollEvents(events);
+        }
+        engine.flush();
+        engine.pollEvents(events);
+        for (const auto& event : events) live_fills += event.type == EventType::Fill;
+        if (!journal.sync()) {
+            fprintf(stderr, "journal write failed\n");
+            return 1;
+        }
+    }
+
+    auto start = chrono::steady_clock::now();
+    TradingEngine replayed(4);
+    uint64_t last_seq = replayed.recover({path});
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    vector<EngineEvent> events;
+    replayed.pollEvents(events);
+    size_t replay_fills = 0;
+    for (const auto& event : events) replay_fills += event.type == EventType::Fill;
+
+    printf("records: %llu  replay: %.3f s  %.2f M records/sec\n", static_cast<unsigned long long>(last_seq),
+           seconds, static_cast<double>(last_seq) / seconds / 1e6);
+    printf("fills live: %zu  replayed: %zu  %s\n", live_fills, replay_fills,
+           live_fills == replay_fills ? "(match)" : "(MISMATCH)");
+    remove(path.c_str());
+    return live_fills == replay_fills ? 0 : 1;
+}
@@ -0,0 +1,220 @@
+// Load test for the session server: thousands of simulated traders on one box.
+// The server runs in-process on its own thread; one client thread drives every trader
+// connection with poll(), so the number of traders is bounded by file descriptors, not threads.
+// Each trader logs in, then alternates BUY/SELL market orders with a random think time and
+// waits for its FILL before the next one. Reports order -> fill round-trip latency.
+//   server_load_test [traders] [seconds] [think_ms] [--tcp PORT]
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "../src/engine/latency.h"
+#include "../src/server/market_feed.h"
+#include "../src/server/session_server.h"
+#include "../src/user/user_profile.h"
+
+using namespace std;
+
+struct Trader {
+    enum class State { LoggingIn, Idle, Waiting };
+    int fd = -1;
+    State state = State::LoggingIn;
+    string in;
+    string out;
+    uint64_t sent_ns = 0;
+    uint64_t next_ns = 0;
+    bool buy_next = true;
+    string symbol;
+};
+
+static size_t raiseFileLimit(size_t wanted) {
+    rlimit limit{};
+    getrlimit(RLIMIT_NOFILE, &limit);
+    if (limit.rlim_cur < wanted) {
+        limit.rlim_cur = min<rlim_t>(wanted, limit.rlim_max);
+        setrlimit(RLIMIT_NOFILE, &limit);
+        getrlimit(RLIMIT_NOFILE, &limit);
+    }
+    return static_cast<size_t>(limit.rlim_cur);
+}
+
+static int connectTo(const string& unix_path, uint16_t port) {
+    int fd = -1;
+    if (port != 0) {
+        fd = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(port);
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (fd >= 0 && connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+            close(fd);
+            return -1;
+        }
+    } else {
+        fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        strncpy(address.sun_path, unix_path.c_str(), sizeof(address.sun_path) - 1);
+        if (fd >= 0 && connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+            close(fd);
+            return -1;
+        }
+    }
+    if (fd >= 0) fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+    return fd;
+}
+
+int main(int argc, char** argv) {
+    size_t traders = 2000;
+    double seconds = 5.0, think_ms = 50.0;
+    uint16_t port = 0;
+    vector<string> positional;
+    for (int arg = 1; arg < argc; ++arg) {
+        if (strcmp(argv[arg], "--tcp") == 0 && arg + 1 < argc) {
+            port = static_cast<uint16_t>(stoul(argv[++arg]));
+        } else {
+            positional.push_back(argv[arg]);
+        }
+    }
+    if (positional.size() > 0) traders = stoul(positional[0]);
+    if (positional.size() > 1) seconds = stod(positional[1]);
+    if (positional.size() > 2) think_ms = stod(positional[2]);
+
+    // Every trader costs two descriptors here, its client end and the server's end
+    size_t limit = raiseFileLimit(traders * 2 + 64);
+    if (traders * 2 + 64 > limit) {
+        traders = (limit - 64) / 2;
+        printf("File descriptor limit %zu, capping at %zu traders\n", limit, traders);
+    }
+    signal(SIGPIPE, SIG_IGN);
+
+    UserStore users;
+    users.reserve(traders);
+    for (size_t i = 0; i < traders; ++i) {
+        string uid = "load" + to_string(i);
+        users.create(uid, uid + "@load.test", "load", 10000000.0);
+    }
+
+    vector<string> symbols = {"AAPL", "MSFT", "GOOGL", "AMZN", "TSLA", "NVDA", "META", "NFLX"};
+    TradingEngine engine(thread::hardware_concurrency());
+    MarketFeed feed(engine, symbols, chrono::milliseconds(20));
+    SessionServer server(engine, users, feed);
+    string unix_path = "/tmp/trading_server_load_" + to_string(getpid()) + ".sock";
+    bool listening = port != 0 ? server.listenTcp(port) : server.listenUnix(unix_path);
+    if (!listening) {
+        fprintf(stderr, "Could not listen\n");
+        return 1;
+    }
+    feed.start();
+    thread server_thread([&] { server.run(); });
+
+    auto connect_start = chrono::steady_clock::now();
+    vector<Trader> clients(traders);
+    mt19937 rng(7);
+    for (size_t i = 0; i < traders; ++i) {
+        Trader& trader = clients[i];
+        trader.fd = connectTo(unix_path, port);
+        if (trader.fd < 0) {
+            fprintf(stderr, "connect failed after %zu traders: %s\n", i, strerror(errno));
+            clients.resize(i);
+            break;
+        }
+        trader.symbol = symbols[i % symbols.size()];
+        trader.out = "LOGIN load" + to_string(i) + " load\n";
+    }
+    double connect_ms = chrono::duration<double, milli>(chrono::steady_clock::now() - connect_start).count();
+
+    LatencyHistogram round_trip;
+    uint64_t orders = 0, fills = 0, errors = 0;
+    size_t logged_in = 0;
+    uniform_real_distribution<double> think(0.0, 2.0 * think_ms * 1e6);
+    vector<pollfd> fds(clients.size());
+    uint64_t start_ns = latency::now();
+    uint64_t login_done_ns = 0;
+    uint64_t end_ns = start_ns + static_cast<uint64_t>(seconds * 1e9);
+    char buffer[4096];
+
+    while (latency::now() < end_ns) {
+        uint64_t now = latency::now();
+        for (size_t i = 0; i < clients.size(); ++i) {
+            Trader& trader = clients[i];
+            if (trader.state == Trader::State::Idle && now >= trader.next_ns) {
+                trader.out += (trader.buy_next ? "BUY " : "SELL ") + trader.symbol + " 1\n";
+                trader.buy_next = !trader.buy_next;
+                trader.sent_ns = now;
+                trader.state = Trader::State::Waiting;
+                orders++;
+            }
+            if (!trader.out.empty()) {
+                ssize_t sent = send(trader.fd, trader.out.data(), trader.out.size(), 0);
+                if (sent > 0) trader.out.erase(0, static_cast<size_t>(sent));
+            }
+            fds[i] = {trader.fd, POLLIN, 0};
+        }
+
+        if (poll(fds.data(), static_cast<nfds_t>(fds.size()), 1) <= 0) continue;
+        now = latency::now();
+        for (size_t i = 0; i < clients.size(); ++i) {
+            if (!(fds[i].revents & POLLIN)) continue;
+            Trader& trader = clients[i];
+            ssize_t received;
+            while ((received = recv(trader.fd, buffer, sizeof(buffer), 0)) > 0) {
+                trader.in.append(buffer, static_cast<size_t>(received));
+            }
+            size_t start = 0, end;
+            while ((end = trader.in.find('\n', start)) != string::npos) {
+                const char* line = trader.in.c_str() + start;
+                if (strncmp(line, "OK ", 3) == 0) {
+                    trader.state = Trader::State::Idle;
+                    trader.next_ns = now + static_cast<uint64_t>(think(rng));
+                    if (++logged_in == clients.size()) login_done_ns = now;
+                } else if (strncmp(line, "FILL ", 5) == 0) {
+                    round_trip.record(now - trader.sent_ns);
+                    fills++;
+                    trader.state = Trader::State::Idle;
+                    trader.next_ns = now + static_cast<uint64_t>(think(rng));
+                } else if (strncmp(line, "ERR", 3) == 0 || strncmp(line, "REJECTED", 8) == 0 ||
+                           strncmp(line, "CANCELLED", 9) == 0) {
+                    errors++;
+                    trader.state = Trader::State::Idle;
+                    trader.next_ns = now + static_cast<uint64_t>(think(rng));
+                }
+                start = end + 1;
+            }
+            trader.in.erase(0, start);
+        }
+    }
+    double elapsed = static_cast<double>(latency::now() - start_ns) / 1e9;
+
+    for (Trader& trader : clients) close(trader.fd);
+    server.stop();
+    server_thread.join();
+    feed.stop();
+
+    printf("Traders: %zu connected in %.1f ms, %zu logged in", clients.size(), connect_ms, logged_in);
+    if (login_done_ns) printf(" after %.1f ms", static_cast<double>(login_done_ns - start_ns) / 1e6);
+    printf("\nOrders: %llu sent, %llu filled, %llu errors over %.1f s (%.0f fills/s)\n",
+           static_cast<unsigned long long>(orders), static_cast<unsigned long long>(fills),
+           static_cast<unsigned long long>(errors), elapsed, static_cast<double>(fills) / elapsed);
+    printf("Order -> fill round trip: mean %.1f us  p50 %.1f us  p99 %.1f us  max %.1f us\n",
+           round_trip.mean() / 1e3, static_cast<double>(round_trip.percentile(50.0)) / 1e3,
+           static_cast<double>(round_trip.percentile(99.0)) / 1e3, static_cast<double>(round_trip.max()) / 1e3);
+    printf("Server accepted %llu orders, delivered %llu fills\n",
+           static_cast<unsigned long long>(server.ordersAccepted()),
+           static_cast<unsigned long long>(server.fillsDelivered()));
+    return 0;
+}
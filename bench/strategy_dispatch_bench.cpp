@@ -0,0 +1,42 @@
+// Same SMA crossover over the same bars, once through the loop compiled for the concrete
+// type and once through the virtual Strategy interface.
+#include <cstdio>
+#include <string>
+#include "../src/backtest/backtest.h"
+#include "../src/backtest/strategies.h"
+#include "../src/integration/candle_series.h"
+
+using namespace std;
+
+int main(int argc, char** argv) {
+    size_t bars = argc > 1 ? stoul(argv[1]) : 20000000;
+    const int repeats = 5;
+    CandleSeries series = syntheticCandles(bars);
+    CandleView candles = series.view();
+
+    BacktestConfig config;
+    config.record_equity = false;
+    Backtester backtester(config);
+
+    double best_static = 1e30, best_dynamic = 1e30;
+    double static_equity = 0.0, dynamic_equity = 0.0;
+    for (int r = 0; r < repeats; ++r) {
+        SmaCrossover direct(10, 30);
+        BacktestResult a = backtester.runStatic(candles, 0, candles.size(), direct);
+        best_static = min(best_static, a.stats.elapsed_seconds);
+        static_equity = a.stats.final_equity;
+
+        StrategyAdapter<SmaCrossover> adapter(10, 30);
+        BacktestResult b = backtester.runDynamic(candles, 0, candles.size(), adapter);
+        best_dynamic = min(best_dynamic, b.stats.elapsed_seconds);
+        dynamic_equity = b.stats.final_equity;
+    }
+
+    double n = static_cast<double>(bars);
+    printf("%-10s %10s %14s\n", "dispatch", "best (s)", "M bars/sec");
+    printf("%-10s %10.3f %14.1f\n", "static", best_static, n / best_static / 1e6);
+    printf("%-10s %10.3f %14.1f\n", "virtual", best_dynamic, n / best_dynamic / 1e6);
+    printf("speedup %.2fx, final equity %s\n", best_dynamic / best_static,
+           static_equity == dynamic_equity ? "identical" : "DIFFERS");
+    return static_equity == dynamic_equity ? 0 : 1;
+}
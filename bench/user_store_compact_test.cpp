@@ -0,0 +1,84 @@
+// Stress test for UserStore::compact racing balance updates. Worker threads move money in
+// and out of random users with adjustBalance while the main thread compacts the log over
+// and over. Afterwards the log is replayed into a fresh store, and every balance must match
+// the live one: an update missing from the log, or logged on top of a snapshot that
+// already holds it, shows up as a mismatch.
+//   user_store_compact_test [users] [threads] [seconds]
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../src/user/user_profile.h"
+
+using namespace std;
+
+int main(int argc, char** argv) {
+    size_t user_count = argc > 1 ? stoul(argv[1]) : 1000;
+    size_t thread_count = argc > 2 ? stoul(argv[2]) : 4;
+    double seconds = argc > 3 ? stod(argv[3]) : 3.0;
+    const string path = "user_store_compact_test.log";
+    remove(path.c_str());
+
+    UserStore live;
+    if (!live.open(path)) {
+        fprintf(stderr, "could not open %s\n", path.c_str());
+        return 1;
+    }
+    vector<UserId> users(user_count);
+    for (size_t i = 0; i < user_count; ++i) {
+        string uid = "user" + to_string(i);
+        live.create(uid, uid + "@example.com", "password", 1000.0, &users[i]);
+    }
+
+    atomic<bool> stop{false};
+    atomic<uint64_t> adjustments{0};
+    vector<thread> workers;
+    for (size_t t = 0; t < thread_count; ++t) {
+        workers.emplace_back([&, t] {
+            mt19937 rng(static_cast<unsigned>(t + 1));
+            uniform_int_distribution<size_t> pick(0, users.size() - 1);
+            uint64_t done = 0;
+            // Whole dollars keep the sums exact, so the comparison below can be strict
+            while (!stop.load(memory_order_relaxed)) {
+                done += live.adjustBalance(users[pick(rng)], (rng() & 1) ? 1.0 : -1.0);
+            }
+            adjustments.fetch_add(done, memory_order_relaxed);
+        });
+    }
+
+    size_t compactions = 0;
+    auto end = chrono::steady_clock::now() + chrono::duration<double>(seconds);
+    while (chrono::steady_clock::now() < end) {
+        if (!live.compact()) {
+            fprintf(stderr, "compact failed\n");
+            stop = true;
+            for (auto& worker : workers) worker.join();
+            return 1;
+        }
+        ++compactions;
+    }
+    stop = true;
+    for (auto& worker : workers) worker.join();
+    live.flush();
+
+    UserStore replayed;
+    if (!replayed.open(path) || replayed.size() != live.size()) {
+        fprintf(stderr, "replay failed: %zu users, expected %zu\n", replayed.size(), live.size());
+        return 1;
+    }
+    size_t mismatched = 0;
+    for (size_t i = 0; i < user_count; ++i) {
+        UserId id;
+        string uid = "user" + to_string(i);
+        if (!replayed.findByUid(uid, id) || replayed.balance(id) != live.balance(users[i])) ++mismatched;
+    }
+
+    printf("%zu users, %zu threads: %llu adjustments, %zu compactions, %zu balances differ after replay\n",
+           user_count, thread_count, static_cast<unsigned long long>(adjustments.load()), compactions, mismatched);
+    remove(path.c_str());
+    return mismatched == 0 ? 0 : 1;
+}
@@ -1,5 +1,7 @@
 #include <iostream>
 #include <vector>
+#include <deque>
+#include <future>
 #include <string>
 #include <algorithm>
 #include <imgui.h>
@@ -8,7 +10,22 @@
 #include <implot.h>
 #include <GLFW/glfw3.h>
 #include <nlohmann/json.hpp>
+#include "src/graph/graph_plotter.h"
+#include "src/graph/gpu_series.h"
 #include "src/integration/api.h"
+#include "src/integration/candle_series.h"
+#include "src/integration/watchlist.h"
+#include "src/engine/trading_engine.h"
+#include "src/engine/latency.h"
+#include "src/portfolio/leaderboard.h"
+#include "src/portfolio/portfolio.h"
+#include "src/portfolio/portfolio_snapshot.h"
+#include "src/portfolio/risk.h"
+#include "src/portfolio/trade_log.h"
+#include "src/ui/render_scheduler.h"
+#include "src/ui/ui+manager.h"
+#include "src/user/user_profile.h"
+#include "src/util/profiler.h"
 #include <cmath>
 #include <ctime>
 #include <cstdlib>
@@ -22,6 +39,7 @@ struct OHLC {
     double low;
     double close;
     double time;
+    double volume;
     string datetime; // Store datetime for deduplication
 };
 
@@ -35,6 +53,30 @@ void DrawSpinner(const char* label, float radius, float thickness, const ImU32&
     ImGui::PopID();
 }
 
+// Candles of a time_series response, oldest first; false if the response isn't one
+static bool ParseCandles(const string& response, vector<OHLC>& out) {
+    try {
+        json j = json::parse(response);
+        if (!j.contains("values") || !j["values"].is_array()) return false;
+        for (auto it = j["values"].rbegin(); it != j["values"].rend(); ++it) {
+            const auto& value = *it;
+            OHLC candle;
+            candle.open = stod(value["open"].get<string>());
+            candle.high = stod(value["high"].get<string>());
+            candle.low = stod(value["low"].get<string>());
+            candle.close = stod(value["close"].get<string>());
+            candle.volume = value.contains("volume") ? stod(value["volume"].get<string>()) : 0.0;
+            candle.time = 0.0;
+            candle.datetime = value["datetime"].get<string>();
+            out.push_back(candle);
+        }
+        return true;
+    } catch (const exception& e) {
+        cerr << "JSON parse error: " << e.what() << endl;
+        return false;
+    }
+}
+
 int main() {
     // Initialize GLFW
     if (!glfwInit()) {
@@ -66,29 +108,167 @@ int main() {
     ImGuiIO& io = ImGui::GetIO();
     io.ConfigFlags |= ImGuiConfigFlags_NavEnableKeyboard;
     ImGui::StyleColorsDark();
+    // Redraw on input, data and engine events instead of every vsync
+    RenderScheduler scheduler(window);
     ImGui_ImplGlfw_InitForOpenGL(window, true);
     ImGui_ImplOpenGL3_Init("#version 330");
 
     // Trading simulator state
-    float cash_balance = 10000.0f;
-    int shares_owned = 0;
-    vector<string> transaction_log;
+    Portfolio portfolio(10000.0);
+    TaxLotLedger tax_lots(LotMethod::FIFO);
+    portfolio.attachLots(&tax_lots);
+    TradeLog trade_log; // older trades spill to disk so memory stays flat over long sessions
+    trade_log.spillTo("assets/trades.log");
     vector<OHLC> price_history;
     string selected_stock = "AAPL";
     vector<string> stocks = {"AAPL", "MSFT", "GOOGL", "AMZN", "TSLA"};
+    Watchlist watchlist;
+    for (const auto& stock : stocks) watchlist.add(stock);
+    WatchlistPanel watchlist_panel;
+    // The charted symbol is fetched below; the other watchlist rows are refreshed one at a time
+    // on a background thread, rows never fetched (e.g. just added) first, then round robin
+    future<string> watch_fetch;
+    string watch_fetch_symbol;
+    size_t watch_rows_fetched = 0; // rows before this have been fetched at least once
+    size_t watch_fetch_next = 0;
+    double last_watch_fetch = glfwGetTime();
+    const double watch_fetch_interval = 10.0; // with the chart's fetch, 7 calls a minute
     bool fetch_data = true; // Trigger initial fetch
     bool is_loading = false;
     int api_call_count = 0;
     double last_fetch_time = glfwGetTime();
     const double fetch_interval = 60.0; // Fetch every 60 seconds (1 minute)
     string last_datetime;
+    CandlePyramid chart_candles; // price_history merged per power-of-two bucket for drawing
+    ChartAutoRange chart_range(50); // y-limits of the candles in view
+    bool follow_chart = true;       // x-axis tracks the newest 50 candles; off lets the chart pan and zoom
+    double chart_x_min = 0.0, chart_x_max = 30.0;
+    GpuSeries gpu_candles; // the same candles in a GL buffer, drawn by the GPU when gpu_chart is on
+    bool gpu_chart = false;
+    IndicatorSettings indicator_settings;
+    ChartIndicators chart_indicators(indicator_settings);
+
+    // Orders go through the engine; fills come back as events and update the account.
+    // Every command is journaled, and replaying the journal on startup restores the books
+    // and re-delivers past fills, so the account survives restarts.
+    const string journal_path = "assets/engine.journal";
+    // A snapshot holds the account and the books as of some journal seq, so only the journal
+    // after it is replayed, and the journal is rotated once a snapshot covers what it retires.
+    const string snapshot_path = "assets/portfolios.bin";
+    Journal journal;
+    TradingEngine engine(2);
+    engine.setEventNotifier([&scheduler] { scheduler.requestFrame(); });
+    // Server ids start at 0, so this app's account takes the one id the server never issues.
+    // Journals and snapshots written before that still carry 0, which only ever meant this account here.
+    const AccountId local_account = kLocalUserId;
+    const AccountId legacy_local_account = 0;
+    RecoveryPoint recovery_point;
+    SnapshotView snapshot;
+    if (snapshot.open(snapshot_path)) {
+        vector<SymbolId> remap(snapshot.symbolCount());
+        for (size_t i = 0; i < remap.size(); ++i) {
+            remap[i] = engine.symbolId(snapshot.symbolName(static_cast<SymbolId>(i)));
+        }
+        const SnapshotAccount* account = snapshot.findAccount(local_account);
+        if (!account) account = snapshot.findAccount(legacy_local_account);
+        if (account) {
+            snapshot.restore(*account, remap, portfolio);
+        }
+        snapshot.recoveryPoint(remap, recovery_point);
+    }
+    uint64_t last_journal_seq = engine.recover({Journal::previousPath(journal_path), journal_path}, recovery_point);
+    uint64_t journal_rotated_seq = last_journal_seq;
+    if (journal.open(journal_path, last_journal_seq + 1)) {
+        engine.attachJournal(&journal);
+    } else {
+        cerr << "Could not open journal " << journal_path << ", trades will not be persisted" << endl;
+    }
+    SnapshotWriter snapshot_writer(snapshot_path, chrono::milliseconds(1000));
+    double last_snapshot_time = glfwGetTime();
+    const double snapshot_interval = 30.0;
+    vector<EngineEvent> engine_events;
+    vector<pair<uint64_t, uint64_t>> awaiting_display; // (submit_ns, applied_ns) of fills not yet on screen
+    bool show_diagnostics = false;
+    bool show_profiler = false;
+    ProfilerPanel profiler_panel;
+    bool show_optimizer = false;
+    bool show_risk = false;
+    bool show_tax_lots = false;
+    TaxLotPanel tax_lot_panel;
+
+    // Risk: one return row per bar timestamp across every symbol fetched so far
+    WorkStealingPool risk_pool;
+    RiskEngine risk_engine(&risk_pool);
+    AlignedReturns risk_aligner;
+    ReturnMatrix risk_returns(0, 390); // one regular session of 1-minute bars
+    vector<double> risk_marks;         // last close per symbol id
+    vector<double> risk_row;
+    vector<double> risk_exposures;
+    vector<RiskReport> risk_reports;
+    CovarianceEngine risk_covariance(0, 390, &risk_pool); // same rows, kept as running sums
+    vector<double> risk_components;                      // 99% VaR contribution per symbol id
+    vector<double> risk_correlation;
+    bool show_correlation = false;
+    AllocationPanel allocation_panel;
+    bool show_allocation = false;
+    // Every watchlist symbol is fetched, and rows wait for all of them, so the covariance behind
+    // the correlation heatmap and the allocation optimizer sees real cross-sections
+    for (const auto& stock : stocks) risk_aligner.track(engine.symbolId(stock));
+    auto update_risk = [&](SymbolId symbol_id, const vector<OHLC>& candles) {
+        PROFILE_SCOPE("risk update");
+        for (const auto& candle : candles) risk_aligner.add(symbol_id, parseDateTime(candle.datetime), candle.close);
+        if (risk_aligner.assets() > risk_marks.size()) risk_marks.resize(risk_aligner.assets(), 0.0);
+        risk_marks[symbol_id] = candles.back().close;
+        risk_returns.resize(risk_marks.size());
+        risk_covariance.resize(risk_marks.size());
+        while (risk_aligner.next(risk_row)) {
+            risk_returns.append(risk_row);
+            risk_covariance.append(risk_row);
+        }
+        risk_exposures.assign(risk_returns.assets(), 0.0);
+        for (const auto& position : portfolio.positions()) {
+            if (position.symbol < risk_exposures.size()) risk_exposures[position.symbol] = position.marketValue();
+        }
+        risk_reports = risk_engine.compute(risk_returns, risk_exposures, {0.95, 0.99});
+        risk_components = componentVar(risk_covariance, risk_exposures, 0.99);
+        risk_covariance.correlation(risk_correlation);
+    };
+
+    // Leaderboard: this account ranked against the accounts the headless server last saved
+    PortfolioRanking leaderboard;
+    deque<Portfolio> rival_portfolios;
+    SnapshotView rivals;
+    if (rivals.open("assets/server_portfolios.bin")) {
+        vector<SymbolId> remap(rivals.symbolCount());
+        for (size_t i = 0; i < remap.size(); ++i) remap[i] = engine.symbolId(rivals.symbolName(static_cast<SymbolId>(i)));
+        for (size_t i = 0; i < rivals.accountCount(); ++i) {
+            const SnapshotAccount& account = rivals.account(i);
+            if (account.account == local_account) continue;
+            rival_portfolios.emplace_back();
+            rivals.restore(account, remap, rival_portfolios.back());
+            leaderboard.track(account.account, &rival_portfolios.back(), rival_portfolios.back().equity());
+        }
+    }
+    leaderboard.track(local_account, &portfolio, portfolio.equity());
+    bool show_leaderboard = false;
+    SweepPanel sweep_panel;
 
     // Main loop
     while (!glfwWindowShouldClose(window)) {
-        glfwPollEvents();
-        ImGui_ImplOpenGL3_NewFrame();
-        ImGui_ImplGlfw_NewFrame();
-        ImGui::NewFrame();
+        // Sleep until something changes or the next fetch/snapshot is due; background jobs are polled by their panels
+        double next_timer = min(last_fetch_time + fetch_interval, last_snapshot_time + snapshot_interval);
+        next_timer = min(next_timer, last_watch_fetch + watch_fetch_interval);
+        if (sweep_panel.running.valid() || allocation_panel.running.valid() || watch_fetch.valid()) {
+            next_timer = min(next_timer, glfwGetTime() + 0.1);
+        }
+        scheduler.waitForFrame(next_timer);
+        profiler::beginFrame();
+        {
+            PROFILE_SCOPE("new frame");
+            ImGui_ImplOpenGL3_NewFrame();
+            ImGui_ImplGlfw_NewFrame();
+            ImGui::NewFrame();
+        }
 
         // Periodic data fetch
         double current_time = glfwGetTime();
@@ -98,11 +278,17 @@ int main() {
 
         // Fetch stock data when needed
         if (fetch_data && !is_loading) {
+            PROFILE_SCOPE("data update");
             is_loading = true;
             string response = fetchStockData(selected_stock);
             try {
-                json j = json::parse(response);
+                json j;
+                {
+                    PROFILE_SCOPE("json parse");
+                    j = json::parse(response);
+                }
                 if (j.contains("values") && j["values"].is_array()) {
+                    PROFILE_SCOPE("process candles");
                     vector<OHLC> new_candles;
                     double time = price_history.empty() ? 0.0 : price_history.back().time + 1.0;
 
@@ -122,6 +308,7 @@ int main() {
                         candle.high = stod(value["high"].get<string>());
                         candle.low = stod(value["low"].get<string>());
                         candle.close = stod(value["close"].get<string>());
+                        candle.volume = value.contains("volume") ? stod(value["volume"].get<string>()) : 0.0;
                         candle.time = time++;
                         candle.datetime = datetime;
                         new_candles.push_back(candle);
@@ -132,16 +319,31 @@ int main() {
                     if (!new_candles.empty()) {
                         // Append new candles to price_history
                         price_history.insert(price_history.end(), new_candles.begin(), new_candles.end());
+                        SymbolId symbol_id = engine.symbolId(selected_stock);
+                        engine.onMarketPrice(symbol_id, new_candles.back().close);
+                        portfolio.onPrice(symbol_id, new_candles.back().close);
+                        leaderboard.onPrice(symbol_id, new_candles.back().close);
+                        update_risk(symbol_id, new_candles);
                         api_call_count++;
                     }
 
-                    // Limit history to 100 candles
-                    if (price_history.size() > 100) {
-                        price_history.erase(price_history.begin(), price_history.begin() + (price_history.size() - 100));
-                        cout << "Trimmed price_history to 100 candles, new size: " << price_history.size() << endl;
+                    // History is kept in full: the chart pans over it and draws it per pyramid level
+                    {
+                        PROFILE_SCOPE("chart + watchlist prep");
+                        for (const auto& candle : new_candles) {
+                            chart_candles.append(candle.time, candle.open, candle.high, candle.low, candle.close);
+                            gpu_candles.append(candle.time, candle.open, candle.high, candle.low, candle.close);
+                            chart_range.append(candle.low, candle.high);
+                            chart_indicators.append(candle.time, candle.close);
+                        }
+                        size_t watch_row = watchlist.add(selected_stock);
+                        for (const auto& candle : new_candles) {
+                            watchlist.onCandle(watch_row, parseDateTime(candle.datetime), candle.close, candle.volume);
+                        }
                     }
                 } else {
                     cerr << "Invalid API response format" << endl;
+                    risk_aligner.drop(engine.symbolId(selected_stock));
                 }
             } catch (const exception& e) {
                 cerr << "JSON parse error: " << e.what() << endl;
@@ -151,21 +353,102 @@ int main() {
             last_fetch_time = current_time;
         }
 
-        // Trading Simulator Window
-        ImGui::Begin("Trading Simulator", nullptr, ImGuiWindowFlags_AlwaysAutoResize);
+        // Background refresh of the rest of the watchlist
+        if (watch_fetch.valid() && watch_fetch.wait_for(chrono::seconds(0)) == future_status::ready) {
+            PROFILE_SCOPE("watchlist update");
+            vector<OHLC> candles;
+            if (ParseCandles(watch_fetch.get(), candles) && !candles.empty()) {
+                api_call_count++;
+                size_t watch_row = watchlist.add(watch_fetch_symbol);
+                for (const auto& candle : candles) {
+                    watchlist.onCandle(watch_row, parseDateTime(candle.datetime), candle.close, candle.volume);
+                }
+                SymbolId symbol_id = engine.symbolId(watch_fetch_symbol);
+                engine.onMarketPrice(symbol_id, candles.back().close);
+                portfolio.onPrice(symbol_id, candles.back().close);
+                leaderboard.onPrice(symbol_id, candles.back().close);
+                update_risk(symbol_id, candles);
+            } else {
+                cerr << "No candles for " << watch_fetch_symbol << endl;
+                risk_aligner.drop(engine.symbolId(watch_fetch_symbol)); // don't hold scenario rows back for it
+            }
+        } else if (!watch_fetch.valid() && current_time - last_watch_fetch >= watch_fetch_interval) {
+            size_t pick = Watchlist::npos;
+            while (pick == Watchlist::npos && watch_rows_fetched < watchlist.size()) {
+                size_t row = watch_rows_fetched++;
+                risk_aligner.track(engine.symbolId(watchlist.row(row).symbol));
+                if (watchlist.row(row).symbol != selected_stock) pick = row;
+            }
+            for (size_t i = 0; pick == Watchlist::npos && i < watchlist.size(); ++i) {
+                size_t row = (watch_fetch_next + i) % watchlist.size();
+                if (watchlist.row(row).symbol != selected_stock) pick = row;
+            }
+            if (pick != Watchlist::npos) {
+                watch_fetch_next = pick + 1;
+                watch_fetch_symbol = watchlist.row(pick).symbol;
+                watch_fetch = async(launch::async, fetchStockData, watch_fetch_symbol);
+            }
+            last_watch_fetch = current_time;
+        }
+
+        // Before a snapshot, let the engine finish so the drain below covers every journaled command
+        bool take_snapshot = current_time - last_snapshot_time >= snapshot_interval;
+        uint64_t snapshot_journal_seq = 0;
+        if (take_snapshot) {
+            engine.flush();
+            snapshot_journal_seq = journal.lastSeq();
+            last_snapshot_time = current_time;
+        }
 
-        // Stock selector
-        ImGui::Text("Select Stock:");
-        for (const auto& stock : stocks) {
-            if (ImGui::Button(stock.c_str()) && stock != selected_stock) {
-                selected_stock = stock;
-                fetch_data = true;
-                last_datetime.clear();
-                cout << "Switched to stock: " << selected_stock << endl;
+        // Apply fills reported by the engine since the last frame
+        engine_events.clear();
+        engine.pollEvents(engine_events);
+        for (const auto& event : engine_events) {
+            if (event.account != local_account && event.account != legacy_local_account) continue;
+            if (event.type == EventType::Fill) {
+                portfolio.applyFill(event.symbol, event.side, event.quantity, event.price, 0.0, event.time_ns);
+                leaderboard.onFill(local_account, event.symbol);
+                trade_log.append({event.time_ns, event.order_id, event.symbol, TradeRecordType::Fill, event.side, 0, event.price, event.quantity});
+                uint64_t applied_ns = latency::now();
+                latency::record(LatencyStage::MatchToPortfolio, event.match_ns, applied_ns);
+                if (event.submit_ns != 0) awaiting_display.emplace_back(event.submit_ns, applied_ns);
+            } else if (event.type == EventType::Rejected) {
+                trade_log.append({event.time_ns, event.order_id, event.symbol, TradeRecordType::Rejected, event.side, 0, event.price, event.quantity});
             }
-            ImGui::SameLine();
         }
-        ImGui::NewLine();
+        if (take_snapshot) {
+            // Every resting order here is this account's, including any still under the legacy id
+            RecoveryPoint books;
+            engine.recoveryPoint(books);
+            if (journal.isOpen() && snapshot_writer.writtenSeq() >= journal_rotated_seq) {
+                if (journal.rotate()) journal_rotated_seq = snapshot_journal_seq;
+                engine.attachJournal(journal.isOpen() ? &journal : nullptr); // the new file needs the symbols
+            }
+            auto set = make_shared<SnapshotSet>();
+            for (SymbolId id = 0; id < engine.symbolCount(); ++id) set->symbols.push_back(engine.symbolName(id));
+            set->accounts.push_back(captureAccount(local_account, portfolio, move(books.resting)));
+            set->journal_seq = snapshot_journal_seq;
+            set->next_order_id = books.next_order_id;
+            set->last_prices = move(books.last_prices);
+            snapshot_writer.publish(move(set));
+        }
+
+        // Picking a symbol in the watchlist starts its chart from scratch
+        if (DrawWatchlistPanel(watchlist_panel, watchlist, selected_stock)) {
+            fetch_data = true;
+            last_datetime.clear();
+            price_history.clear();
+            chart_candles.clear();
+            gpu_candles.clear();
+            chart_range.reset();
+            chart_indicators.configure(indicator_settings, chart_candles);
+            cout << "Switched to stock: " << selected_stock << endl;
+        }
+
+        // Trading Simulator Window
+        ImGui::Begin("Trading Simulator", nullptr, ImGuiWindowFlags_AlwaysAutoResize);
+
+        ImGui::Text("Stock: %s (pick another in the Watchlist)", selected_stock.c_str());
 
         // Loading indicator
         if (is_loading) {
@@ -174,8 +457,28 @@ int main() {
 
         }
 
+        if (journal.failed()) {
+            ImGui::TextColored(ImVec4(0.9f, 0.2f, 0.2f, 1.0f), "Journal write failed: new trades are not persisted");
+        }
+
         // API call count
         ImGui::Text("API Calls: %d", api_call_count);
+        ImGui::SameLine();
+        ImGui::Checkbox("Diagnostics", &show_diagnostics);
+        ImGui::SameLine();
+        ImGui::Checkbox("Profiler", &show_profiler);
+        ImGui::SameLine();
+        ImGui::Checkbox("Optimizer", &show_optimizer);
+        ImGui::SameLine();
+        ImGui::Checkbox("Risk", &show_risk);
+        ImGui::SameLine();
+        ImGui::Checkbox("Tax Lots", &show_tax_lots);
+        ImGui::SameLine();
+        ImGui::Checkbox("Correlation", &show_correlation);
+        ImGui::SameLine();
+        ImGui::Checkbox("Allocation", &show_allocation);
+        ImGui::SameLine();
+        ImGui::Checkbox("Leaderboard", &show_leaderboard);
 
         float stock_price = price_history.empty() ? 100.0f : price_history.back().close;
         ImGui::Text("Stock Price: $%.2f", stock_price);
@@ -183,34 +486,39 @@ int main() {
 
         ImGui::Text("Trade");
         if (ImGui::Button("Buy Share")) {
-            if (cash_balance >= stock_price) {
-                cash_balance -= stock_price;
-                shares_owned++;
-                transaction_log.push_back("Bought 1 share of " + selected_stock + " at $" + to_string(stock_price));
+            if (portfolio.cash() >= stock_price) {
+                Order order;
+                order.account = local_account;
+                order.symbol = engine.symbolId(selected_stock);
+                order.side = Side::Buy;
+                order.quantity = 1;
+                engine.submitOrder(order);
             }
         }
         ImGui::SameLine();
         if (ImGui::Button("Sell Share")) {
-            if (shares_owned > 0) {
-                cash_balance += stock_price;
-                shares_owned--;
-                transaction_log.push_back("Sold 1 share of " + selected_stock + " at $" + to_string(stock_price));
+            if (portfolio.quantity(engine.symbolId(selected_stock)) > 0) {
+                Order order;
+                order.account = local_account;
+                order.symbol = engine.symbolId(selected_stock);
+                order.side = Side::Sell;
+                order.quantity = 1;
+                engine.submitOrder(order);
             }
         }
 
         ImGui::Separator();
         ImGui::Text("Portfolio");
-        ImGui::Text("Cash Balance: $%.2f", cash_balance);
-        ImGui::Text("Shares Owned: %d", shares_owned);
-        ImGui::Text("Portfolio Value: $%.2f", cash_balance + shares_owned * stock_price);
+        ImGui::Text("Cash Balance: $%.2f", portfolio.cash());
+        ImGui::Text("Shares Owned (%s): %lld", selected_stock.c_str(),
+                    static_cast<long long>(portfolio.quantity(engine.symbolId(selected_stock))));
+        ImGui::Text("Portfolio Value: $%.2f", portfolio.equity());
+        ImGui::Text("Unrealized P&L: $%.2f  Realized P&L: $%.2f", portfolio.unrealizedPnl(), portfolio.realizedPnl());
+        DrawPositionsTable(portfolio, engine);
 
         ImGui::Separator();
         ImGui::Text("Transaction Log");
-        ImGui::BeginChild("Log", ImVec2(0, 100), true);
-        for (const auto& log : transaction_log) {
-            ImGui::Text("%s", log.c_str());
-        }
-        ImGui::EndChild();
+        DrawTradeLog(trade_log, engine, 100.0f);
 
         ImGui::End();
 
@@ -221,78 +529,87 @@ int main() {
         //     DrawSpinner("ChartSpinner", 15.0f, 3.0f, ImGui::GetColorU32(ImGuiCol_Button));
         // } else if (ImPlot::BeginPlot("Candlestick Chart", ImVec2(600, 400))) {
         //     ImPlot::SetupAxes("Time", "Price");
+        ImGui::Checkbox("Follow latest", &follow_chart);
+        ImGui::SameLine();
+        ImGui::Checkbox("GPU candles", &gpu_chart);
+        if (DrawIndicatorSettings(indicator_settings)) chart_indicators.configure(indicator_settings, chart_candles);
             if (ImPlot::BeginPlot("Candle Stick Chart", ImVec2(600, 400))) {
+    PROFILE_SCOPE("chart plot");
     ImPlot::SetupAxes("Time", "Price");
 
-    // Ensure at least 30 units of x-axis for visibility
-    double x_max = price_history.empty() ? 30.0 : price_history.back().time + 1;
-    double x_min = price_history.empty() ? 0.0 : max(0.0, x_max - 50);
-    ImPlot::SetupAxisLimits(ImAxis_X1, x_min, x_max, ImGuiCond_Always);
+    if (follow_chart) {
+        // Ensure at least 30 units of x-axis for visibility
+        chart_x_max = price_history.empty() ? 30.0 : price_history.back().time + 1;
+        chart_x_min = price_history.empty() ? 0.0 : max(0.0, chart_x_max - 50);
+    }
+    ImPlot::SetupAxisLimits(ImAxis_X1, chart_x_min, chart_x_max, follow_chart ? ImGuiCond_Always : ImGuiCond_Once);
 
-    double y_min = 99999, y_max = -99999;
-    for (const auto& candle : price_history) {
-        y_min = min(y_min, candle.low);
-        y_max = max(y_max, candle.high);
+    // Fit y to the candles in view; while panning that's last frame's x-limits
+    double y_min = 0.0, y_max = 0.0;
+    if (chart_range.limits(chart_candles, chart_x_min, chart_x_max, y_min, y_max)) {
+        ImPlot::SetupAxisLimits(ImAxis_Y1, y_min, y_max, ImGuiCond_Always);
     }
     if (!price_history.empty()) {
-        double y_range = y_max - y_min;
-        y_min -= y_range * 0.1;
-        y_max += y_range * 0.1;
-        ImPlot::SetupAxisLimits(ImAxis_Y1, y_min, y_max, ImGuiCond_Always);
-
-        vector<double> times(price_history.size());
-        vector<double> opens(price_history.size());
-        vector<double> closes(price_history.size());
-        vector<double> highs(price_history.size());
-        vector<double> lows(price_history.size());
-
-        for (size_t i = 0; i < price_history.size(); ++i) {
-            times[i] = price_history[i].time;
-            opens[i] = price_history[i].open;
-            closes[i] = price_history[i].close;
-            highs[i] = price_history[i].high;
-            lows[i] = price_history[i].low;
-        }
-
-        for (size_t i = 0; i < price_history.size(); ++i) {
-            double bottom = min(opens[i], closes[i]);
-            double height = abs(closes[i] - opens[i]);
-            double x = times[i];
-            ImVec4 color = closes[i] >= opens[i] ? ImVec4(0, 1, 0, 1) : ImVec4(1, 0, 0, 1);
-
-            ImPlot::PushStyleColor(ImPlotCol_Fill, color);
-            ImPlot::PushStyleColor(ImPlotCol_Line, color);
-            ImPlot::PlotBars(("CandleBody" + to_string(i)).c_str(), &x, &height, 1, 0.6, ImPlotBarsFlags_Horizontal, 0, sizeof(double));
-            ImPlot::SetNextMarkerStyle(ImPlotMarker_Square, 0, color);
-            ImPlot::PlotScatter(("CandleBottom" + to_string(i)).c_str(), &x, &bottom, 1);
-            ImPlot::PopStyleColor(2);
-
-            double x_wick[2] = {times[i], times[i]};
-            double y_wick[2] = {lows[i], highs[i]};
-            ImPlot::PushStyleVar(ImPlotStyleVar_LineWeight, 2.0f);
-            ImPlot::PushStyleColor(ImPlotCol_Line, ImVec4(1, 1, 1, 1));
-            ImPlot::PlotLine(("CandleWick" + to_string(i)).c_str(), x_wick, y_wick, 2);
-            ImPlot::PopStyleColor();
-            ImPlot::PopStyleVar();
-        }
+        // Falls back to the draw-list path if the shaders can't be built
+        if (gpu_chart && !gpu_candles.plotCandles(selected_stock.c_str())) gpu_chart = false;
+        if (!gpu_chart) PlotCandlesticks(selected_stock.c_str(), chart_candles);
+        chart_indicators.plotOverlays();
     } else {
         ImGui::Text("No data available. Market may be closed or data fetch failed.");
     }
+    if (!follow_chart) {
+        ImPlotRect view = ImPlot::GetPlotLimits();
+        chart_x_min = view.X.Min;
+        chart_x_max = view.X.Max;
+    }
 
     ImPlot::EndPlot();
 }
+        chart_indicators.plotOscillators(chart_x_min, chart_x_max, 600.0f);
         ImGui::End();
 
-        ImGui::Render();
-        int display_w, display_h;
-        glfwGetFramebufferSize(window, &display_w, &display_h);
-        glViewport(0, 0, display_w, display_h);
-        glClearColor(0.45f, 0.55f, 0.60f, 1.00f);
-        glClear(GL_COLOR_BUFFER_BIT);
-        ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+        if (show_diagnostics) DrawLatencyPanel(&show_diagnostics);
+        if (show_profiler) DrawProfilerPanel(profiler_panel, &show_profiler);
+        if (show_optimizer) DrawSweepPanel(sweep_panel, &show_optimizer);
+        if (show_risk) DrawRiskPanel(risk_reports, risk_components, engine, &show_risk);
+        if (show_correlation) DrawCorrelationPanel(risk_correlation, engine, &show_correlation);
+        if (show_allocation) {
+            DrawAllocationPanel(allocation_panel, risk_covariance, portfolio, risk_marks, engine, local_account,
+                                &show_allocation);
+        }
+        if (show_tax_lots) DrawTaxLotPanel(tax_lot_panel, tax_lots, engine, &show_tax_lots);
+        if (show_leaderboard) DrawLeaderboardPanel(leaderboard, local_account, &show_leaderboard);
+
+        {
+            PROFILE_SCOPE("render");
+            ImGui::Render();
+            int display_w, display_h;
+            glfwGetFramebufferSize(window, &display_w, &display_h);
+            glViewport(0, 0, display_w, display_h);
+            glClearColor(0.45f, 0.55f, 0.60f, 1.00f);
+            glClear(GL_COLOR_BUFFER_BIT);
+            ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+        }
+        {
+            PROFILE_SCOPE("swap buffers"); // includes the vsync wait
+            glfwSwapBuffers(window);
+        }
 
-        glfwSwapBuffers(window);
+        // Fills applied this frame are on screen once the buffers swap
+        if (!awaiting_display.empty()) {
+            uint64_t visible_ns = latency::now();
+            for (const auto& stamps : awaiting_display) {
+                latency::record(LatencyStage::PortfolioToVisible, stamps.second, visible_ns);
+                latency::record(LatencyStage::OrderToVisible, stamps.first, visible_ns);
+            }
+            awaiting_display.clear();
+        }
+        profiler::endFrame();
     }
+    // Nothing may post to the window once it is gone
+    engine.flush();
+    engine.setEventNotifier(nullptr);
+    gpu_candles.release(); // while the GL context still exists
 
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplGlfw_Shutdown();
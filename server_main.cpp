@@ -0,0 +1,131 @@
+// Headless multi-user server: no window, no network market data. Accounts come from the
+// user store, orders arrive over a local socket, and every session shares one engine and feed.
+//   server [--port N | --unix PATH] [options]
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "src/engine/latency.h"
+#include "src/server/market_feed.h"
+#include "src/server/session_server.h"
+#include "src/user/user_profile.h"
+
+using namespace std;
+
+static SessionServer* running_server = nullptr;
+
+static void onSignal(int) {
+    if (running_server) running_server->stop();
+}
+
+static void printUsage(const char* program) {
+    cerr << "usage: " << program << " [--port N | --unix PATH] [--any-interface]\n"
+         << "  --users users.txt   --user-log users.log   --snapshot portfolios.bin   --journal engine.journal\n"
+         << "  --symbols AAPL,MSFT,...   --tick-ms N   --shards N\n"
+         << "  --latency out.csv   (stage histograms written on shutdown)\n"
+         << "  --create-users N   (adds sim0..simN-1, password \"sim\", $100000 each)" << endl;
+}
+
+int main(int argc, char** argv) {
+    uint16_t port = 0;
+    string unix_path, users_path = "assets/users.txt", log_path = "assets/users.log";
+    string snapshot_path = "assets/server_portfolios.bin", journal_path = "assets/server_engine.journal", latency_path;
+    vector<string> symbols = {"AAPL", "MSFT", "GOOGL", "AMZN", "TSLA"};
+    size_t tick_ms = 100, shards = thread::hardware_concurrency(), create_users = 0;
+    bool any_interface = false;
+    for (int arg = 1; arg < argc; ++arg) {
+        string option = argv[arg];
+        bool has_value = arg + 1 < argc;
+        if (option == "--port" && has_value) {
+            port = static_cast<uint16_t>(stoul(argv[++arg]));
+        } else if (option == "--unix" && has_value) {
+            unix_path = argv[++arg];
+        } else if (option == "--any-interface") {
+            any_interface = true;
+        } else if (option == "--users" && has_value) {
+            users_path = argv[++arg];
+        } else if (option == "--user-log" && has_value) {
+            log_path = argv[++arg];
+        } else if (option == "--snapshot" && has_value) {
+            snapshot_path = argv[++arg];
+        } else if (option == "--journal" && has_value) {
+            journal_path = argv[++arg];
+        } else if (option == "--latency" && has_value) {
+            latency_path = argv[++arg];
+        } else if (option == "--symbols" && has_value) {
+            symbols.clear();
+            stringstream list(argv[++arg]);
+            string symbol;
+            while (getline(list, symbol, ',')) {
+                if (!symbol.empty()) symbols.push_back(symbol);
+            }
+        } else if (option == "--tick-ms" && has_value) {
+            tick_ms = stoul(argv[++arg]);
+        } else if (option == "--shards" && has_value) {
+            shards = stoul(argv[++arg]);
+        } else if (option == "--create-users" && has_value) {
+            create_users = stoul(argv[++arg]);
+        } else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    if (port == 0 && unix_path.empty()) port = 7070;
+
+    UserStore users;
+    users.reserve(create_users + 1024);
+    if (!users.open(log_path)) {
+        cerr << "Could not open user log " << log_path << endl;
+        return 1;
+    }
+    size_t imported = users.importText(users_path);
+    for (size_t i = 0; i < create_users; ++i) {
+        string uid = "sim" + to_string(i);
+        users.create(uid, uid + "@sim.local", "sim", 100000.0); // already there after a restart
+    }
+    users.flush(); // fills in the journal name these ids, so they have to outlast a crash too
+    cout << "Users: " << users.size() << " (" << imported << " imported)" << endl;
+
+    Journal journal;
+    TradingEngine engine(shards);
+    MarketFeed feed(engine, symbols, chrono::milliseconds(tick_ms));
+    SessionServer server(engine, users, feed);
+    if (!unix_path.empty() && !server.listenUnix(unix_path)) {
+        cerr << "Could not listen on " << unix_path << endl;
+        return 1;
+    }
+    if (port != 0 && !server.listenTcp(port, !any_interface)) {
+        cerr << "Could not listen on port " << port << endl;
+        return 1;
+    }
+    server.attachSnapshots(snapshot_path, chrono::seconds(30));
+    if (!server.attachJournal(journal, journal_path)) {
+        cerr << "Could not open journal " << journal_path << ", fills since the last snapshot will not survive a crash"
+             << endl;
+    }
+
+    running_server = &server;
+    signal(SIGINT, onSignal);
+    signal(SIGTERM, onSignal);
+    signal(SIGPIPE, SIG_IGN);
+
+    feed.start();
+    cout << "Serving " << symbols.size() << " symbols on " << engine.shardCount() << " shard(s)";
+    if (port != 0) cout << ", port " << port;
+    if (!unix_path.empty()) cout << ", " << unix_path;
+    cout << endl;
+    server.run();
+    feed.stop();
+    running_server = nullptr;
+
+    if (!journal.sync()) cerr << "Journal write failed, fills after seq " << journal.lastSeq() << " were not saved" << endl;
+    users.flush();
+    cout << "Orders: " << server.ordersAccepted() << ", fills: " << server.fillsDelivered() << endl;
+    if (!latency_path.empty()) latency::dumpToFile(latency_path);
+    return 0;
+}
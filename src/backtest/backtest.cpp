@@ -0,0 +1,62 @@
+#include "backtest.h"
+#include <cmath>
+
+double CostModel::commission(int64_t quantity, double price) const {
+    double fee = commission_per_share * static_cast<double>(quantity) +
+                 commission_percent * static_cast<double>(quantity) * price;
+    return std::max(fee, commission_minimum);
+}
+
+double CostModel::fillPrice(Side side, double price) const {
+    double slip = price * slippage_bps * 1e-4;
+    return side == Side::Buy ? price + slip : price - slip;
+}
+
+void BacktestContext::queue(Side side, OrderType type, double price, int64_t quantity) {
+    if (quantity <= 0) return;
+    Order order;
+    order.id = next_order_id_++;
+    order.side = side;
+    order.type = type;
+    order.price = price;
+    order.quantity = quantity;
+    pending_.push_back(order);
+    if (type == OrderType::Market) pending_position_ += side == Side::Buy ? quantity : -quantity;
+}
+
+void BacktestContext::targetPosition(int64_t target) {
+    int64_t delta = target - pending_position_;
+    if (delta > 0) buy(delta);
+    if (delta < 0) sell(-delta);
+}
+
+double BacktestContext::applyFill(const EngineEvent& fill, const CostModel& costs) {
+    double price = costs.fillPrice(fill.side, fill.price);
+    double fee = costs.commission(fill.quantity, price);
+    portfolio_.applyFill(kSymbol, fill.side, fill.quantity, price, fee);
+    return fee;
+}
+
+void StatsAccumulator::finish(BacktestStats& stats, double bars_per_year) const {
+    stats.final_equity = previous;
+    stats.total_return = initial != 0.0 ? previous / initial - 1.0 : 0.0;
+    stats.max_drawdown = max_drawdown;
+    if (stats.bars > 1) {
+        double n = static_cast<double>(stats.bars);
+        double mean = sum / n;
+        double variance = (sum_sq - n * mean * mean) / (n - 1.0);
+        if (variance > 0.0) stats.sharpe = mean / std::sqrt(variance) * std::sqrt(bars_per_year);
+    }
+}
+
+BacktestResult Strategy::runOn(const Backtester& backtester, const CandleView& candles, size_t begin, size_t end) {
+    return backtester.runDynamic(candles, begin, end, *this);
+}
+
+BacktestResult Backtester::run(const CandleView& candles, Strategy& strategy) const {
+    return run(candles, 0, candles.size(), strategy);
+}
+
+BacktestResult Backtester::run(const CandleView& candles, size_t begin, size_t end, Strategy& strategy) const {
+    return strategy.runOn(*this, candles, begin, end);
+}
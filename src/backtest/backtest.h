@@ -0,0 +1,259 @@
+#ifndef BACKTEST_H
+#define BACKTEST_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+#include "../engine/order.h"
+#include "../engine/order_book.h"
+#include "../integration/candle_series.h"
+#include "../portfolio/portfolio.h"
+
+struct Bar {
+    size_t index;
+    double time;
+    double open;
+    double high;
+    double low;
+    double close;
+    double volume;
+};
+
+// Commission is max(minimum, per_share * qty + percent * notional); slippage moves every
+// fill against the trader by slippage_bps.
+struct CostModel {
+    double commission_per_share = 0.0;
+    double commission_percent = 0.0;
+    double commission_minimum = 0.0;
+    double slippage_bps = 0.0;
+
+    double commission(int64_t quantity, double price) const;
+    double fillPrice(Side side, double price) const;
+};
+
+struct BacktestConfig {
+    double initial_cash = 10000.0;
+    CostModel costs;
+    double bars_per_year = 252.0 * 390.0; // 1-minute bars over regular sessions
+    bool record_equity = true;            // sweeps only need the stats
+};
+
+struct BacktestStats {
+    double final_equity = 0.0;
+    double total_return = 0.0;
+    double max_drawdown = 0.0; // fraction of the running peak
+    double sharpe = 0.0;       // annualised from per-bar returns
+    double commissions = 0.0;
+    size_t bars = 0;
+    size_t fills = 0;
+    double elapsed_seconds = 0.0;
+};
+
+struct BacktestResult {
+    std::vector<double> equity_curve; // marked at each bar's close, empty unless record_equity
+    BacktestStats stats;
+};
+
+// What a strategy sees of the simulation. Time comes from the bar being replayed,
+// never from the wall clock. Orders placed during onBar execute at the next bar's open.
+class BacktestContext {
+public:
+    double now() const { return now_; }
+    double cash() const { return portfolio_.cash(); }
+    int64_t position() const { return portfolio_.quantity(kSymbol); }
+    double equity() const { return portfolio_.equity(); }
+    const Portfolio& portfolio() const { return portfolio_; }
+
+    void buy(int64_t quantity) { queue(Side::Buy, OrderType::Market, 0.0, quantity); }
+    void sell(int64_t quantity) { queue(Side::Sell, OrderType::Market, 0.0, quantity); }
+    void buyLimit(int64_t quantity, double price) { queue(Side::Buy, OrderType::Limit, price, quantity); }
+    void sellLimit(int64_t quantity, double price) { queue(Side::Sell, OrderType::Limit, price, quantity); }
+    void targetPosition(int64_t target);
+
+private:
+    friend class Backtester;
+
+    void queue(Side side, OrderType type, double price, int64_t quantity);
+    double applyFill(const EngineEvent& fill, const CostModel& costs); // returns the commission
+
+    double now_ = 0.0;
+    static constexpr SymbolId kSymbol = 0;
+
+    Portfolio portfolio_;
+    int64_t pending_position_ = 0; // position once queued market orders fill
+    uint64_t next_order_id_ = 1;
+    std::vector<Order> pending_;
+};
+
+class Backtester;
+
+// Runtime (type-erased) strategy interface, for strategies chosen at runtime from the UI
+// or command line. Each bar costs a virtual call; see StrategyBase for the static path.
+class Strategy {
+public:
+    virtual ~Strategy() = default;
+    virtual void onStart(BacktestContext&) {}
+    virtual void onBar(BacktestContext& ctx, const Bar& bar) = 0;
+    virtual void onFill(BacktestContext&, const EngineEvent&) {}
+
+    // Runs a whole backtest. The default loops with per-bar virtual calls; StrategyAdapter
+    // overrides it to run a loop compiled for its concrete strategy type instead.
+    virtual BacktestResult runOn(const Backtester& backtester, const CandleView& candles, size_t begin, size_t end);
+};
+
+// Per-bar accumulation of equity stats so runs without an equity curve need no second pass
+struct StatsAccumulator {
+    double initial = 0.0;
+    double peak = 0.0;
+    double previous = 0.0;
+    double max_drawdown = 0.0;
+    double sum = 0.0;
+    double sum_sq = 0.0;
+
+    explicit StatsAccumulator(double initial_cash)
+        : initial(initial_cash), peak(initial_cash), previous(initial_cash) {}
+
+    void add(double equity) {
+        if (equity > peak) peak = equity;
+        if (peak > 0.0) {
+            double drawdown = (peak - equity) / peak;
+            if (drawdown > max_drawdown) max_drawdown = drawdown;
+        }
+        double r = previous != 0.0 ? equity / previous - 1.0 : 0.0;
+        sum += r;
+        sum_sq += r * r;
+        previous = equity;
+    }
+    void finish(BacktestStats& stats, double bars_per_year) const;
+};
+
+// Single-symbol backtest driving the same OrderBook the live engine matches with,
+// synchronously and without threads, so a run is just a tight loop over the columns.
+class Backtester {
+public:
+    explicit Backtester(BacktestConfig config = {}) : config_(config) {}
+
+    // Type-erased entry point; adapters still end up in a statically dispatched loop
+    BacktestResult run(const CandleView& candles, Strategy& strategy) const;
+    BacktestResult run(const CandleView& candles, size_t begin, size_t end, Strategy& strategy) const;
+
+    // Loop compiled for S: onBar/onFill inline when S is a concrete (final) type.
+    // With S = Strategy every call goes through the vtable.
+    template <typename S>
+    BacktestResult runStatic(const CandleView& candles, size_t begin, size_t end, S& strategy) const;
+    BacktestResult runDynamic(const CandleView& candles, size_t begin, size_t end, Strategy& strategy) const {
+        return runStatic<Strategy>(candles, begin, end, strategy);
+    }
+
+    const BacktestConfig& config() const { return config_; }
+
+private:
+    BacktestConfig config_;
+};
+
+// CRTP base for compile-time strategies: derive as `class X final : public StrategyBase<X>`
+// and define onBar (and optionally onStart/onFill) inline. No virtual functions involved.
+template <typename Derived>
+class StrategyBase {
+public:
+    void onStart(BacktestContext&) {}
+    void onFill(BacktestContext&, const EngineEvent&) {}
+
+    Derived& derived() { return static_cast<Derived&>(*this); }
+};
+
+// Wraps a compile-time strategy in the runtime interface. Passing it around as Strategy&
+// costs nothing per bar: runOn hands the backtester the concrete type.
+template <typename S>
+class StrategyAdapter final : public Strategy {
+public:
+    template <typename... Args>
+    explicit StrategyAdapter(Args&&... args) : impl_(std::forward<Args>(args)...) {}
+
+    void onStart(BacktestContext& ctx) override { impl_.onStart(ctx); }
+    void onBar(BacktestContext& ctx, const Bar& bar) override { impl_.onBar(ctx, bar); }
+    void onFill(BacktestContext& ctx, const EngineEvent& fill) override { impl_.onFill(ctx, fill); }
+
+    BacktestResult runOn(const Backtester& backtester, const CandleView& candles, size_t begin, size_t end) override {
+        return backtester.runStatic(candles, begin, end, impl_);
+    }
+
+    S& strategy() { return impl_; }
+
+private:
+    S impl_;
+};
+
+template <typename S, typename... Args>
+std::unique_ptr<Strategy> makeStrategy(Args&&... args) {
+    return std::make_unique<StrategyAdapter<S>>(std::forward<Args>(args)...);
+}
+
+template <typename S>
+BacktestResult Backtester::runStatic(const CandleView& candles, size_t begin, size_t end, S& strategy) const {
+    auto started = std::chrono::steady_clock::now();
+    end = std::min(end, candles.size());
+    begin = std::min(begin, end);
+
+    BacktestResult result;
+    if (config_.record_equity) result.equity_curve.reserve(end - begin);
+
+    OrderBook book;
+    BacktestContext ctx;
+    ctx.portfolio_ = Portfolio(config_.initial_cash);
+    std::vector<EngineEvent> events;
+    StatsAccumulator acc(config_.initial_cash);
+    size_t fills = 0;
+    double commissions = 0.0;
+
+    strategy.onStart(ctx);
+    const double* time = candles.time;
+    const double* open = candles.open;
+    const double* high = candles.high;
+    const double* low = candles.low;
+    const double* close = candles.close;
+    const double* volume = candles.volume;
+
+    for (size_t i = begin; i < end; ++i) {
+        ctx.now_ = time[i];
+
+        // Orders from the previous bar meet the market at this bar's open
+        book.onMarketPrice(open[i], events);
+        if (!ctx.pending_.empty()) {
+            for (const Order& order : ctx.pending_) book.submit(order, events);
+            ctx.pending_.clear();
+        }
+        book.onMarketPrice(close[i], events);
+        if (!events.empty()) {
+            for (const EngineEvent& event : events) {
+                if (event.type != EventType::Fill) continue;
+                commissions += ctx.applyFill(event, config_.costs);
+                ++fills;
+                strategy.onFill(ctx, event);
+            }
+            events.clear();
+        }
+        ctx.portfolio_.onPrice(BacktestContext::kSymbol, close[i]);
+        ctx.pending_position_ = ctx.position();
+
+        Bar bar{i, time[i], open[i], high[i], low[i], close[i], volume[i]};
+        strategy.onBar(ctx, bar);
+
+        double equity = ctx.equity();
+        if (config_.record_equity) result.equity_curve.push_back(equity);
+        acc.add(equity);
+    }
+
+    BacktestStats& stats = result.stats;
+    stats.bars = end - begin;
+    stats.fills = fills;
+    stats.commissions = commissions;
+    acc.finish(stats, config_.bars_per_year);
+    stats.elapsed_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    return result;
+}
+
+#endif // BACKTEST_H
@@ -0,0 +1,148 @@
+#include "optimizer.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <limits>
+
+double objectiveScore(const BacktestStats& stats, Objective objective) {
+    switch (objective) {
+        case Objective::Sharpe: return stats.sharpe;
+        case Objective::TotalReturn: return stats.total_return;
+        case Objective::ReturnOverDrawdown:
+            return stats.max_drawdown > 0.0 ? stats.total_return / stats.max_drawdown : stats.total_return;
+    }
+    return 0.0;
+}
+
+const char* objectiveName(Objective objective) {
+    switch (objective) {
+        case Objective::Sharpe: return "sharpe";
+        case Objective::TotalReturn: return "total return";
+        case Objective::ReturnOverDrawdown: return "return / drawdown";
+    }
+    return "?";
+}
+
+std::vector<std::vector<double>> expandGrid(const std::vector<ParameterRange>& ranges) {
+    std::vector<std::vector<double>> combos(1);
+    for (const ParameterRange& range : ranges) {
+        std::vector<double> values;
+        double step = range.step > 0.0 ? range.step : 1.0;
+        for (double v = range.min; v <= range.max + step * 1e-9; v += step) values.push_back(v);
+
+        std::vector<std::vector<double>> expanded;
+        expanded.reserve(combos.size() * values.size());
+        for (const auto& combo : combos) {
+            for (double v : values) {
+                expanded.push_back(combo);
+                expanded.back().push_back(v);
+            }
+        }
+        combos.swap(expanded);
+    }
+    return combos;
+}
+
+static BacktestStats runOne(const CandleView& candles, size_t begin, size_t end, const std::vector<double>& params,
+                            const StrategyFactory& factory, const Backtester& backtester) {
+    std::unique_ptr<Strategy> strategy = factory(params);
+    if (!strategy) return {};
+    return backtester.run(candles, begin, end, *strategy).stats;
+}
+
+// Sweeps never need equity curves, so drop them whatever the caller's config says
+static Backtester statsOnly(const Backtester& backtester) {
+    BacktestConfig config = backtester.config();
+    config.record_equity = false;
+    return Backtester(config);
+}
+
+std::vector<SweepResult> runSweep(const CandleView& candles, size_t begin, size_t end,
+                                  const std::vector<std::vector<double>>& combos, const StrategyFactory& factory,
+                                  const Backtester& backtester, Objective objective, WorkStealingPool& pool) {
+    Backtester runner = statsOnly(backtester);
+    std::vector<SweepResult> results(combos.size());
+    // Each task writes only its own slot, so no locking is needed
+    pool.parallelFor(combos.size(), [&](size_t i) {
+        results[i].params = combos[i];
+        results[i].stats = runOne(candles, begin, end, combos[i], factory, runner);
+        results[i].score = objectiveScore(results[i].stats, objective);
+    });
+    // Combinations the factory refused (e.g. fast >= slow) never ran
+    results.erase(std::remove_if(results.begin(), results.end(),
+                                 [](const SweepResult& r) { return r.stats.bars == 0; }),
+                  results.end());
+    return results;
+}
+
+std::vector<WalkForwardWindow> runWalkForward(const CandleView& candles, const std::vector<ParameterRange>& ranges,
+                                              const StrategyFactory& factory, const Backtester& backtester,
+                                              Objective objective, size_t train_bars, size_t test_bars,
+                                              WorkStealingPool& pool) {
+    std::vector<WalkForwardWindow> windows;
+    if (train_bars == 0 || test_bars == 0) return windows;
+    for (size_t start = 0; start + train_bars + test_bars <= candles.size(); start += test_bars) {
+        WalkForwardWindow window;
+        window.train_begin = start;
+        window.train_end = start + train_bars;
+        window.test_begin = window.train_end;
+        window.test_end = window.train_end + test_bars;
+        windows.push_back(window);
+    }
+
+    Backtester runner = statsOnly(backtester);
+    std::vector<std::vector<double>> combos = expandGrid(ranges);
+    std::vector<double> scores(windows.size() * combos.size(), -std::numeric_limits<double>::infinity());
+    pool.parallelFor(scores.size(), [&](size_t task) {
+        const WalkForwardWindow& window = windows[task / combos.size()];
+        BacktestStats stats = runOne(candles, window.train_begin, window.train_end, combos[task % combos.size()],
+                                     factory, runner);
+        double score = objectiveScore(stats, objective);
+        if (stats.bars > 0 && !std::isnan(score)) scores[task] = score;
+    });
+
+    for (size_t w = 0; w < windows.size(); ++w) {
+        size_t best = 0;
+        for (size_t c = 1; c < combos.size(); ++c) {
+            if (scores[w * combos.size() + c] > scores[w * combos.size() + best]) best = c;
+        }
+        windows[w].best_params = combos[best];
+        windows[w].train_score = scores[w * combos.size() + best];
+    }
+
+    pool.parallelFor(windows.size(), [&](size_t w) {
+        WalkForwardWindow& window = windows[w];
+        window.test_stats = runOne(candles, window.test_begin, window.test_end, window.best_params, factory, runner);
+    });
+    return windows;
+}
+
+bool writeSweepCsv(const std::string& path, const std::vector<ParameterRange>& ranges,
+                   const std::vector<SweepResult>& results) {
+    std::ofstream out(path);
+    if (!out) return false;
+    for (const ParameterRange& range : ranges) out << range.name << ',';
+    out << "score,total_return,sharpe,max_drawdown,fills,commissions\n";
+    for (const SweepResult& result : results) {
+        for (double p : result.params) out << p << ',';
+        out << result.score << ',' << result.stats.total_return << ',' << result.stats.sharpe << ','
+            << result.stats.max_drawdown << ',' << result.stats.fills << ',' << result.stats.commissions << '\n';
+    }
+    return static_cast<bool>(out);
+}
+
+bool writeWalkForwardCsv(const std::string& path, const std::vector<ParameterRange>& ranges,
+                         const std::vector<WalkForwardWindow>& windows) {
+    std::ofstream out(path);
+    if (!out) return false;
+    out << "train_begin,train_end,test_begin,test_end,";
+    for (const ParameterRange& range : ranges) out << range.name << ',';
+    out << "train_score,test_return,test_sharpe,test_max_drawdown\n";
+    for (const WalkForwardWindow& w : windows) {
+        out << w.train_begin << ',' << w.train_end << ',' << w.test_begin << ',' << w.test_end << ',';
+        for (double p : w.best_params) out << p << ',';
+        out << w.train_score << ',' << w.test_stats.total_return << ',' << w.test_stats.sharpe << ','
+            << w.test_stats.max_drawdown << '\n';
+    }
+    return static_cast<bool>(out);
+}
@@ -0,0 +1,60 @@
+#ifndef OPTIMIZER_H
+#define OPTIMIZER_H
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include "backtest.h"
+#include "../util/thread_pool.h"
+
+struct ParameterRange {
+    std::string name;
+    double min;
+    double max;
+    double step;
+};
+
+// Builds a fresh strategy for one parameter combination. Every run gets its own strategy,
+// book and account; only the candle columns are shared, read-only.
+using StrategyFactory = std::function<std::unique_ptr<Strategy>(const std::vector<double>& params)>;
+
+enum class Objective { Sharpe, TotalReturn, ReturnOverDrawdown };
+
+double objectiveScore(const BacktestStats& stats, Objective objective);
+const char* objectiveName(Objective objective);
+
+struct SweepResult {
+    std::vector<double> params;
+    BacktestStats stats;
+    double score = 0.0;
+};
+
+struct WalkForwardWindow {
+    size_t train_begin = 0, train_end = 0;
+    size_t test_begin = 0, test_end = 0;
+    std::vector<double> best_params;
+    double train_score = 0.0;
+    BacktestStats test_stats; // out-of-sample run of best_params
+};
+
+// Cartesian product of the ranges, first range varying slowest
+std::vector<std::vector<double>> expandGrid(const std::vector<ParameterRange>& ranges);
+
+std::vector<SweepResult> runSweep(const CandleView& candles, size_t begin, size_t end,
+                                  const std::vector<std::vector<double>>& combos, const StrategyFactory& factory,
+                                  const Backtester& backtester, Objective objective, WorkStealingPool& pool);
+
+// Rolls a train window of train_bars followed by test_bars across the data. Every
+// (window, combination) training run is queued at once so the pool stays saturated.
+std::vector<WalkForwardWindow> runWalkForward(const CandleView& candles, const std::vector<ParameterRange>& ranges,
+                                              const StrategyFactory& factory, const Backtester& backtester,
+                                              Objective objective, size_t train_bars, size_t test_bars,
+                                              WorkStealingPool& pool);
+
+bool writeSweepCsv(const std::string& path, const std::vector<ParameterRange>& ranges,
+                   const std::vector<SweepResult>& results);
+bool writeWalkForwardCsv(const std::string& path, const std::vector<ParameterRange>& ranges,
+                         const std::vector<WalkForwardWindow>& windows);
+
+#endif // OPTIMIZER_H
@@ -0,0 +1,80 @@
+#ifndef STRATEGIES_H
+#define STRATEGIES_H
+
+#include <cstdint>
+#include <vector>
+#include "backtest.h"
+#include "../indicators/indicators.h"
+
+// Built-in strategies are compile-time (StrategyBase) types defined inline so the backtest
+// loop can inline them. Wrap with makeStrategy<T>(...) when a runtime Strategy is needed.
+
+// Goes long a fixed number of shares on the first bar and holds
+class BuyAndHold final : public StrategyBase<BuyAndHold> {
+public:
+    explicit BuyAndHold(int64_t quantity = 10) : quantity_(quantity) {}
+
+    void onBar(BacktestContext& ctx, const Bar&) {
+        if (ctx.position() == 0) ctx.targetPosition(quantity_);
+    }
+
+private:
+    int64_t quantity_;
+};
+
+// Long when the fast SMA is above the slow one, flat otherwise. Both averages are
+// running sums over ring buffers, so each bar is O(1) regardless of the windows.
+class SmaCrossover final : public StrategyBase<SmaCrossover> {
+public:
+    SmaCrossover(size_t fast, size_t slow, int64_t quantity = 10)
+        : fast_(fast == 0 ? 1 : fast), slow_(slow < fast_ ? fast_ : slow), quantity_(quantity), window_(slow_, 0.0) {}
+
+    void onBar(BacktestContext& ctx, const Bar& bar) {
+        size_t slot = seen_ % slow_;
+        slow_sum_ += bar.close - window_[slot];
+        // The close leaving the fast window is `fast` bars back in the same ring
+        if (seen_ >= fast_) fast_sum_ -= window_[(seen_ - fast_) % slow_];
+        fast_sum_ += bar.close;
+        window_[slot] = bar.close;
+        ++seen_;
+        if (seen_ < slow_) return;
+
+        // Compare sums scaled to a common window instead of dividing every bar
+        bool bullish = fast_sum_ * static_cast<double>(slow_) > slow_sum_ * static_cast<double>(fast_);
+        ctx.targetPosition(bullish ? quantity_ : 0);
+    }
+
+private:
+    size_t fast_;
+    size_t slow_;
+    int64_t quantity_;
+    std::vector<double> window_; // last `slow` closes
+    size_t seen_ = 0;
+    double fast_sum_ = 0.0;
+    double slow_sum_ = 0.0;
+};
+
+// Mean reversion on Wilder's RSI: buys when it drops below `oversold`, exits above `overbought`
+class RsiReversion final : public StrategyBase<RsiReversion> {
+public:
+    RsiReversion(size_t period = 14, double oversold = 30.0, double overbought = 70.0, int64_t quantity = 10)
+        : rsi_(period), oversold_(oversold), overbought_(overbought), quantity_(quantity) {}
+
+    void onBar(BacktestContext& ctx, const Bar& bar) {
+        double rsi = rsi_.update(bar.close);
+        if (!rsi_.ready()) return;
+        if (rsi < oversold_) {
+            ctx.targetPosition(quantity_);
+        } else if (rsi > overbought_) {
+            ctx.targetPosition(0);
+        }
+    }
+
+private:
+    indicators::Rsi rsi_;
+    double oversold_;
+    double overbought_;
+    int64_t quantity_;
+};
+
+#endif // STRATEGIES_H
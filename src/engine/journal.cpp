@@ -0,0 +1,180 @@
+#include "journal.h"
+#include <cerrno>
+#include <chrono>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+Journal::Journal(unsigned flush_interval_ms) : flush_interval_ms_(flush_interval_ms) {}
+
+Journal::~Journal() {
+    close();
+}
+
+bool Journal::open(const std::string& path, uint64_t next_seq) {
+    close();
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (fd < 0) return false;
+
+    struct stat info {};
+    fstat(fd, &info);
+    off_t size = info.st_size;
+    off_t good_size = static_cast<off_t>(sizeof(JournalHeader));
+    if (size < static_cast<off_t>(sizeof(JournalHeader))) {
+        // New (or header-less) file
+        if (size > 0 && ftruncate(fd, 0) != 0) {
+            ::close(fd);
+            return false;
+        }
+        JournalHeader header{};
+        std::memcpy(header.magic, kJournalMagic, sizeof(kJournalMagic));
+        header.version = kJournalVersion;
+        header.record_size = sizeof(JournalRecord);
+        if (::write(fd, &header, sizeof(header)) != static_cast<ssize_t>(sizeof(header))) {
+            ::close(fd);
+            return false;
+        }
+    } else {
+        // Drop a torn record left by a crash so new records stay aligned
+        off_t tail = (size - static_cast<off_t>(sizeof(JournalHeader))) % static_cast<off_t>(sizeof(JournalRecord));
+        if (tail != 0 && ftruncate(fd, size - tail) != 0) {
+            ::close(fd);
+            return false;
+        }
+        good_size = size - tail;
+    }
+
+    fd_ = fd;
+    path_ = path;
+    good_size_ = good_size;
+    failed_ = false;
+    next_seq_ = next_seq;
+    durable_seq_ = next_seq - 1;
+    stopping_ = false;
+    writer_ = std::thread([this] { writerLoop(); });
+    return true;
+}
+
+void Journal::close() {
+    if (fd_ < 0) return;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_one();
+    writer_.join();
+    ::close(fd_);
+    fd_ = -1;
+}
+
+bool Journal::rotate() {
+    if (fd_ < 0 || !sync()) return false;
+    std::string path = path_;
+    std::string previous = previousPath(path);
+    uint64_t next_seq = lastSeq() + 1;
+    close();
+    bool moved = std::rename(path.c_str(), previous.c_str()) == 0;
+    // Without the rename this reopens the same file, so appending carries on either way
+    if (!open(path, next_seq)) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        failed_ = true;
+        return false;
+    }
+    return moved;
+}
+
+uint64_t Journal::append(JournalRecord record) {
+    if (record.time_ns == 0) {
+        record.time_ns = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count());
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    record.seq = next_seq_++;
+    buffer_.push_back(record);
+    return record.seq;
+}
+
+void Journal::appendSymbol(SymbolId id, const std::string& name) {
+    JournalRecord record;
+    record.type = JournalRecordType::SymbolDef;
+    record.symbol = id;
+    std::strncpy(record.payload.symbol_name, name.c_str(), sizeof(record.payload.symbol_name) - 1);
+    append(record);
+}
+
+uint64_t Journal::lastSeq() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return failed_ ? durable_seq_ : next_seq_ - 1;
+}
+
+bool Journal::sync() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    uint64_t target = next_seq_ - 1;
+    flush_requested_ = true;
+    wake_.notify_one();
+    synced_.wait(lock, [&] { return durable_seq_ >= target || failed_ || fd_ < 0; });
+    return !failed_ && durable_seq_ >= target;
+}
+
+bool Journal::failed() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return failed_;
+}
+
+void Journal::writerLoop() {
+    std::vector<JournalRecord> batch;
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        wake_.wait_for(lock, std::chrono::milliseconds(flush_interval_ms_),
+                       [&] { return stopping_ || flush_requested_; });
+        flush_requested_ = false;
+        if (failed_) buffer_.clear(); // writing on after a lost batch would leave a gap in seqs
+        if (buffer_.empty()) {
+            if (stopping_) return;
+            continue;
+        }
+        batch.swap(buffer_);
+        uint64_t last_seq = batch.back().seq;
+        lock.unlock();
+
+        const char* data = reinterpret_cast<const char*>(batch.data());
+        size_t total = batch.size() * sizeof(JournalRecord);
+        size_t remaining = total;
+        bool ok = true;
+        int error = 0;
+        while (remaining > 0) {
+            ssize_t written = ::write(fd_, data, remaining);
+            if (written < 0 && errno == EINTR) continue;
+            if (written <= 0) {
+                error = written < 0 ? errno : ENOSPC;
+                ok = false;
+                break;
+            }
+            data += written;
+            remaining -= static_cast<size_t>(written);
+        }
+        if (ok) {
+#if defined(__APPLE__)
+            ok = fcntl(fd_, F_FULLFSYNC) == 0; // plain fsync on macOS does not reach the platter
+#else
+            ok = fdatasync(fd_) == 0;
+#endif
+            if (!ok) error = errno;
+        }
+        // A partial batch would misalign every record appended after it
+        if (!ok) {
+            std::fprintf(stderr, "journal: write failed (%s), journaling stopped\n", std::strerror(error));
+            if (ftruncate(fd_, good_size_) != 0) std::perror("journal: truncating the failed write");
+        }
+        batch.clear();
+
+        lock.lock();
+        if (ok) {
+            good_size_ += static_cast<off_t>(total);
+            durable_seq_ = last_seq;
+        } else {
+            failed_ = true;
+        }
+        synced_.notify_all();
+    }
+}
@@ -0,0 +1,126 @@
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <sys/types.h>
+#include <string>
+#include <thread>
+#include <vector>
+#include "order.h"
+
+enum class JournalRecordType : uint8_t { SymbolDef, Submit, Cancel, MarketPrice };
+
+// Fixed-size record so the journal can be scanned without parsing
+struct JournalRecord {
+    uint64_t seq = 0;
+    uint64_t time_ns = 0; // wall clock, for lining a replay up with logs
+    JournalRecordType type = JournalRecordType::Submit;
+    Side side = Side::Buy;
+    OrderType order_type = OrderType::Market;
+    uint8_t reserved = 0;
+    SymbolId symbol = 0;
+    AccountId account = 0;
+    uint32_t reserved2 = 0;
+    union Payload {
+        struct {
+            uint64_t id;
+            double price;
+            int64_t quantity;
+        } order;
+        char symbol_name[24];
+    } payload{};
+};
+static_assert(sizeof(JournalRecord) == 56, "journal record layout changed, bump kJournalVersion");
+
+constexpr char kJournalMagic[8] = {'T', 'S', 'J', 'O', 'U', 'R', 'N', 'L'};
+constexpr uint32_t kJournalVersion = 1;
+
+struct JournalHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t record_size;
+};
+
+// Append-only command journal. Producers only copy into a buffer; a background thread
+// writes everything that piled up with one write() and one fsync() (group commit).
+class Journal {
+public:
+    explicit Journal(unsigned flush_interval_ms = 5);
+    ~Journal();
+
+    Journal(const Journal&) = delete;
+    Journal& operator=(const Journal&) = delete;
+
+    // Opens for appending, numbering new records from next_seq
+    bool open(const std::string& path, uint64_t next_seq = 1);
+    void close();
+    bool isOpen() const { return fd_ >= 0; }
+
+    // Moves everything appended so far to previousPath() (replacing what was there) and carries
+    // on numbering in a fresh file. Nothing may append meanwhile. False if the sync or the rename
+    // failed; the journal is still open on its file unless reopening failed too (failed() is then set).
+    bool rotate();
+    // Where rotate() leaves retired records: recovery reads it before the journal itself
+    static std::string previousPath(const std::string& path) { return path + ".old"; }
+
+    // Stamps time_ns with the wall clock unless the caller already set it
+    uint64_t append(JournalRecord record);
+    // Seq of the last record appended, durable or not. After a write failure, the last
+    // record that made it to disk: nothing later will.
+    uint64_t lastSeq() const;
+    void appendSymbol(SymbolId id, const std::string& name);
+    // Blocks until everything appended so far is on disk; false if a write failed
+    bool sync();
+    // A write or fsync failed. The file was cut back to its last complete record and the
+    // journal stops writing, so it never holds a torn record or a gap in seqs.
+    bool failed() const;
+
+    // Calls fn(const JournalRecord&) for every complete record. A torn record at the end
+    // (crash mid-write) is ignored.
+    template <typename Fn>
+    static bool forEachRecord(const std::string& path, Fn&& fn);
+
+private:
+    void writerLoop();
+
+    int fd_ = -1;
+    std::string path_;
+    off_t good_size_ = 0; // file size up to the last record known to be written in full
+    unsigned flush_interval_ms_;
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable synced_;
+    std::vector<JournalRecord> buffer_;
+    uint64_t next_seq_ = 1;
+    uint64_t durable_seq_ = 0;
+    bool failed_ = false;
+    bool flush_requested_ = false;
+    bool stopping_ = false;
+    std::thread writer_;
+};
+
+template <typename Fn>
+bool Journal::forEachRecord(const std::string& path, Fn&& fn) {
+    FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) return false;
+
+    JournalHeader header{};
+    bool valid = std::fread(&header, sizeof(header), 1, file) == 1 &&
+                 std::memcmp(header.magic, kJournalMagic, sizeof(kJournalMagic)) == 0 &&
+                 header.version == kJournalVersion && header.record_size == sizeof(JournalRecord);
+    if (valid) {
+        std::vector<JournalRecord> chunk(4096);
+        size_t read;
+        while ((read = std::fread(chunk.data(), sizeof(JournalRecord), chunk.size(), file)) > 0) {
+            for (size_t i = 0; i < read; ++i) fn(chunk[i]);
+        }
+    }
+    std::fclose(file);
+    return valid;
+}
+
+#endif // JOURNAL_H
@@ -0,0 +1,112 @@
+#include "latency.h"
+#include <chrono>
+#include <cmath>
+#include <fstream>
+
+void LatencyHistogram::record(uint64_t ns) {
+    buckets_[bucketFor(ns)].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(ns, std::memory_order_relaxed);
+    uint64_t seen = max_.load(std::memory_order_relaxed);
+    while (ns > seen && !max_.compare_exchange_weak(seen, ns, std::memory_order_relaxed)) {}
+}
+
+void LatencyHistogram::reset() {
+    for (auto& bucket : buckets_) bucket.store(0, std::memory_order_relaxed);
+    count_.store(0, std::memory_order_relaxed);
+    sum_.store(0, std::memory_order_relaxed);
+    max_.store(0, std::memory_order_relaxed);
+}
+
+double LatencyHistogram::mean() const {
+    uint64_t n = count();
+    return n == 0 ? 0.0 : static_cast<double>(sum_.load(std::memory_order_relaxed)) / static_cast<double>(n);
+}
+
+size_t LatencyHistogram::bucketFor(uint64_t value) {
+    if (value < kSubCount) return static_cast<size_t>(value);
+    int msb = 63;
+    while (!(value >> msb)) --msb;
+    int shift = msb - kSubBits + 1;
+    uint64_t sub = value >> shift; // in [kHalf, kSubCount)
+    return static_cast<size_t>(kSubCount + (shift - 1) * kHalf + (sub - kHalf));
+}
+
+uint64_t LatencyHistogram::bucketValue(size_t bucket) {
+    if (bucket < kSubCount) return bucket;
+    size_t k = bucket - kSubCount;
+    int shift = static_cast<int>(k / kHalf) + 1;
+    uint64_t sub = k % kHalf + kHalf;
+    // Middle of the bucket's range
+    return (sub << shift) + ((uint64_t(1) << shift) >> 1);
+}
+
+uint64_t LatencyHistogram::percentile(double p) const {
+    uint64_t n = count();
+    if (n == 0) return 0;
+    uint64_t target = static_cast<uint64_t>(std::ceil(p / 100.0 * static_cast<double>(n)));
+    if (target == 0) target = 1;
+    uint64_t seen = 0;
+    for (size_t i = 0; i < kBuckets; ++i) {
+        seen += bucketCount(i);
+        if (seen >= target) return std::min(bucketValue(i), max());
+    }
+    return max();
+}
+
+namespace latency {
+
+static LatencyHistogram histograms[static_cast<size_t>(LatencyStage::Count)];
+
+uint64_t now() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+void record(LatencyStage stage, uint64_t start_ns, uint64_t end_ns) {
+    if (start_ns == 0 || end_ns < start_ns) return;
+    histogram(stage).record(end_ns - start_ns);
+}
+
+LatencyHistogram& histogram(LatencyStage stage) {
+    return histograms[static_cast<size_t>(stage)];
+}
+
+const char* stageName(LatencyStage stage) {
+    switch (stage) {
+        case LatencyStage::SubmitToAccept: return "submit -> accept";
+        case LatencyStage::AcceptToMatch: return "accept -> match";
+        case LatencyStage::MatchToPortfolio: return "match -> portfolio";
+        case LatencyStage::PortfolioToVisible: return "portfolio -> visible";
+        case LatencyStage::OrderToVisible: return "order -> visible";
+        default: return "?";
+    }
+}
+
+void resetAll() {
+    for (auto& h : histograms) h.reset();
+}
+
+bool dumpToFile(const std::string& path) {
+    std::ofstream out(path);
+    if (!out) return false;
+    out << "stage,count,mean_ns,p50_ns,p99_ns,p99.9_ns,max_ns\n";
+    for (size_t s = 0; s < static_cast<size_t>(LatencyStage::Count); ++s) {
+        const LatencyHistogram& h = histograms[s];
+        out << stageName(static_cast<LatencyStage>(s)) << ',' << h.count() << ',' << h.mean() << ','
+            << h.percentile(50.0) << ',' << h.percentile(99.0) << ',' << h.percentile(99.9) << ',' << h.max() << '\n';
+    }
+    // Raw buckets so runs can be diffed or re-plotted later
+    out << "\nstage,bucket_ns,count\n";
+    for (size_t s = 0; s < static_cast<size_t>(LatencyStage::Count); ++s) {
+        const LatencyHistogram& h = histograms[s];
+        for (size_t b = 0; b < LatencyHistogram::kBuckets; ++b) {
+            if (h.bucketCount(b) == 0) continue;
+            out << stageName(static_cast<LatencyStage>(s)) << ',' << LatencyHistogram::bucketValue(b) << ','
+                << h.bucketCount(b) << '\n';
+        }
+    }
+    return true;
+}
+
+}
@@ -0,0 +1,57 @@
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+// Stages an order goes through on its way to the screen
+enum class LatencyStage : uint8_t {
+    SubmitToAccept,     // submitOrder() -> shard worker picks it up
+    AcceptToMatch,      // shard worker -> fill produced by the book
+    MatchToPortfolio,   // fill produced -> applied to the account on the UI thread
+    PortfolioToVisible, // applied -> frame containing it swapped to screen
+    OrderToVisible,     // end to end
+    Count
+};
+
+// HDR-style log-linear histogram: each power of two is split into 16 linear sub-buckets,
+// so any recorded value is within ~3% of its bucket. Recording is one relaxed atomic add.
+class LatencyHistogram {
+public:
+    static constexpr int kSubBits = 5;
+    static constexpr uint64_t kSubCount = 1u << kSubBits;
+    static constexpr uint64_t kHalf = kSubCount / 2;
+    static constexpr size_t kBuckets = kSubCount + (64 - kSubBits) * kHalf;
+
+    void record(uint64_t ns);
+    void reset();
+
+    uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+    uint64_t max() const { return max_.load(std::memory_order_relaxed); }
+    double mean() const;
+    uint64_t percentile(double p) const;
+
+    static size_t bucketFor(uint64_t value);
+    static uint64_t bucketValue(size_t bucket);
+    uint64_t bucketCount(size_t bucket) const { return buckets_[bucket].load(std::memory_order_relaxed); }
+
+private:
+    std::array<std::atomic<uint64_t>, kBuckets> buckets_{};
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> sum_{0};
+    std::atomic<uint64_t> max_{0};
+};
+
+namespace latency {
+    // Monotonic nanoseconds, shared by every stage so timestamps can be subtracted across threads
+    uint64_t now();
+    void record(LatencyStage stage, uint64_t start_ns, uint64_t end_ns);
+    LatencyHistogram& histogram(LatencyStage stage);
+    const char* stageName(LatencyStage stage);
+    void resetAll();
+    bool dumpToFile(const std::string& path);
+}
+
+#endif // LATENCY_H
@@ -0,0 +1,52 @@
+#ifndef ORDER_H
+#define ORDER_H
+
+#include <cstdint>
+#include <vector>
+
+using SymbolId = uint32_t;
+using AccountId = uint32_t;
+
+enum class Side : uint8_t { Buy, Sell };
+enum class OrderType : uint8_t { Market, Limit };
+
+struct Order {
+    uint64_t id = 0;
+    AccountId account = 0;
+    SymbolId symbol = 0;
+    Side side = Side::Buy;
+    OrderType type = OrderType::Market;
+    double price = 0.0;   // Limit price. On a market order, nonzero caps (buy) or floors (sell)
+                          // the fill price, and what can't fill within it is cancelled.
+    int64_t quantity = 0;
+    uint64_t submit_ns = 0; // latency::now() when handed to the engine
+};
+
+enum class EventType : uint8_t { Fill, Cancelled, Rejected };
+
+// Everything the engine reports back to the portfolio side goes through one of these.
+// seq is assigned by the sequencer so events from different shards have a total order.
+struct EngineEvent {
+    uint64_t seq = 0;
+    EventType type = EventType::Fill;
+    uint64_t order_id = 0;
+    AccountId account = 0;
+    SymbolId symbol = 0;
+    Side side = Side::Buy;
+    double price = 0.0;
+    int64_t quantity = 0;
+    uint64_t submit_ns = 0; // set on fills of the order that triggered the match
+    uint64_t match_ns = 0;
+    uint64_t time_ns = 0;   // wall clock of the command that caused it, from the journal on replay
+};
+
+// Engine state as of a journal seq, which recovery continues from instead of replaying
+// the journal from its start
+struct RecoveryPoint {
+    uint64_t journal_seq = 0;
+    uint64_t next_order_id = 1;
+    std::vector<double> last_prices; // by symbol id, 0 where no price was seen
+    std::vector<Order> resting;      // by id, oldest first
+};
+
+#endif // ORDER_H
@@ -0,0 +1,132 @@
+#include "order_book.h"
+#include <algorithm>
+
+OrderBook::OrderBook(SymbolId symbol) : symbol_(symbol) {}
+
+void OrderBook::emit(EventType type, const Order& order, double price, int64_t quantity,
+                     std::vector<EngineEvent>& events) const {
+    EngineEvent event;
+    event.type = type;
+    event.order_id = order.id;
+    event.account = order.account;
+    event.symbol = symbol_;
+    event.side = order.side;
+    event.price = price;
+    event.quantity = quantity;
+    events.push_back(event);
+}
+
+template <typename Book, typename Crosses>
+void OrderBook::matchAgainst(Book& book, Order& taker, Crosses crosses, std::vector<EngineEvent>& events) {
+    while (taker.quantity > 0 && !book.empty()) {
+        auto level = book.begin();
+        if (!crosses(level->first)) break;
+
+        Level& queue = level->second;
+        while (taker.quantity > 0 && !queue.empty()) {
+            Order& maker = queue.front();
+            int64_t quantity = std::min(taker.quantity, maker.quantity);
+            emit(EventType::Fill, taker, level->first, quantity, events);
+            emit(EventType::Fill, maker, level->first, quantity, events);
+            taker.quantity -= quantity;
+            maker.quantity -= quantity;
+            if (maker.quantity == 0) {
+                index_.erase(maker.id);
+                queue.pop_front();
+            }
+        }
+        if (queue.empty()) book.erase(level);
+    }
+}
+
+void OrderBook::fillAgainstMarket(Order& order, double price, std::vector<EngineEvent>& events) {
+    emit(EventType::Fill, order, price, order.quantity, events);
+    order.quantity = 0;
+}
+
+void OrderBook::rest(const Order& order) {
+    if (order.side == Side::Buy) {
+        bids_[order.price].push_back(order);
+    } else {
+        asks_[order.price].push_back(order);
+    }
+    index_[order.id] = {order.side, order.price};
+}
+
+void OrderBook::submit(const Order& order, std::vector<EngineEvent>& events) {
+    if (order.quantity <= 0 || (order.type == OrderType::Limit && order.price <= 0.0)) {
+        emit(EventType::Rejected, order, order.price, order.quantity, events);
+        return;
+    }
+
+    Order taker = order;
+    bool is_market = taker.type == OrderType::Market;
+    // A market order takes any price unless it carries a protection price
+    auto within = [&](double price) {
+        if (is_market && taker.price <= 0.0) return true;
+        return taker.side == Side::Buy ? price <= taker.price : price >= taker.price;
+    };
+    if (taker.side == Side::Buy) {
+        matchAgainst(asks_, taker, within, events);
+    } else {
+        matchAgainst(bids_, taker, within, events);
+    }
+    if (taker.quantity == 0) return;
+
+    // Whatever the book could not fill goes to the simulated market
+    bool marketable = last_price_ > 0.0 && within(last_price_);
+    if (marketable) {
+        fillAgainstMarket(taker, last_price_, events);
+    } else if (is_market && last_price_ > 0.0) {
+        // Beyond the protection price; market orders never rest
+        emit(EventType::Cancelled, taker, taker.price, taker.quantity, events);
+    } else if (is_market) {
+        // No price yet for this symbol
+        emit(EventType::Rejected, taker, 0.0, taker.quantity, events);
+    } else {
+        rest(taker);
+    }
+}
+
+bool OrderBook::cancel(uint64_t order_id, std::vector<EngineEvent>& events) {
+    auto found = index_.find(order_id);
+    if (found == index_.end()) return false;
+
+    auto remove = [&](auto& book) {
+        auto level = book.find(found->second.second);
+        if (level == book.end()) return;
+        Level& queue = level->second;
+        for (auto it = queue.begin(); it != queue.end(); ++it) {
+            if (it->id == order_id) {
+                emit(EventType::Cancelled, *it, it->price, it->quantity, events);
+                queue.erase(it);
+                break;
+            }
+        }
+        if (queue.empty()) book.erase(level);
+    };
+    if (found->second.first == Side::Buy) {
+        remove(bids_);
+    } else {
+        remove(asks_);
+    }
+    index_.erase(found);
+    return true;
+}
+
+void OrderBook::onMarketPrice(double price, std::vector<EngineEvent>& events) {
+    if (price <= 0.0) return;
+    last_price_ = price;
+
+    auto sweep = [&](auto& book, auto crosses) {
+        while (!book.empty() && crosses(book.begin()->first)) {
+            for (Order& order : book.begin()->second) {
+                fillAgainstMarket(order, price, events);
+                index_.erase(order.id);
+            }
+            book.erase(book.begin());
+        }
+    };
+    sweep(bids_, [&](double bid) { return bid >= price; });
+    sweep(asks_, [&](double ask) { return ask <= price; });
+}
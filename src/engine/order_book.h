@@ -0,0 +1,52 @@
+#ifndef ORDER_BOOK_H
+#define ORDER_BOOK_H
+
+#include <deque>
+#include <functional>
+#include <map>
+#include <unordered_map>
+#include <vector>
+#include "order.h"
+
+// Price-time priority book for a single symbol. Orders first match against resting
+// orders from other traders, then against the simulated market at the last traded price.
+class OrderBook {
+public:
+    explicit OrderBook(SymbolId symbol = 0);
+
+    void submit(const Order& order, std::vector<EngineEvent>& events);
+    bool cancel(uint64_t order_id, std::vector<EngineEvent>& events);
+
+    // New market price: resting limits that are now marketable fill at that price
+    void onMarketPrice(double price, std::vector<EngineEvent>& events);
+
+    double lastPrice() const { return last_price_; }
+    size_t restingOrders() const { return index_.size(); }
+    template <typename Fn> void forEachResting(Fn&& fn) const;
+
+private:
+    using Level = std::deque<Order>;
+
+    template <typename Book, typename Crosses>
+    void matchAgainst(Book& book, Order& taker, Crosses crosses, std::vector<EngineEvent>& events);
+    void rest(const Order& order);
+    void fillAgainstMarket(Order& order, double price, std::vector<EngineEvent>& events);
+    void emit(EventType type, const Order& order, double price, int64_t quantity,
+              std::vector<EngineEvent>& events) const;
+
+    SymbolId symbol_;
+    double last_price_ = 0.0;
+    std::map<double, Level, std::greater<double>> bids_;
+    std::map<double, Level> asks_;
+    std::unordered_map<uint64_t, std::pair<Side, double>> index_; // order id -> level
+};
+
+template <typename Fn>
+void OrderBook::forEachResting(Fn&& fn) const {
+    for (const auto& level : bids_)
+        for (const auto& order : level.second) fn(order);
+    for (const auto& level : asks_)
+        for (const auto& order : level.second) fn(order);
+}
+
+#endif // ORDER_BOOK_H
@@ -1,3 +1,375 @@
 //
 // Created by Shazaib malik on 13/05/2025.
 //
+
+#include "trading_engine.h"
+#include "latency.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#elif defined(__APPLE__)
+#include <mach/mach.h>
+#include <mach/thread_policy.h>
+#include <pthread.h>
+#endif
+
+static void pinThreadToCore(std::thread& thread, unsigned core) {
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(core, &set);
+    pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set);
+#elif defined(__APPLE__)
+    // macOS has no hard pinning, an affinity tag keeps shards apart from each other
+    thread_affinity_policy_data_t policy = {static_cast<integer_t>(core + 1)};
+    thread_policy_set(pthread_mach_thread_np(thread.native_handle()), THREAD_AFFINITY_POLICY,
+                      reinterpret_cast<thread_policy_t>(&policy), THREAD_AFFINITY_POLICY_COUNT);
+#else
+    (void)thread;
+    (void)core;
+#endif
+}
+
+SymbolId SymbolTable::id(const std::string& symbol, bool* created) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto found = ids_.find(symbol);
+    if (created) *created = found == ids_.end();
+    if (found != ids_.end()) return found->second;
+    SymbolId id = static_cast<SymbolId>(names_.size());
+    names_.push_back(symbol);
+    ids_.emplace(symbol, id);
+    return id;
+}
+
+const std::string& SymbolTable::name(SymbolId id) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (id >= names_.size()) throw std::out_of_range("unknown symbol id");
+    return names_[id];
+}
+
+size_t SymbolTable::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return names_.size();
+}
+
+void Sequencer::publish(std::vector<EngineEvent>& batch) {
+    if (batch.empty()) return;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto& event : batch) {
+            event.seq = next_seq_++;
+            pending_.push_back(event);
+        }
+    }
+    batch.clear();
+    if (notify_) notify_();
+}
+
+size_t Sequencer::drain(std::vector<EngineEvent>& out) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t count = pending_.size();
+    out.insert(out.end(), pending_.begin(), pending_.end());
+    pending_.clear();
+    return count;
+}
+
+uint64_t Sequencer::lastSequence() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return next_seq_ - 1;
+}
+
+TradingEngine::TradingEngine(size_t shard_count, bool pin_threads) {
+    if (shard_count == 0) shard_count = 1;
+    unsigned cores = std::thread::hardware_concurrency();
+    for (size_t i = 0; i < shard_count; ++i) {
+        shards_.push_back(std::make_unique<Shard>());
+    }
+    for (size_t i = 0; i < shard_count; ++i) {
+        Shard& shard = *shards_[i];
+        shard.worker = std::thread([this, &shard] { run(shard); });
+        if (pin_threads && cores > 0) pinThreadToCore(shard.worker, static_cast<unsigned>(i % cores));
+    }
+}
+
+TradingEngine::~TradingEngine() {
+    for (auto& shard : shards_) {
+        {
+            std::lock_guard<std::mutex> lock(shard->mutex);
+            shard->stopping = true;
+        }
+        shard->wake.notify_one();
+    }
+    for (auto& shard : shards_) {
+        if (shard->worker.joinable()) shard->worker.join();
+    }
+}
+
+SymbolId TradingEngine::symbolId(const std::string& symbol) {
+    bool created = false;
+    SymbolId id = symbols_.id(symbol, &created);
+    if (created && journal_) journal_->appendSymbol(id, symbol);
+    return id;
+}
+
+void TradingEngine::attachJournal(Journal* journal) {
+    journal_ = journal;
+    if (!journal_) return;
+    // Symbols registered before the journal was attached still need their ids on record
+    for (size_t i = 0; i < symbols_.size(); ++i) {
+        journal_->appendSymbol(static_cast<SymbolId>(i), symbols_.name(static_cast<SymbolId>(i)));
+    }
+}
+
+static uint64_t wallClockNs() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+}
+
+static JournalRecord toJournalRecord(JournalRecordType type, const Order& order, uint64_t time_ns) {
+    JournalRecord record;
+    record.type = type;
+    record.time_ns = time_ns;
+    record.side = order.side;
+    record.order_type = order.type;
+    record.symbol = order.symbol;
+    record.account = order.account;
+    record.payload.order.id = order.id;
+    record.payload.order.price = order.price;
+    record.payload.order.quantity = order.quantity;
+    return record;
+}
+
+uint64_t TradingEngine::recover(const std::vector<std::string>& journal_paths, const RecoveryPoint& from) {
+    std::vector<OrderBook> books;
+    std::vector<SymbolId> remap; // journaled symbol id -> id in this process
+    std::vector<EngineEvent> events;
+    uint64_t last_seq = from.journal_seq;
+    uint64_t first_replayed = 0;
+    uint64_t max_order_id = 0;
+    auto bookFor = [&](SymbolId symbol) -> OrderBook& {
+        for (size_t i = books.size(); i <= symbol; ++i) books.emplace_back(static_cast<SymbolId>(i));
+        return books[symbol];
+    };
+
+    // The resting orders didn't cross each other or the last price when captured, so putting
+    // them back in id order rebuilds each level's time priority without a single match
+    for (size_t symbol = 0; symbol < from.last_prices.size(); ++symbol) {
+        bookFor(static_cast<SymbolId>(symbol)).onMarketPrice(from.last_prices[symbol], events);
+    }
+    for (const Order& order : from.resting) bookFor(order.symbol).submit(order, events);
+    events.clear();
+
+    for (const std::string& path : journal_paths) {
+        Journal::forEachRecord(path, [&](const JournalRecord& record) {
+            last_seq = std::max(last_seq, record.seq);
+            if (first_replayed == 0 && record.seq > from.journal_seq) first_replayed = record.seq;
+            if (record.type == JournalRecordType::SymbolDef) {
+                char name[sizeof(record.payload.symbol_name) + 1] = {};
+                std::memcpy(name, record.payload.symbol_name, sizeof(record.payload.symbol_name));
+                if (record.symbol >= remap.size()) remap.resize(record.symbol + 1, 0);
+                remap[record.symbol] = symbols_.id(name);
+                return;
+            }
+            if (record.seq <= from.journal_seq) return; // already in the books we started from
+            if (record.symbol >= remap.size()) return; // symbol never defined, corrupt record
+
+            Order order;
+            order.id = record.payload.order.id;
+            order.account = record.account;
+            order.symbol = remap[record.symbol];
+            order.side = record.side;
+            order.type = record.order_type;
+            order.price = record.payload.order.price;
+            order.quantity = record.payload.order.quantity;
+            OrderBook& book = bookFor(order.symbol);
+            size_t first_event = events.size();
+            switch (record.type) {
+                case JournalRecordType::Submit:
+                    max_order_id = std::max(max_order_id, order.id);
+                    book.submit(order, events);
+                    break;
+                case JournalRecordType::Cancel: book.cancel(order.id, events); break;
+                case JournalRecordType::MarketPrice: book.onMarketPrice(order.price, events); break;
+                default: break;
+            }
+            // Replayed fills keep the time they first happened, not the time of this restart
+            for (size_t i = first_event; i < events.size(); ++i) events[i].time_ns = record.time_ns;
+        });
+    }
+    // Rotation starts each journal with its symbol definitions, so the first record after
+    // from.journal_seq is normally the next one; anything later means a journal went missing
+    if (first_replayed > from.journal_seq + 1) {
+        std::fprintf(stderr, "journal: records %llu to %llu are missing, the books may differ from before the restart\n",
+                     static_cast<unsigned long long>(from.journal_seq + 1),
+                     static_cast<unsigned long long>(first_replayed - 1));
+    }
+
+    // Hand the rebuilt books to their shards. flush() guarantees the workers are idle.
+    flush();
+    size_t stride = shards_.size();
+    for (size_t symbol = 0; symbol < books.size(); ++symbol) {
+        Shard& shard = *shards_[symbol % stride];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        size_t local = symbol / stride;
+        for (size_t i = shard.books.size(); i <= local; ++i) {
+            shard.books.emplace_back(static_cast<SymbolId>(i * stride + symbol % stride));
+        }
+        shard.books[local] = std::move(books[symbol]);
+    }
+    uint64_t next_order_id = std::max(from.next_order_id, max_order_id + 1);
+    if (next_order_id > next_order_id_.load()) next_order_id_ = next_order_id;
+    sequencer_.publish(events);
+    return last_seq;
+}
+
+void TradingEngine::recoveryPoint(RecoveryPoint& out) {
+    out.resting.clear();
+    out.last_prices.assign(symbols_.size(), 0.0);
+    size_t stride = shards_.size();
+    for (size_t index = 0; index < stride; ++index) {
+        Shard& shard = *shards_[index];
+        // Same wait as restingOrders(): the worker is idle and can't take a batch while we hold the lock
+        std::unique_lock<std::mutex> lock(shard.mutex);
+        shard.idle.wait(lock, [&] { return shard.processed >= shard.queued; });
+        for (size_t local = 0; local < shard.books.size(); ++local) {
+            const OrderBook& book = shard.books[local];
+            size_t symbol = local * stride + index;
+            if (symbol >= out.last_prices.size()) out.last_prices.resize(symbol + 1, 0.0);
+            out.last_prices[symbol] = book.lastPrice();
+            book.forEachResting([&](const Order& order) { out.resting.push_back(order); });
+        }
+    }
+    std::sort(out.resting.begin(), out.resting.end(), [](const Order& a, const Order& b) { return a.id < b.id; });
+    out.next_order_id = next_order_id_.load();
+}
+
+void TradingEngine::restingOrders(AccountId account, std::vector<Order>& out) {
+    size_t first = out.size();
+    restingOrders(out);
+    out.erase(std::remove_if(out.begin() + static_cast<std::ptrdiff_t>(first), out.end(),
+                             [&](const Order& order) { return order.account != account; }),
+              out.end());
+}
+
+void TradingEngine::restingOrders(std::vector<Order>& out) {
+    for (auto& shard : shards_) {
+        // Once everything queued is processed the worker holds no batch, and it cannot take a
+        // new one while we hold the lock, so the books are safe to read
+        std::unique_lock<std::mutex> lock(shard->mutex);
+        shard->idle.wait(lock, [&] { return shard->processed >= shard->queued; });
+        for (const OrderBook& book : shard->books) {
+            book.forEachResting([&](const Order& order) { out.push_back(order); });
+        }
+    }
+}
+
+void TradingEngine::enqueue(SymbolId symbol, Command command) {
+    Shard& shard = shardFor(symbol);
+    command.time_ns = wallClockNs();
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        // Journaled under the shard lock so the journal order matches each shard's queue order
+        if (journal_) {
+            JournalRecordType type = command.type == CommandType::Submit ? JournalRecordType::Submit
+                                   : command.type == CommandType::Cancel ? JournalRecordType::Cancel
+                                   : JournalRecordType::MarketPrice;
+            journal_->append(toJournalRecord(type, command.order, command.time_ns));
+        }
+        shard.inbox.push_back(command);
+        shard.queued++;
+    }
+    shard.wake.notify_one();
+}
+
+uint64_t TradingEngine::submitOrder(Order order) {
+    order.id = next_order_id_.fetch_add(1, std::memory_order_relaxed);
+    if (order.submit_ns == 0) order.submit_ns = latency::now();
+    enqueue(order.symbol, {CommandType::Submit, order});
+    return order.id;
+}
+
+void TradingEngine::cancelOrder(SymbolId symbol, uint64_t order_id) {
+    Order order;
+    order.id = order_id;
+    order.symbol = symbol;
+    enqueue(symbol, {CommandType::Cancel, order});
+}
+
+void TradingEngine::onMarketPrice(SymbolId symbol, double price) {
+    Order order;
+    order.symbol = symbol;
+    order.price = price;
+    enqueue(symbol, {CommandType::MarketPrice, order});
+}
+
+void TradingEngine::flush() {
+    for (auto& shard : shards_) {
+        std::unique_lock<std::mutex> lock(shard->mutex);
+        uint64_t target = shard->queued;
+        shard->idle.wait(lock, [&] { return shard->processed >= target; });
+    }
+}
+
+void TradingEngine::run(Shard& shard) {
+    std::vector<Command> batch;
+    std::vector<EngineEvent> events;
+    size_t stride = shards_.size();
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(shard.mutex);
+            shard.wake.wait(lock, [&] { return shard.stopping || !shard.inbox.empty(); });
+            if (shard.inbox.empty() && shard.stopping) return;
+            batch.swap(shard.inbox);
+        }
+
+        // Drain the whole batch before touching the sequencer so its lock is taken once per batch
+        for (const Command& command : batch) {
+            size_t local = command.order.symbol / stride;
+            if (local >= shard.books.size()) {
+                for (size_t i = shard.books.size(); i <= local; ++i) {
+                    shard.books.emplace_back(static_cast<SymbolId>(i * stride + command.order.symbol % stride));
+                }
+            }
+            OrderBook& book = shard.books[local];
+            size_t first_event = events.size();
+            uint64_t accept_ns = 0;
+            switch (command.type) {
+                case CommandType::Submit:
+                    accept_ns = latency::now();
+                    latency::record(LatencyStage::SubmitToAccept, command.order.submit_ns, accept_ns);
+                    book.submit(command.order, events);
+                    break;
+                case CommandType::Cancel: book.cancel(command.order.id, events); break;
+                case CommandType::MarketPrice: book.onMarketPrice(command.order.price, events); break;
+            }
+            if (events.size() > first_event) {
+                uint64_t match_ns = latency::now();
+                for (size_t i = first_event; i < events.size(); ++i) {
+                    EngineEvent& event = events[i];
+                    event.time_ns = command.time_ns;
+                    if (event.type != EventType::Fill) continue;
+                    event.match_ns = match_ns;
+                    if (accept_ns != 0 && event.order_id == command.order.id) {
+                        event.submit_ns = command.order.submit_ns;
+                        latency::record(LatencyStage::AcceptToMatch, accept_ns, match_ns);
+                    }
+                }
+            }
+        }
+        sequencer_.publish(events);
+
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            shard.processed += batch.size();
+        }
+        shard.idle.notify_all();
+        batch.clear();
+    }
+}
@@ -5,4 +5,122 @@
 #ifndef TRADING_ENGINE_H
 #define TRADING_ENGINE_H
 
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "journal.h"
+#include "order.h"
+#include "order_book.h"
+
+// Maps ticker strings to dense ids so the hot path never hashes strings
+class SymbolTable {
+public:
+    SymbolId id(const std::string& symbol, bool* created = nullptr);
+    const std::string& name(SymbolId id) const;
+    size_t size() const;
+
+private:
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, SymbolId> ids_;
+    std::deque<std::string> names_;
+};
+
+// Gives events coming out of independent shards one global order for the portfolio side
+class Sequencer {
+public:
+    void publish(std::vector<EngineEvent>& batch);
+    size_t drain(std::vector<EngineEvent>& out);
+    uint64_t lastSequence() const;
+    void setNotifier(std::function<void()> notify) { notify_ = std::move(notify); }
+
+private:
+    mutable std::mutex mutex_;
+    std::vector<EngineEvent> pending_;
+    uint64_t next_seq_ = 1;
+    std::function<void()> notify_;
+};
+
+// Symbols are partitioned across shards (symbol id % shard count). Each shard owns its
+// books and runs on its own thread, so orders for different symbols never contend.
+class TradingEngine {
+public:
+    explicit TradingEngine(size_t shard_count = 1, bool pin_threads = false);
+    ~TradingEngine();
+
+    TradingEngine(const TradingEngine&) = delete;
+    TradingEngine& operator=(const TradingEngine&) = delete;
+
+    SymbolId symbolId(const std::string& symbol);
+    const std::string& symbolName(SymbolId id) const { return symbols_.name(id); }
+    size_t symbolCount() const { return symbols_.size(); }
+
+    // Returns the engine-assigned order id; results arrive through pollEvents()
+    uint64_t submitOrder(Order order);
+    void cancelOrder(SymbolId symbol, uint64_t order_id);
+    void onMarketPrice(SymbolId symbol, double price);
+
+    // Every command from now on is written to the journal before it is queued
+    void attachJournal(Journal* journal);
+    // Rebuilds the books single-threaded, in record order, so the result is identical on every
+    // run. Must be called before any orders are submitted. The books start from `from` (a loaded
+    // snapshot's, or empty) and only the records after from.journal_seq are replayed, reading the
+    // journals in the order given; a missing one is skipped. The fills it reproduces are published
+    // like live ones. Returns the last journal seq.
+    uint64_t recover(const std::vector<std::string>& journal_paths, const RecoveryPoint& from = RecoveryPoint());
+    // What recover() can continue from later, once everything queued so far is processed.
+    // journal_seq is left to the caller, who knows which records that covers.
+    void recoveryPoint(RecoveryPoint& out);
+
+    // Copies out the resting orders of one account, after everything queued so far is processed
+    void restingOrders(AccountId account, std::vector<Order>& out);
+    // Same, for every account
+    void restingOrders(std::vector<Order>& out);
+
+    size_t pollEvents(std::vector<EngineEvent>& out) { return sequencer_.drain(out); }
+    // Called from a shard thread after each batch of events is published, so a consumer can
+    // sleep instead of polling. Set it while no commands are in flight (before submitting, or after flush()).
+    void setEventNotifier(std::function<void()> notify) { sequencer_.setNotifier(std::move(notify)); }
+    // Blocks until every command queued so far has been processed
+    void flush();
+
+    size_t shardCount() const { return shards_.size(); }
+
+private:
+    enum class CommandType : uint8_t { Submit, Cancel, MarketPrice };
+    struct Command {
+        CommandType type;
+        Order order; // Cancel uses id/symbol, MarketPrice uses symbol/price
+        uint64_t time_ns = 0; // wall clock when queued, also the journal record's time
+    };
+
+    struct Shard {
+        std::mutex mutex;
+        std::condition_variable wake;
+        std::condition_variable idle;
+        std::vector<Command> inbox;
+        uint64_t queued = 0;
+        uint64_t processed = 0;
+        bool stopping = false;
+        std::vector<OrderBook> books; // indexed by symbol / shard count, only touched by the worker
+        std::thread worker;
+    };
+
+    Shard& shardFor(SymbolId symbol) { return *shards_[symbol % shards_.size()]; }
+    void enqueue(SymbolId symbol, Command command);
+    void run(Shard& shard);
+
+    SymbolTable symbols_;
+    Sequencer sequencer_;
+    Journal* journal_ = nullptr;
+    std::vector<std::unique_ptr<Shard>> shards_;
+    std::atomic<uint64_t> next_order_id_{1};
+};
+
 #endif //TRADING_ENGINE_H
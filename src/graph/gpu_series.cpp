@@ -0,0 +1,390 @@
+#include "gpu_series.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <implot.h>
+#include <implot_internal.h>
+#include "../util/profiler.h"
+
+#if defined(__APPLE__)
+#define GL_SILENCE_DEPRECATION
+#include <OpenGL/gl3.h>
+#else
+#define GL_GLEXT_PROTOTYPES
+#include <GL/gl.h>
+#include <GL/glext.h>
+#endif
+
+static constexpr GLsizei kStride = 5 * sizeof(float);
+static constexpr size_t kInitialCapacity = 4096;
+
+// Instanced: one instance per candle, 12 vertices each (wick quad, then body quad)
+static const char* kCandleVertexShader = R"(
+#version 330 core
+layout (location = 0) in float Time;
+layout (location = 1) in vec4 Ohlc;
+uniform vec2 Scale;     // relative data to NDC
+uniform vec2 Offset;
+uniform vec2 Pixel;     // one screen pixel in NDC
+uniform float HalfBody; // relative time units
+uniform float HalfWick; // pixels
+uniform vec4 Bull;
+uniform vec4 Bear;
+uniform vec4 Wick;
+out vec4 Frag_Color;
+const vec2 corners[6] = vec2[6](vec2(0.0, 0.0), vec2(1.0, 0.0), vec2(1.0, 1.0),
+                                vec2(0.0, 0.0), vec2(1.0, 1.0), vec2(0.0, 1.0));
+void main() {
+    bool body = gl_VertexID >= 6;
+    vec4 y = Ohlc * Scale.y + Offset.y;
+    float x = Time * Scale.x + Offset.x;
+    float half_width = body ? max(abs(HalfBody * Scale.x), 0.5 * Pixel.x) : HalfWick * Pixel.x;
+    float bottom = body ? min(y.x, y.w) : min(y.y, y.z);
+    float top = body ? max(y.x, y.w) : max(y.y, y.z);
+    top = max(top, bottom + Pixel.y); // dojis stay visible
+    vec2 corner = corners[gl_VertexID % 6];
+    gl_Position = vec4(mix(x - half_width, x + half_width, corner.x), mix(bottom, top, corner.y), 0.0, 1.0);
+    Frag_Color = body ? (Ohlc.w >= Ohlc.x ? Bull : Bear) : Wick;
+}
+)";
+
+static const char* kCandleFragmentShader = R"(
+#version 330 core
+in vec4 Frag_Color;
+out vec4 Out_Color;
+void main() { Out_Color = Frag_Color; }
+)";
+
+// Time and close of each point as a line strip
+static const char* kLineVertexShader = R"(
+#version 330 core
+layout (location = 0) in float Time;
+layout (location = 1) in float Price;
+uniform vec2 Scale;
+uniform vec2 Offset;
+void main() { gl_Position = vec4(Time * Scale.x + Offset.x, Price * Scale.y + Offset.y, 0.0, 1.0); }
+)";
+
+static const char* kLineFragmentShader = R"(
+#version 330 core
+uniform vec4 Bull;
+out vec4 Out_Color;
+void main() { Out_Color = Bull; }
+)";
+
+// Copied into the draw list by AddCallback, so a series can be plotted in several plots a frame
+struct GpuDraw {
+    GLuint program;
+    GLuint vao;
+    GLuint buffer;
+    GLint first;
+    GLsizei count;
+    bool candles;
+    // Relative data to screen pixels: pixel = value * scale + offset
+    double x_scale, x_offset, y_scale, y_offset;
+    float half_body;
+    float half_wick;
+    ImVec4 bull, bear, wick;
+};
+
+static inline double column(const double* values, int index, int stride) {
+    return *reinterpret_cast<const double*>(reinterpret_cast<const char*>(values) + static_cast<size_t>(index) * stride);
+}
+
+static GLuint compileShader(GLenum type, const char* source) {
+    GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, nullptr);
+    glCompileShader(shader);
+    GLint ok = GL_FALSE;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &ok);
+    if (!ok) {
+        char log[512] = {};
+        glGetShaderInfoLog(shader, sizeof(log), nullptr, log);
+        std::cerr << "GpuSeries shader compile failed: " << log << std::endl;
+        glDeleteShader(shader);
+        return 0;
+    }
+    return shader;
+}
+
+static GLuint linkProgram(const char* vertex_source, const char* fragment_source) {
+    GLuint vertex = compileShader(GL_VERTEX_SHADER, vertex_source);
+    GLuint fragment = compileShader(GL_FRAGMENT_SHADER, fragment_source);
+    GLuint program = 0;
+    if (vertex && fragment) {
+        program = glCreateProgram();
+        glAttachShader(program, vertex);
+        glAttachShader(program, fragment);
+        glLinkProgram(program);
+        GLint ok = GL_FALSE;
+        glGetProgramiv(program, GL_LINK_STATUS, &ok);
+        if (!ok) {
+            char log[512] = {};
+            glGetProgramInfoLog(program, sizeof(log), nullptr, log);
+            std::cerr << "GpuSeries program link failed: " << log << std::endl;
+            glDeleteProgram(program);
+            program = 0;
+        }
+    }
+    if (vertex) glDeleteShader(vertex);
+    if (fragment) glDeleteShader(fragment);
+    return program;
+}
+
+// Runs inside ImGui_ImplOpenGL3_RenderDrawData with the backend's state set up: blending on,
+// viewport over the framebuffer, projection over the display
+static void DrawGpuSeries(const ImDrawList*, const ImDrawCmd* cmd) {
+    const GpuDraw& draw = *static_cast<const GpuDraw*>(cmd->UserCallbackData);
+    const ImDrawData* data = ImGui::GetDrawData();
+    if (!data || data->DisplaySize.x <= 0.0f || data->DisplaySize.y <= 0.0f) return;
+    const ImVec2 pos = data->DisplayPos;
+    const ImVec2 size = data->DisplaySize;
+    const ImVec2 fb = data->FramebufferScale;
+
+    // The backend only applies clip rects to its own commands; clip to the plot area here
+    float clip_x0 = (cmd->ClipRect.x - pos.x) * fb.x;
+    float clip_y0 = (cmd->ClipRect.y - pos.y) * fb.y;
+    float clip_x1 = (cmd->ClipRect.z - pos.x) * fb.x;
+    float clip_y1 = (cmd->ClipRect.w - pos.y) * fb.y;
+    if (clip_x1 <= clip_x0 || clip_y1 <= clip_y0) return;
+    glScissor(static_cast<GLint>(clip_x0), static_cast<GLint>(size.y * fb.y - clip_y1),
+              static_cast<GLsizei>(clip_x1 - clip_x0), static_cast<GLsizei>(clip_y1 - clip_y0));
+
+    // Screen pixels to NDC, folded into the data transform in double precision
+    double to_ndc_x = 2.0 / size.x, to_ndc_y = -2.0 / size.y;
+    GLuint program = draw.program;
+    glUseProgram(program);
+    glUniform2f(glGetUniformLocation(program, "Scale"), static_cast<float>(draw.x_scale * to_ndc_x),
+                static_cast<float>(draw.y_scale * to_ndc_y));
+    glUniform2f(glGetUniformLocation(program, "Offset"), static_cast<float>((draw.x_offset - pos.x) * to_ndc_x - 1.0),
+                static_cast<float>((draw.y_offset - pos.y) * to_ndc_y + 1.0));
+    glUniform2f(glGetUniformLocation(program, "Pixel"), static_cast<float>(to_ndc_x), static_cast<float>(-to_ndc_y));
+    glUniform1f(glGetUniformLocation(program, "HalfBody"), draw.half_body);
+    glUniform1f(glGetUniformLocation(program, "HalfWick"), draw.half_wick);
+    glUniform4f(glGetUniformLocation(program, "Bull"), draw.bull.x, draw.bull.y, draw.bull.z, draw.bull.w);
+    glUniform4f(glGetUniformLocation(program, "Bear"), draw.bear.x, draw.bear.y, draw.bear.z, draw.bear.w);
+    glUniform4f(glGetUniformLocation(program, "Wick"), draw.wick.x, draw.wick.y, draw.wick.z, draw.wick.w);
+
+    glBindVertexArray(draw.vao);
+    glBindBuffer(GL_ARRAY_BUFFER, draw.buffer);
+    if (draw.candles) {
+        // Instance attributes start at the first visible candle; no base-instance draw in GL 3.3
+        const char* base = reinterpret_cast<const char*>(static_cast<size_t>(draw.first) * kStride);
+        glVertexAttribPointer(0, 1, GL_FLOAT, GL_FALSE, kStride, base);
+        glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, kStride, base + sizeof(float));
+        glDrawArraysInstanced(GL_TRIANGLES, 0, 12, draw.count);
+    } else {
+        glDrawArrays(GL_LINE_STRIP, draw.first, draw.count);
+    }
+}
+
+void GpuSeries::assign(const CandleColumns& candles) {
+    clear();
+    time_.reserve(static_cast<size_t>(std::max(candles.count, 0)));
+    data_.reserve(static_cast<size_t>(std::max(candles.count, 0)) * kFloats);
+    for (int i = 0; i < candles.count; ++i) {
+        append(column(candles.time, i, candles.stride), column(candles.open, i, candles.stride),
+               column(candles.high, i, candles.stride), column(candles.low, i, candles.stride),
+               column(candles.close, i, candles.stride));
+    }
+}
+
+void GpuSeries::append(double time, double open, double high, double low, double close) {
+    if (time_.empty()) {
+        origin_time_ = time;
+        origin_price_ = close;
+        low_ = low;
+        high_ = high;
+    }
+    time_.push_back(time);
+    data_.push_back(static_cast<float>(time - origin_time_));
+    data_.push_back(static_cast<float>(open - origin_price_));
+    data_.push_back(static_cast<float>(high - origin_price_));
+    data_.push_back(static_cast<float>(low - origin_price_));
+    data_.push_back(static_cast<float>(close - origin_price_));
+    low_ = std::min(low_, low);
+    high_ = std::max(high_, high);
+}
+
+void GpuSeries::set(size_t index, double time, double open, double high, double low, double close) {
+    if (index >= size()) return;
+    time_[index] = time;
+    float* point = &data_[index * kFloats];
+    point[0] = static_cast<float>(time - origin_time_);
+    point[1] = static_cast<float>(open - origin_price_);
+    point[2] = static_cast<float>(high - origin_price_);
+    point[3] = static_cast<float>(low - origin_price_);
+    point[4] = static_cast<float>(close - origin_price_);
+    dirty_first_ = std::min(dirty_first_, index);
+    extent_stale_ = true;
+}
+
+void GpuSeries::clear() {
+    time_.clear();
+    data_.clear();
+    dirty_first_ = 0;
+    extent_stale_ = false;
+}
+
+bool GpuSeries::upload() {
+    if (gl_failed_) return false;
+    if (!candle_program_) {
+        candle_program_ = linkProgram(kCandleVertexShader, kCandleFragmentShader);
+        line_program_ = linkProgram(kLineVertexShader, kLineFragmentShader);
+        if (!candle_program_ || !line_program_) {
+            release();
+            gl_failed_ = true;
+            return false;
+        }
+        glGenBuffers(1, &buffer_);
+        glGenVertexArrays(1, &candle_vao_);
+        glGenVertexArrays(1, &line_vao_);
+        glBindBuffer(GL_ARRAY_BUFFER, buffer_);
+        // Candle pointers are set per draw, offset to the first visible candle
+        glBindVertexArray(candle_vao_);
+        glEnableVertexAttribArray(0);
+        glEnableVertexAttribArray(1);
+        glVertexAttribDivisor(0, 1);
+        glVertexAttribDivisor(1, 1);
+        glBindVertexArray(line_vao_);
+        glEnableVertexAttribArray(0);
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(0, 1, GL_FLOAT, GL_FALSE, kStride, nullptr);
+        glVertexAttribPointer(1, 1, GL_FLOAT, GL_FALSE, kStride, reinterpret_cast<const void*>(4 * sizeof(float)));
+        glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        capacity_ = 0;
+        dirty_first_ = 0;
+    }
+
+    size_t count = size();
+    if (dirty_first_ >= count) return true;
+    PROFILE_SCOPE("GpuSeries upload");
+    glBindBuffer(GL_ARRAY_BUFFER, buffer_);
+    if (count > capacity_) {
+        capacity_ = std::max(count, std::max(capacity_ * 2, kInitialCapacity));
+        glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(capacity_ * kStride), nullptr, GL_DYNAMIC_DRAW);
+        dirty_first_ = 0;
+    }
+    glBufferSubData(GL_ARRAY_BUFFER, static_cast<GLintptr>(dirty_first_ * kStride),
+                    static_cast<GLsizeiptr>((count - dirty_first_) * kStride), &data_[dirty_first_ * kFloats]);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    dirty_first_ = count;
+    return true;
+}
+
+void GpuSeries::fit() {
+    if (extent_stale_) {
+        low_ = high_ = data_[3];
+        for (size_t i = 0; i < size(); ++i) {
+            low_ = std::min(low_, static_cast<double>(data_[i * kFloats + 3]));
+            high_ = std::max(high_, static_cast<double>(data_[i * kFloats + 2]));
+        }
+        low_ += origin_price_;
+        high_ += origin_price_;
+        extent_stale_ = false;
+    }
+    ImPlot::FitPoint(ImPlotPoint(time_.front(), low_));
+    ImPlot::FitPoint(ImPlotPoint(time_.back(), high_));
+}
+
+bool GpuSeries::ready() {
+    if (!upload()) return false;
+    // Lock the axes now so their ranges and pixel mapping are final
+    ImPlot::SetupLock();
+    ImPlotPlot& plot = *ImPlot::GetCurrentPlot();
+    return !plot.Axes[plot.CurrentX].TransformForward && !plot.Axes[plot.CurrentY].TransformForward;
+}
+
+void GpuSeries::visibleRange(double pad, size_t& first, size_t& last) const {
+    ImPlotPlot& plot = *ImPlot::GetCurrentPlot();
+    const ImPlotRange& range = plot.Axes[plot.CurrentX].Range;
+    first = static_cast<size_t>(std::lower_bound(time_.begin(), time_.end(), range.Min - pad) - time_.begin());
+    last = static_cast<size_t>(std::lower_bound(time_.begin() + first, time_.end(), range.Max + pad) - time_.begin());
+}
+
+// Fills the transform from the plot's current axes and queues the draw after ImPlot's own items
+static void SubmitGpuDraw(GpuDraw& draw, double origin_time, double origin_price) {
+    ImPlotPlot& plot = *ImPlot::GetCurrentPlot();
+    const ImPlotAxis& x_axis = plot.Axes[plot.CurrentX];
+    const ImPlotAxis& y_axis = plot.Axes[plot.CurrentY];
+    draw.x_scale = x_axis.ScaleToPixel;
+    draw.x_offset = x_axis.PixelMin + x_axis.ScaleToPixel * (origin_time - x_axis.Range.Min);
+    draw.y_scale = y_axis.ScaleToPixel;
+    draw.y_offset = y_axis.PixelMin + y_axis.ScaleToPixel * (origin_price - y_axis.Range.Min);
+    ImDrawList& list = *ImPlot::GetPlotDrawList();
+    list.AddCallback(DrawGpuSeries, &draw, sizeof(draw));
+    list.AddCallback(ImDrawCallback_ResetRenderState, nullptr);
+}
+
+bool GpuSeries::plotCandles(const char* label_id, const CandleStyle& style) {
+    PROFILE_SCOPE("GpuSeries::plotCandles");
+    if (!ready()) return false;
+    if (time_.empty()) return true;
+    ImPlot::SetNextFillStyle(style.bull);
+    if (!ImPlot::BeginItem(label_id, ImPlotItemFlags_None, ImPlotCol_Fill)) return true;
+    if (ImPlot::FitThisFrame()) fit();
+
+    // Spacing from the first two candles, as in PlotCandlesticks
+    double spacing = size() > 1 ? time_[1] - time_[0] : 1.0;
+    double half_body = spacing * style.body_width * 0.5;
+    size_t first = 0, last = 0;
+    visibleRange(half_body + 1e-9 * spacing, first, last);
+    if (first < last) {
+        GpuDraw draw{};
+        draw.program = candle_program_;
+        draw.vao = candle_vao_;
+        draw.buffer = buffer_;
+        draw.first = static_cast<GLint>(first);
+        draw.count = static_cast<GLsizei>(last - first);
+        draw.candles = true;
+        draw.half_body = static_cast<float>(half_body);
+        draw.half_wick = std::max(0.5f, style.wick_weight * 0.5f);
+        draw.bull = style.bull;
+        draw.bear = style.bear;
+        draw.wick = style.wick;
+        SubmitGpuDraw(draw, origin_time_, origin_price_);
+    }
+    ImPlot::EndItem();
+    return true;
+}
+
+bool GpuSeries::plotLine(const char* label_id, const ImVec4& color) {
+    PROFILE_SCOPE("GpuSeries::plotLine");
+    if (!ready()) return false;
+    if (time_.empty()) return true;
+    ImPlot::SetNextLineStyle(color);
+    if (!ImPlot::BeginItem(label_id, ImPlotItemFlags_None, ImPlotCol_Line)) return true;
+    if (ImPlot::FitThisFrame()) fit();
+
+    // One point past each edge so the strip reaches the plot borders
+    size_t first = 0, last = 0;
+    visibleRange(0.0, first, last);
+    first = first > 0 ? first - 1 : 0;
+    last = std::min(last + 1, size());
+    if (last - first > 1) {
+        GpuDraw draw{};
+        draw.program = line_program_;
+        draw.vao = line_vao_;
+        draw.buffer = buffer_;
+        draw.first = static_cast<GLint>(first);
+        draw.count = static_cast<GLsizei>(last - first);
+        draw.candles = false;
+        draw.bull = color;
+        SubmitGpuDraw(draw, origin_time_, origin_price_);
+    }
+    ImPlot::EndItem();
+    return true;
+}
+
+void GpuSeries::release() {
+    if (candle_program_) glDeleteProgram(candle_program_);
+    if (line_program_) glDeleteProgram(line_program_);
+    if (candle_vao_) glDeleteVertexArrays(1, &candle_vao_);
+    if (line_vao_) glDeleteVertexArrays(1, &line_vao_);
+    if (buffer_) glDeleteBuffers(1, &buffer_);
+    candle_program_ = line_program_ = candle_vao_ = line_vao_ = buffer_ = 0;
+    capacity_ = 0;
+    dirty_first_ = 0;
+    gl_failed_ = false;
+}
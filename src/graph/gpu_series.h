@@ -0,0 +1,65 @@
+#ifndef GPU_SERIES_H
+#define GPU_SERIES_H
+
+#include <cstddef>
+#include <vector>
+#include <imgui.h>
+#include "graph_plotter.h"
+
+// Candles or ticks drawn by the GPU from a persistent vertex buffer, for series too long
+// for the draw-list path. ImPlot still lays out the plot, axes and legend; the points are
+// drawn from a draw-list callback with the plot's transform, as one instanced draw (the
+// vertex shader expands each candle into its wick and body) or one line strip, limited to
+// the points inside the x range.
+//
+// Each point is five floats (time, open, high, low, close) relative to the first point, so
+// float precision is spent on the differences. Appends and edits only mark a dirty tail,
+// uploaded with a single glBufferSubData on the next plot; the buffer grows by doubling.
+// Linear axes only. Plot with the GL context current, and release() before destroying it.
+class GpuSeries {
+public:
+    GpuSeries() = default;
+    GpuSeries(const GpuSeries&) = delete;
+    GpuSeries& operator=(const GpuSeries&) = delete;
+
+    void assign(const CandleColumns& candles);
+    void append(double time, double open, double high, double low, double close);
+    void appendTick(double time, double price) { append(time, price, price, price, price); }
+    // Replaces an existing point; the buffer is re-uploaded from index on
+    void set(size_t index, double time, double open, double high, double low, double close);
+    void clear();
+    size_t size() const { return time_.size(); }
+
+    // Call between ImPlot::BeginPlot and ImPlot::EndPlot. False, drawing nothing, when the
+    // shaders can't be built or an axis isn't linear, so the caller can fall back to
+    // PlotCandlesticks / PlotLine.
+    bool plotCandles(const char* label_id, const CandleStyle& style = CandleStyle());
+    bool plotLine(const char* label_id, const ImVec4& color = ImVec4(1, 1, 1, 1));
+
+    // Frees the GL objects; the series keeps its points and re-uploads them if plotted again
+    void release();
+
+private:
+    static constexpr size_t kFloats = 5;
+
+    bool upload();
+    bool ready(); // uploaded and the plot's axes are linear
+    void visibleRange(double pad, size_t& first, size_t& last) const;
+    void fit();
+
+    std::vector<double> time_; // absolute times, for the visible range search
+    std::vector<float> data_;  // kFloats per point, relative to origin_time_ / origin_price_
+    double origin_time_ = 0.0;
+    double origin_price_ = 0.0;
+    double low_ = 0.0, high_ = 0.0; // price extent, for fitting
+    bool extent_stale_ = false;     // set() may have shrunk it
+
+    unsigned int buffer_ = 0;
+    unsigned int candle_vao_ = 0, line_vao_ = 0;
+    unsigned int candle_program_ = 0, line_program_ = 0;
+    size_t capacity_ = 0;    // points the GL buffer holds
+    size_t dirty_first_ = 0; // points before this are already on the GPU
+    bool gl_failed_ = false;
+};
+
+#endif // GPU_SERIES_H
@@ -1,3 +1,503 @@
 //
 // Created by Shazaib malik on 13/05/2025.
 //
+
+#include "graph_plotter.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <implot.h>
+#include <implot_internal.h>
+#include "../util/profiler.h"
+
+// Quads per reservation: 8 vertices per candle keeps a chunk well inside 16-bit indices
+static constexpr int kCandlesPerChunk = 4096;
+
+static inline double column(const double* values, int index, int stride) {
+    return *reinterpret_cast<const double*>(reinterpret_cast<const char*>(values) + static_cast<size_t>(index) * stride);
+}
+
+// First index whose time is >= value
+static int lowerBound(const CandleColumns& candles, double value) {
+    int first = 0, count = candles.count;
+    while (count > 0) {
+        int half = count / 2;
+        if (column(candles.time, first + half, candles.stride) < value) {
+            first += half + 1;
+            count -= half + 1;
+        } else {
+            count = half;
+        }
+    }
+    return first;
+}
+
+void PlotCandlesticks(const char* label_id, const CandleColumns& candles, const CandleStyle& style) {
+    PROFILE_SCOPE("PlotCandlesticks");
+    if (candles.count <= 0) return;
+    ImPlot::SetNextFillStyle(style.bull);
+    if (!ImPlot::BeginItem(label_id, ImPlotItemFlags_None, ImPlotCol_Fill)) return;
+
+    const int stride = candles.stride;
+    if (ImPlot::FitThisFrame()) {
+        for (int i = 0; i < candles.count; ++i) {
+            double t = column(candles.time, i, stride);
+            ImPlot::FitPoint(ImPlotPoint(t, column(candles.low, i, stride)));
+            ImPlot::FitPoint(ImPlotPoint(t, column(candles.high, i, stride)));
+        }
+    }
+
+    ImPlotPlot& plot = *ImPlot::GetCurrentPlot();
+    const ImPlotAxis& x_axis = plot.Axes[plot.CurrentX];
+    const ImPlotAxis& y_axis = plot.Axes[plot.CurrentY];
+
+    // Spacing from the first two candles; bars are evenly spaced in this app
+    double spacing = candles.count > 1 ? column(candles.time, 1, stride) - column(candles.time, 0, stride) : 1.0;
+    double half_body = spacing * style.body_width * 0.5;
+    int first = lowerBound(candles, x_axis.Range.Min - half_body);
+    int last = lowerBound(candles, x_axis.Range.Max + half_body + 1e-9 * spacing);
+
+    ImDrawList& draw = *ImPlot::GetPlotDrawList();
+    const ImU32 bull = ImGui::GetColorU32(style.bull);
+    const ImU32 bear = ImGui::GetColorU32(style.bear);
+    const ImU32 wick = ImGui::GetColorU32(style.wick);
+    const float half_wick = std::max(0.5f, style.wick_weight * 0.5f);
+    float half_width = std::fabs(x_axis.PlotToPixels(x_axis.Range.Min + half_body) - x_axis.PlotToPixels(x_axis.Range.Min));
+    half_width = std::max(half_width, 0.5f);
+
+    for (int chunk = first; chunk < last; chunk += kCandlesPerChunk) {
+        int end = std::min(last, chunk + kCandlesPerChunk);
+        draw.PrimReserve((end - chunk) * 12, (end - chunk) * 8);
+        for (int i = chunk; i < end; ++i) {
+            double open = column(candles.open, i, stride);
+            double close = column(candles.close, i, stride);
+            float x = x_axis.PlotToPixels(column(candles.time, i, stride));
+            float high = y_axis.PlotToPixels(column(candles.high, i, stride));
+            float low = y_axis.PlotToPixels(column(candles.low, i, stride));
+            float open_px = y_axis.PlotToPixels(open);
+            float close_px = y_axis.PlotToPixels(close);
+            // Pixel y grows downwards, so the top edge is the smaller value
+            float body_top = std::min(open_px, close_px);
+            float body_bottom = std::max(std::max(open_px, close_px), body_top + 1.0f); // dojis stay visible
+            draw.PrimRect(ImVec2(x - half_wick, std::min(high, low)), ImVec2(x + half_wick, std::max(high, low)), wick);
+            draw.PrimRect(ImVec2(x - half_width, body_top), ImVec2(x + half_width, body_bottom),
+                          close >= open ? bull : bear);
+        }
+    }
+    ImPlot::EndItem();
+}
+
+void CandlePyramid::assign(const CandleColumns& candles) {
+    PROFILE_SCOPE("CandlePyramid::assign");
+    for (Level& level : levels_) {
+        level.time.clear();
+        level.open.clear();
+        level.high.clear();
+        level.low.clear();
+        level.close.clear();
+    }
+    update(0, candles);
+    if (size() == 0) levels_.clear();
+}
+
+void CandlePyramid::update(size_t first, const CandleColumns& candles) {
+    if (candles.count <= 0) return;
+    if (levels_.empty()) levels_.emplace_back();
+    Level& base = levels_[0];
+    first = std::min(first, base.time.size());
+    size_t count = static_cast<size_t>(candles.count);
+    size_t last = first + count;
+    if (base.time.size() < last) {
+        base.time.resize(last);
+        base.open.resize(last);
+        base.high.resize(last);
+        base.low.resize(last);
+        base.close.resize(last);
+    }
+    for (size_t i = 0; i < count; ++i) {
+        int row = static_cast<int>(i);
+        base.time[first + i] = column(candles.time, row, candles.stride);
+        base.open[first + i] = column(candles.open, row, candles.stride);
+        base.high[first + i] = column(candles.high, row, candles.stride);
+        base.low[first + i] = column(candles.low, row, candles.stride);
+        base.close[first + i] = column(candles.close, row, candles.stride);
+    }
+    // Bottom-up, each level once over the parents of the dirty range
+    size_t k = 1;
+    for (; levels_[k - 1].time.size() > 1; ++k) {
+        if (k == levels_.size()) levels_.emplace_back();
+        first >>= 1;
+        last = (last + 1) >> 1;
+        for (size_t bucket = first; bucket < last; ++bucket) merge(k, bucket);
+    }
+    levels_.resize(k);
+}
+
+void CandlePyramid::append(double time, double open, double high, double low, double close) {
+    if (levels_.empty()) levels_.emplace_back();
+    Level& base = levels_[0];
+    base.time.push_back(time);
+    base.open.push_back(open);
+    base.high.push_back(high);
+    base.low.push_back(low);
+    base.close.push_back(close);
+    propagate(base.time.size() - 1);
+}
+
+void CandlePyramid::set(size_t index, double time, double open, double high, double low, double close) {
+    if (index >= size()) return;
+    Level& base = levels_[0];
+    base.time[index] = time;
+    base.open[index] = open;
+    base.high[index] = high;
+    base.low[index] = low;
+    base.close[index] = close;
+    propagate(index);
+}
+
+void CandlePyramid::propagate(size_t index) {
+    for (size_t k = 1;; ++k) {
+        // A level exists while the one below it still has more than one bucket
+        if (levels_[k - 1].time.size() <= 1) {
+            levels_.resize(k);
+            return;
+        }
+        if (k == levels_.size()) levels_.emplace_back();
+        index >>= 1;
+        merge(k, index);
+    }
+}
+
+void CandlePyramid::merge(size_t k, size_t bucket) {
+    const Level& below = levels_[k - 1];
+    Level& level = levels_[k];
+    size_t first = bucket * 2;
+    size_t last = std::min(first + 1, below.time.size() - 1);
+    if (bucket == level.time.size()) {
+        level.time.emplace_back();
+        level.open.emplace_back();
+        level.high.emplace_back();
+        level.low.emplace_back();
+        level.close.emplace_back();
+    }
+    level.time[bucket] = 0.5 * (below.time[first] + below.time[last]);
+    level.open[bucket] = below.open[first];
+    level.close[bucket] = below.close[last];
+    level.high[bucket] = std::max(below.high[first], below.high[last]);
+    level.low[bucket] = std::min(below.low[first], below.low[last]);
+}
+
+CandleColumns CandlePyramid::level(size_t k) const {
+    CandleColumns columns;
+    if (k >= levels_.size()) return columns;
+    const Level& level = levels_[k];
+    columns.time = level.time.data();
+    columns.open = level.open.data();
+    columns.high = level.high.data();
+    columns.low = level.low.data();
+    columns.close = level.close.data();
+    columns.count = static_cast<int>(level.time.size());
+    return columns;
+}
+
+size_t CandlePyramid::levelFor(double visible_candles, float pixels) const {
+    if (levels_.empty() || pixels <= 0.0f) return 0;
+    size_t k = 0;
+    while (k + 1 < levels_.size() && visible_candles / static_cast<double>(size_t(1) << k) > pixels) ++k;
+    return k;
+}
+
+void CandlePyramid::indexRange(double x_min, double x_max, size_t& first, size_t& last) const {
+    CandleColumns base = level(0);
+    first = static_cast<size_t>(lowerBound(base, x_min));
+    last = static_cast<size_t>(lowerBound(base, std::nextafter(x_max, HUGE_VAL)));
+}
+
+bool CandlePyramid::extremes(size_t first, size_t last, double& low, double& high) const {
+    last = std::min(last, size());
+    if (first >= last) return false;
+    low = HUGE_VAL;
+    high = -HUGE_VAL;
+    // Bottom-up segment tree walk: take the unaligned ends on this level, then go up
+    for (size_t k = 0; first < last && k < levels_.size(); ++k) {
+        const Level& level = levels_[k];
+        if (first & 1) {
+            low = std::min(low, level.low[first]);
+            high = std::max(high, level.high[first]);
+            ++first;
+        }
+        if (last & 1) {
+            --last;
+            low = std::min(low, level.low[last]);
+            high = std::max(high, level.high[last]);
+        }
+        first >>= 1;
+        last >>= 1;
+    }
+    return true;
+}
+
+void ChartAutoRange::append(double low, double high) {
+    size_t index = appended_++;
+    while (!lows_.empty() && lows_.back().second >= low) lows_.pop_back();
+    lows_.emplace_back(index, low);
+    while (!highs_.empty() && highs_.back().second <= high) highs_.pop_back();
+    highs_.emplace_back(index, high);
+    size_t oldest = appended_ > window_ ? appended_ - window_ : 0;
+    while (lows_.front().first < oldest) lows_.pop_front();
+    while (highs_.front().first < oldest) highs_.pop_front();
+}
+
+void ChartAutoRange::reset() {
+    appended_ = 0;
+    lows_.clear();
+    highs_.clear();
+}
+
+bool ChartAutoRange::limits(const CandlePyramid& candles, double x_min, double x_max, double& y_min, double& y_max,
+                            double margin) const {
+    size_t first = 0, last = 0;
+    candles.indexRange(x_min, x_max, first, last);
+    if (first >= last) return false;
+    double low = 0.0, high = 0.0;
+    bool following = appended_ == candles.size() && last == candles.size() && last - first == std::min(window_, last);
+    if (following) {
+        low = lows_.front().second;
+        high = highs_.front().second;
+    } else if (!candles.extremes(first, last, low, high)) {
+        return false;
+    }
+    double pad = (high - low) * margin;
+    if (high == low) pad = std::max(std::fabs(high) * 0.01, 1e-9); // flat range: keep a visible band
+    y_min = low - pad;
+    y_max = high + pad;
+    return true;
+}
+
+void PlotCandlesticks(const char* label_id, const CandlePyramid& candles, const CandleStyle& style) {
+    if (candles.size() == 0) return;
+    ImPlotPlot& plot = *ImPlot::GetCurrentPlot();
+    const ImPlotRange& range = plot.Axes[plot.CurrentX].Range;
+    CandleColumns base = candles.level(0);
+    double visible = lowerBound(base, range.Max) - lowerBound(base, range.Min);
+    PlotCandlesticks(label_id, candles.level(candles.levelFor(visible, plot.PlotRect.GetWidth())), style);
+}
+
+size_t decimateLttb(const double* xs, const double* ys, size_t count, size_t threshold, double* out_x,
+                    double* out_y) {
+    threshold = std::max<size_t>(threshold, 3);
+    if (threshold >= count) {
+        std::copy(xs, xs + count, out_x);
+        std::copy(ys, ys + count, out_y);
+        return count;
+    }
+    size_t written = 0;
+    out_x[written] = xs[0];
+    out_y[written++] = ys[0];
+    // The points between the ends are split into threshold - 2 buckets; from each, keep the
+    // point forming the largest triangle with the last kept point and the next bucket's mean
+    double bucket_size = static_cast<double>(count - 2) / static_cast<double>(threshold - 2);
+    size_t kept = 0;
+    for (size_t b = 0; b < threshold - 2; ++b) {
+        size_t start = static_cast<size_t>(b * bucket_size) + 1;
+        size_t end = static_cast<size_t>((b + 1) * bucket_size) + 1;
+        size_t next_end = std::min(static_cast<size_t>((b + 2) * bucket_size) + 1, count);
+        double mean_x = 0.0, mean_y = 0.0;
+        for (size_t i = end; i < next_end; ++i) {
+            mean_x += xs[i];
+            mean_y += ys[i];
+        }
+        size_t next_count = next_end - end;
+        if (next_count > 0) {
+            mean_x /= static_cast<double>(next_count);
+            mean_y /= static_cast<double>(next_count);
+        } else {
+            mean_x = xs[count - 1];
+            mean_y = ys[count - 1];
+        }
+        double best_area = -1.0;
+        size_t best = start;
+        for (size_t i = start; i < end; ++i) {
+            double area = std::fabs((xs[kept] - mean_x) * (ys[i] - ys[kept]) - (xs[kept] - xs[i]) * (mean_y - ys[kept]));
+            if (area > best_area) {
+                best_area = area;
+                best = i;
+            }
+        }
+        out_x[written] = xs[best];
+        out_y[written++] = ys[best];
+        kept = best;
+    }
+    out_x[written] = xs[count - 1];
+    out_y[written++] = ys[count - 1];
+    return written;
+}
+
+void DecimatedLine::plot(const char* label_id, const double* xs, const double* ys, int count, int stride) {
+    if (count <= 0) return;
+    ImPlotPlot& plot = *ImPlot::GetCurrentPlot();
+    const ImPlotRange& range = plot.Axes[plot.CurrentX].Range;
+    float width = plot.PlotRect.GetWidth();
+    bool unchanged = !dirty_ && xs == key_.xs && ys == key_.ys && count == key_.count && stride == key_.stride &&
+                     range.Min == key_.min && range.Max == key_.max && width == key_.width;
+    if (!unchanged) {
+        PROFILE_SCOPE("decimate line");
+        key_ = {xs, ys, count, stride, range.Min, range.Max, width};
+        dirty_ = false;
+        CandleColumns columns;
+        columns.time = xs;
+        columns.count = count;
+        columns.stride = stride;
+        // One point either side of the range so the line runs off the plot edges
+        int first = std::max(0, lowerBound(columns, range.Min) - 1);
+        int last = std::min(count, lowerBound(columns, range.Max) + 1);
+        size_t visible = static_cast<size_t>(std::max(0, last - first));
+
+        const char* x_bytes = reinterpret_cast<const char*>(xs) + static_cast<size_t>(first) * stride;
+        const char* y_bytes = reinterpret_cast<const char*>(ys) + static_cast<size_t>(first) * stride;
+        const double* slice_x = reinterpret_cast<const double*>(x_bytes);
+        const double* slice_y = reinterpret_cast<const double*>(y_bytes);
+        if (stride != sizeof(double)) {
+            in_x_.resize(visible);
+            in_y_.resize(visible);
+            for (size_t i = 0; i < visible; ++i) {
+                in_x_[i] = column(xs, first + static_cast<int>(i), stride);
+                in_y_[i] = column(ys, first + static_cast<int>(i), stride);
+            }
+            slice_x = in_x_.data();
+            slice_y = in_y_.data();
+        }
+        size_t threshold = std::max<size_t>(3, static_cast<size_t>(width * 2.0f));
+        x_.resize(std::min(visible, threshold));
+        y_.resize(x_.size());
+        x_.resize(decimateLttb(slice_x, slice_y, visible, threshold, x_.data(), y_.data()));
+        y_.resize(x_.size());
+    }
+    ImPlot::PlotLine(label_id, x_.data(), y_.data(), static_cast<int>(x_.size()));
+}
+
+void ChartIndicators::reset(const IndicatorSettings& settings) {
+    settings_ = settings;
+    sma_ = indicators::Sma(static_cast<size_t>(std::max(1, settings.sma_period)));
+    ema_ = indicators::Ema(static_cast<size_t>(std::max(1, settings.ema_period)));
+    bollinger_ = indicators::Bollinger(static_cast<size_t>(std::max(1, settings.bollinger_period)), settings.bollinger_k);
+    rsi_ = indicators::Rsi(static_cast<size_t>(std::max(1, settings.rsi_period)));
+    macd_ = indicators::Macd();
+    time_.clear();
+    for (Line* line : {&sma_line_, &ema_line_, &middle_, &upper_, &lower_, &rsi_line_, &macd_line_, &signal_line_}) {
+        line->values.clear();
+        line->first = 0;
+        line->plot.markDirty();
+    }
+}
+
+void ChartIndicators::configure(const IndicatorSettings& settings, const CandlePyramid& candles) {
+    PROFILE_SCOPE("ChartIndicators::configure");
+    reset(settings);
+    CandleColumns base = candles.level(0);
+    size_t count = candles.size();
+    if (count == 0) return;
+    time_.assign(base.time, base.time + count);
+    auto prepare = [count](Line& line, size_t warmup) {
+        line.values.resize(count);
+        line.first = std::min(warmup, count);
+        return line.values.data();
+    };
+    size_t sma_period = static_cast<size_t>(std::max(1, settings_.sma_period));
+    size_t ema_period = static_cast<size_t>(std::max(1, settings_.ema_period));
+    size_t bollinger_period = static_cast<size_t>(std::max(1, settings_.bollinger_period));
+    size_t rsi_period = static_cast<size_t>(std::max(1, settings_.rsi_period));
+    if (settings_.sma) indicators::smaSeries(base.close, count, sma_period, prepare(sma_line_, sma_period - 1));
+    if (settings_.ema) indicators::emaSeries(base.close, count, ema_period, prepare(ema_line_, ema_period - 1));
+    if (settings_.bollinger) {
+        indicators::bollingerSeries(base.close, count, bollinger_period, settings_.bollinger_k,
+                                    prepare(middle_, bollinger_period - 1), prepare(upper_, bollinger_period - 1),
+                                    prepare(lower_, bollinger_period - 1));
+    }
+    if (settings_.rsi) indicators::rsiSeries(base.close, count, rsi_period, prepare(rsi_line_, rsi_period));
+    if (settings_.macd) {
+        std::vector<double> histogram(count);
+        indicators::macdSeries(base.close, count, 12, 26, 9, prepare(macd_line_, 25), prepare(signal_line_, 33),
+                               histogram.data());
+    }
+    // The kernels repeat the streaming arithmetic, so replaying the candles through the
+    // streams leaves them exactly where the lines end and later appends continue them
+    for (size_t i = 0; i < count; ++i) {
+        if (settings_.sma) sma_.update(base.close[i]);
+        if (settings_.ema) ema_.update(base.close[i]);
+        if (settings_.bollinger) bollinger_.update(base.close[i]);
+        if (settings_.rsi) rsi_.update(base.close[i]);
+        if (settings_.macd) macd_.update(base.close[i]);
+    }
+}
+
+void ChartIndicators::append(double time, double close) {
+    time_.push_back(time);
+    if (settings_.sma) sma_line_.values.push_back(sma_.update(close));
+    if (settings_.ema) ema_line_.values.push_back(ema_.update(close));
+    if (settings_.bollinger) {
+        indicators::BollingerValue bands = bollinger_.update(close);
+        middle_.values.push_back(bands.middle);
+        upper_.values.push_back(bands.upper);
+        lower_.values.push_back(bands.lower);
+    }
+    if (settings_.rsi) rsi_line_.values.push_back(rsi_.update(close));
+    if (settings_.macd) {
+        indicators::MacdValue macd = macd_.update(close);
+        macd_line_.values.push_back(macd.macd);
+        signal_line_.values.push_back(macd.signal);
+    }
+    // Lines still warming up keep first at the current end until they produce a value
+    for (Line* line : {&sma_line_, &ema_line_, &middle_, &upper_, &lower_, &rsi_line_, &macd_line_, &signal_line_}) {
+        if (!line->values.empty() && line->first == line->values.size() - 1 && std::isnan(line->values.back())) {
+            line->first = line->values.size();
+        }
+    }
+}
+
+void ChartIndicators::plot(const char* label_id, Line& line) {
+    size_t count = std::min(line.values.size(), time_.size());
+    if (count <= line.first) return;
+    line.plot.plot(label_id, time_.data() + line.first, line.values.data() + line.first,
+                   static_cast<int>(count - line.first));
+}
+
+void ChartIndicators::plotOverlays() {
+    PROFILE_SCOPE("indicator overlays");
+    char label[32];
+    if (settings_.sma) {
+        snprintf(label, sizeof(label), "SMA %d", settings_.sma_period);
+        plot(label, sma_line_);
+    }
+    if (settings_.ema) {
+        snprintf(label, sizeof(label), "EMA %d", settings_.ema_period);
+        plot(label, ema_line_);
+    }
+    if (settings_.bollinger) {
+        // One legend entry for all three bands
+        snprintf(label, sizeof(label), "BB %d", settings_.bollinger_period);
+        plot(label, middle_);
+        plot(label, upper_);
+        plot(label, lower_);
+    }
+}
+
+void ChartIndicators::plotOscillators(double x_min, double x_max, float width) {
+    PROFILE_SCOPE("indicator oscillators");
+    if (settings_.rsi && ImPlot::BeginPlot("##RSI", ImVec2(width, 120.0f), ImPlotFlags_NoMenus)) {
+        ImPlot::SetupAxes(nullptr, "RSI", ImPlotAxisFlags_NoTickLabels);
+        ImPlot::SetupAxisLimits(ImAxis_X1, x_min, x_max, ImGuiCond_Always);
+        ImPlot::SetupAxisLimits(ImAxis_Y1, 0.0, 100.0, ImGuiCond_Always);
+        static const double levels[] = {30.0, 70.0};
+        ImPlot::PlotInfLines("##levels", levels, 2, ImPlotInfLinesFlags_Horizontal);
+        plot("RSI", rsi_line_);
+        ImPlot::EndPlot();
+    }
+    if (settings_.macd && ImPlot::BeginPlot("##MACD", ImVec2(width, 120.0f), ImPlotFlags_NoMenus)) {
+        ImPlot::SetupAxes(nullptr, "MACD", ImPlotAxisFlags_NoTickLabels, ImPlotAxisFlags_AutoFit | ImPlotAxisFlags_RangeFit);
+        ImPlot::SetupAxisLimits(ImAxis_X1, x_min, x_max, ImGuiCond_Always);
+        plot("MACD", macd_line_);
+        plot("Signal", signal_line_);
+        ImPlot::EndPlot();
+    }
+}
@@ -5,4 +5,180 @@
 #ifndef GRAPH_PLOTTER_H
 #define GRAPH_PLOTTER_H
 
+#include <algorithm>
+#include <cstddef>
+#include <deque>
+#include <utility>
+#include <vector>
+#include <imgui.h>
+#include "../indicators/indicators.h"
+
+// Where the OHLC values live: either separate arrays, or the fields of one array of
+// structs with stride set to the struct size. Times must be ascending.
+struct CandleColumns {
+    const double* time = nullptr;
+    const double* open = nullptr;
+    const double* high = nullptr;
+    const double* low = nullptr;
+    const double* close = nullptr;
+    int count = 0;
+    int stride = sizeof(double); // bytes between consecutive values of a column
+};
+
+struct CandleStyle {
+    ImVec4 bull = ImVec4(0, 1, 0, 1);
+    ImVec4 bear = ImVec4(1, 0, 0, 1);
+    ImVec4 wick = ImVec4(1, 1, 1, 1);
+    float body_width = 0.6f;  // fraction of the spacing between candles
+    float wick_weight = 2.0f; // pixels
+};
+
+// One ImPlot item (one legend entry) for the whole series. Only candles inside the x
+// limits are visited, found by binary search, and their bodies and wicks are written
+// straight into the plot's draw list as quads, reserved in large chunks.
+// Call between ImPlot::BeginPlot and ImPlot::EndPlot.
+void PlotCandlesticks(const char* label_id, const CandleColumns& candles, const CandleStyle& style = CandleStyle());
+
+// OHLC merged over power-of-two buckets: level k has one candle per 2^k source candles
+// (open of the first, close of the last, extremes of all of them), so a chart can draw
+// about one candle per pixel column at any zoom. Appending or editing a candle re-merges
+// one bucket per level.
+class CandlePyramid {
+public:
+    void clear() { levels_.clear(); }
+    // Keeps the levels' capacity, so re-assigning a history of similar length doesn't allocate
+    void assign(const CandleColumns& candles);
+    // Writes candles over [first, first + count), growing past the end, and re-merges only the
+    // buckets above that dirty range: O(count + log n) rather than a propagate per candle
+    void update(size_t first, const CandleColumns& candles);
+    void append(double time, double open, double high, double low, double close);
+    // Replaces an existing candle
+    void set(size_t index, double time, double open, double high, double low, double close);
+
+    size_t size() const { return levels_.empty() ? 0 : levels_[0].time.size(); }
+    size_t levelCount() const { return levels_.size(); }
+    CandleColumns level(size_t k) const;
+    // Finest level that puts no more than one bucket in each pixel column
+    size_t levelFor(double visible_candles, float pixels) const;
+    // Candles [first, last) whose time lies in [x_min, x_max]
+    void indexRange(double x_min, double x_max, size_t& first, size_t& last) const;
+    // Lowest low and highest high of candles [first, last), read off the levels like a
+    // segment tree in O(log n). False for an empty range.
+    bool extremes(size_t first, size_t last, double& low, double& high) const;
+
+private:
+    struct Level {
+        std::vector<double> time, open, high, low, close;
+    };
+    void merge(size_t k, size_t bucket); // rebuilds bucket from its two children on level k - 1
+    void propagate(size_t index);        // re-merges every bucket above level 0 candle index
+
+    std::vector<Level> levels_;
+};
+
+// Y-axis limits for whatever candles are in view. While the view follows the newest
+// candles, monotonic deques over the last follow_window appends give the extremes in O(1)
+// amortized per new candle; any other view (panned, zoomed, or after candles were edited)
+// is an O(log n) query on the pyramid.
+class ChartAutoRange {
+public:
+    // A window of at least one candle, so append() never empties its deques
+    explicit ChartAutoRange(size_t follow_window = 50) : window_(std::max<size_t>(follow_window, 1)) {}
+
+    // Call for every candle appended to the pyramid
+    void append(double low, double high);
+    // Call when candles were replaced or removed rather than appended
+    void reset();
+
+    // Visible extremes padded by margin (a fraction of their span) on each side
+    bool limits(const CandlePyramid& candles, double x_min, double x_max, double& y_min, double& y_max,
+                double margin = 0.1) const;
+
+private:
+    size_t window_;
+    size_t appended_ = 0;
+    std::deque<std::pair<size_t, double>> lows_;  // increasing values, oldest first
+    std::deque<std::pair<size_t, double>> highs_; // decreasing values, oldest first
+};
+
+// Picks the pyramid level for the current x range and plot width, then draws it as above
+void PlotCandlesticks(const char* label_id, const CandlePyramid& candles, const CandleStyle& style = CandleStyle());
+
+// Largest-Triangle-Three-Buckets: keeps threshold points (at least 3, first and last
+// included) that preserve the visual shape of the series. Returns the number written to
+// out_x/out_y, which need room for min(count, threshold).
+size_t decimateLttb(const double* xs, const double* ys, size_t count, size_t threshold, double* out_x, double* out_y);
+
+// A line series that only ever hands ImPlot about two points per pixel column: the points
+// inside the x range are cut out and reduced with LTTB into buffers reused across frames.
+// The reduction is redone only when the range, plot width or input changes; call
+// markDirty() after editing values in place.
+class DecimatedLine {
+public:
+    void plot(const char* label_id, const double* xs, const double* ys, int count, int stride = sizeof(double));
+    void markDirty() { dirty_ = true; }
+
+private:
+    struct Key {
+        const double* xs = nullptr;
+        const double* ys = nullptr;
+        int count = 0;
+        int stride = 0;
+        double min = 0.0, max = 0.0;
+        float width = 0.0f;
+    };
+
+    std::vector<double> x_, y_;
+    std::vector<double> in_x_, in_y_; // visible slice, gathered when the input is strided
+    Key key_;
+    bool dirty_ = true;
+};
+
+struct IndicatorSettings {
+    bool sma = true;
+    int sma_period = 20;
+    bool ema = false;
+    int ema_period = 50;
+    bool bollinger = false;
+    int bollinger_period = 20;
+    float bollinger_k = 2.0f;
+    bool rsi = false;
+    int rsi_period = 14;
+    bool macd = false;
+};
+
+// Indicator lines for the chart's candles. Appends advance streaming indicators, O(1) per
+// candle and line however long the history; changing the settings recomputes the lines
+// with the batch kernels. Every line is drawn through a DecimatedLine.
+class ChartIndicators {
+public:
+    explicit ChartIndicators(const IndicatorSettings& settings = IndicatorSettings()) { reset(settings); }
+
+    void configure(const IndicatorSettings& settings, const CandlePyramid& candles);
+    void append(double time, double close);
+
+    // Price-scale lines (SMA, EMA, Bollinger bands), inside the candlestick plot
+    void plotOverlays();
+    // RSI and MACD in plots of their own under the chart, sharing its x range
+    void plotOscillators(double x_min, double x_max, float width);
+
+private:
+    struct Line {
+        std::vector<double> values;
+        size_t first = 0; // first index past the warm-up
+        DecimatedLine plot;
+    };
+    void reset(const IndicatorSettings& settings);
+    void plot(const char* label_id, Line& line);
+
+    IndicatorSettings settings_;
+    indicators::Sma sma_{1};
+    indicators::Ema ema_{1};
+    indicators::Bollinger bollinger_;
+    indicators::Rsi rsi_;
+    indicators::Macd macd_;
+    std::vector<double> time_;
+    Line sma_line_, ema_line_, middle_, upper_, lower_, rsi_line_, macd_line_, signal_line_;
+};
+
 #endif //GRAPH_PLOTTER_H
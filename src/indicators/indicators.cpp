@@ -0,0 +1,172 @@
+#include "indicators.h"
+#include <algorithm>
+
+// Each kernel repeats its streaming class's arithmetic step for step, so a chart or backtest
+// that switches from batch history to live updates sees no seam.
+
+namespace indicators {
+
+void smaSeries(const double* input, size_t count, size_t period, double* out) {
+    if (period == 0) period = 1;
+    const double* __restrict x = input;
+    double* __restrict o = out;
+    // The differences entering the running sum; before the window fills, the ring holds zeros
+    size_t head = std::min(period, count);
+    for (size_t i = 0; i < head; ++i) o[i] = x[i] - 0.0;
+    for (size_t i = head; i < count; ++i) o[i] = x[i] - x[i - period];
+    double sum = 0.0;
+    double n = static_cast<double>(period);
+    for (size_t i = 0; i < count; ++i) {
+        sum += o[i];
+        o[i] = i + 1 >= period ? sum / n : nan();
+    }
+}
+
+void emaSeries(const double* input, size_t count, size_t period, double* out) {
+    if (period == 0) period = 1;
+    double alpha = 2.0 / (static_cast<double>(period) + 1.0);
+    double ema = 0.0;
+    size_t head = std::min(period, count);
+    for (size_t i = 0; i < head; ++i) {
+        ema += input[i];
+        out[i] = nan();
+    }
+    if (head < period) return;
+    ema /= static_cast<double>(period);
+    out[period - 1] = ema;
+    for (size_t i = period; i < count; ++i) {
+        ema += alpha * (input[i] - ema);
+        out[i] = ema;
+    }
+}
+
+void rsiSeries(const double* close, size_t count, size_t period, double* out) {
+    if (count == 0) return;
+    if (period == 0) period = 1;
+    const double* __restrict c = close;
+    double* __restrict o = out;
+    for (size_t i = 1; i < count; ++i) o[i] = c[i] - c[i - 1];
+    o[0] = nan();
+
+    double n = static_cast<double>(period);
+    double avg_gain = 0.0, avg_loss = 0.0;
+    for (size_t i = 1; i < count; ++i) {
+        double change = o[i];
+        double gain = change > 0.0 ? change : 0.0;
+        double loss = change < 0.0 ? -change : 0.0;
+        if (i <= period) {
+            avg_gain += gain;
+            avg_loss += loss;
+            if (i == period) {
+                avg_gain /= n;
+                avg_loss /= n;
+            }
+        } else {
+            avg_gain = (avg_gain * (n - 1.0) + gain) / n;
+            avg_loss = (avg_loss * (n - 1.0) + loss) / n;
+        }
+        if (i < period) {
+            o[i] = nan();
+        } else if (avg_loss == 0.0) {
+            o[i] = avg_gain == 0.0 ? 50.0 : 100.0;
+        } else {
+            o[i] = 100.0 - 100.0 / (1.0 + avg_gain / avg_loss);
+        }
+    }
+}
+
+void macdSeries(const double* close, size_t count, size_t fast, size_t slow, size_t signal, double* macd,
+                double* signal_out, double* histogram) {
+    // histogram and signal_out hold the two EMAs until they are needed for their own results
+    emaSeries(close, count, fast, histogram);
+    emaSeries(close, count, slow, signal_out);
+    {
+        const double* __restrict f = histogram;
+        const double* __restrict s = signal_out;
+        double* __restrict m = macd;
+        for (size_t i = 0; i < count; ++i) m[i] = f[i] - s[i];
+    }
+    // The signal line starts with the first MACD value, when the slow EMA is ready
+    size_t start = std::min(std::max<size_t>(slow, 1) - 1, count);
+    std::fill(signal_out, signal_out + start, nan());
+    emaSeries(macd + start, count - start, signal, signal_out + start);
+    const double* __restrict m = macd;
+    const double* __restrict s = signal_out;
+    double* __restrict h = histogram;
+    for (size_t i = 0; i < count; ++i) h[i] = m[i] - s[i];
+}
+
+void bollingerSeries(const double* close, size_t count, size_t period, double k, double* middle, double* upper,
+                     double* lower) {
+    if (period == 0) period = 1;
+    double n = static_cast<double>(period);
+    double mean = 0.0, m2 = 0.0;
+    // Scalar pass: sliding mean into middle, M2 into upper
+    for (size_t i = 0; i < count; ++i) {
+        double x = close[i];
+        if (i < period) {
+            double delta = x - mean;
+            mean += delta / static_cast<double>(i + 1);
+            m2 += delta * (x - mean);
+        } else {
+            double old = close[i - period];
+            double old_mean = mean;
+            mean += (x - old) / n;
+            m2 += (x - old) * (x - mean + old - old_mean);
+            if (m2 < 0.0) m2 = 0.0;
+        }
+        bool ready = i + 1 >= period;
+        middle[i] = ready ? mean : nan();
+        upper[i] = ready ? m2 : nan();
+    }
+    const double* __restrict mid = middle;
+    double* __restrict up = upper;
+    double* __restrict low = lower;
+    for (size_t i = 0; i < count; ++i) {
+        double band = k * std::sqrt(up[i] / n);
+        up[i] = mid[i] + band;
+        low[i] = mid[i] - band;
+    }
+}
+
+void atrSeries(const double* high, const double* low, const double* close, size_t count, size_t period, double* out) {
+    if (count == 0) return;
+    if (period == 0) period = 1;
+    const double* __restrict h = high;
+    const double* __restrict l = low;
+    const double* __restrict c = close;
+    double* __restrict o = out;
+    o[0] = h[0] - l[0];
+    for (size_t i = 1; i < count; ++i) o[i] = trueRange(h[i], l[i], c[i - 1]);
+
+    double n = static_cast<double>(period);
+    double atr = 0.0;
+    for (size_t i = 0; i < count; ++i) {
+        double range = o[i];
+        if (i < period) {
+            atr += range;
+            if (i + 1 == period) atr /= n;
+        } else {
+            atr = (atr * (n - 1.0) + range) / n;
+        }
+        o[i] = i + 1 >= period ? atr : nan();
+    }
+}
+
+void vwapSeries(const double* high, const double* low, const double* close, const double* volume, size_t count,
+                double* out) {
+    const double* __restrict h = high;
+    const double* __restrict l = low;
+    const double* __restrict c = close;
+    const double* __restrict v = volume;
+    double* __restrict o = out;
+    for (size_t i = 0; i < count; ++i) o[i] = (h[i] + l[i] + c[i]) / 3.0 * v[i];
+    double price_volume = 0.0, total_volume = 0.0;
+    for (size_t i = 0; i < count; ++i) {
+        price_volume += o[i];
+        total_volume += v[i];
+        o[i] = total_volume > 0.0 ? price_volume / total_volume : nan();
+    }
+}
+
+} // namespace indicators
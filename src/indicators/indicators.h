@@ -0,0 +1,258 @@
+#ifndef INDICATORS_H
+#define INDICATORS_H
+
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+// Technical indicators in two forms that produce bit-identical numbers:
+//  - streaming classes: update() once per new bar, O(1) with no rescans and no allocation
+//    after construction. Defined inline so strategies built on them inline into the backtest loop.
+//  - batch *Series functions: one pass over a history's columns (charts, analysis).
+// Until an indicator has seen enough bars, ready() is false and value() / batch output is NaN.
+
+namespace indicators {
+
+inline double nan() { return std::numeric_limits<double>::quiet_NaN(); }
+
+// Simple moving average: running sum over a ring of the last `period` inputs
+class Sma {
+public:
+    explicit Sma(size_t period) : period_(period == 0 ? 1 : period), window_(period_, 0.0) {}
+
+    double update(double input) {
+        size_t slot = seen_ % period_;
+        sum_ += input - window_[slot];
+        window_[slot] = input;
+        ++seen_;
+        return value();
+    }
+    bool ready() const { return seen_ >= period_; }
+    double value() const { return ready() ? sum_ / static_cast<double>(period_) : nan(); }
+    size_t period() const { return period_; }
+
+private:
+    size_t period_;
+    std::vector<double> window_;
+    size_t seen_ = 0;
+    double sum_ = 0.0;
+};
+
+// Exponential moving average, alpha = 2 / (period + 1), seeded with the SMA of the first period inputs
+class Ema {
+public:
+    explicit Ema(size_t period)
+        : period_(period == 0 ? 1 : period), alpha_(2.0 / (static_cast<double>(period_) + 1.0)) {}
+
+    double update(double input) {
+        if (seen_ < period_) {
+            ema_ += input;
+            if (++seen_ == period_) ema_ /= static_cast<double>(period_);
+        } else {
+            ema_ += alpha_ * (input - ema_);
+        }
+        return value();
+    }
+    bool ready() const { return seen_ >= period_; }
+    double value() const { return ready() ? ema_ : nan(); }
+    size_t period() const { return period_; }
+
+private:
+    size_t period_;
+    double alpha_;
+    size_t seen_ = 0;
+    double ema_ = 0.0; // running seed sum until ready
+};
+
+// Wilder's RSI: smoothed average gain vs. loss over `period` close-to-close changes
+class Rsi {
+public:
+    explicit Rsi(size_t period = 14) : period_(period == 0 ? 1 : period) {}
+
+    double update(double close) {
+        if (!has_prev_) {
+            prev_ = close;
+            has_prev_ = true;
+            return value();
+        }
+        double change = close - prev_;
+        prev_ = close;
+        double gain = change > 0.0 ? change : 0.0;
+        double loss = change < 0.0 ? -change : 0.0;
+        double n = static_cast<double>(period_);
+        if (changes_ < period_) {
+            avg_gain_ += gain;
+            avg_loss_ += loss;
+            if (++changes_ == period_) {
+                avg_gain_ /= n;
+                avg_loss_ /= n;
+            }
+        } else {
+            avg_gain_ = (avg_gain_ * (n - 1.0) + gain) / n;
+            avg_loss_ = (avg_loss_ * (n - 1.0) + loss) / n;
+        }
+        return value();
+    }
+    bool ready() const { return changes_ >= period_; }
+    double value() const {
+        if (!ready()) return nan();
+        if (avg_loss_ == 0.0) return avg_gain_ == 0.0 ? 50.0 : 100.0;
+        return 100.0 - 100.0 / (1.0 + avg_gain_ / avg_loss_);
+    }
+
+private:
+    size_t period_;
+    size_t changes_ = 0;
+    bool has_prev_ = false;
+    double prev_ = 0.0;
+    double avg_gain_ = 0.0;
+    double avg_loss_ = 0.0;
+};
+
+struct MacdValue {
+    double macd;
+    double signal;
+    double histogram;
+};
+
+// MACD line (fast EMA - slow EMA), its signal EMA, and their difference
+class Macd {
+public:
+    explicit Macd(size_t fast = 12, size_t slow = 26, size_t signal = 9) : fast_(fast), slow_(slow), signal_(signal) {}
+
+    MacdValue update(double close) {
+        fast_.update(close);
+        slow_.update(close);
+        if (slow_.ready()) signal_.update(fast_.value() - slow_.value());
+        return value();
+    }
+    bool ready() const { return signal_.ready(); }
+    MacdValue value() const {
+        double macd = slow_.ready() ? fast_.value() - slow_.value() : nan();
+        double signal = signal_.value();
+        return {macd, signal, macd - signal};
+    }
+
+private:
+    Ema fast_;
+    Ema slow_;
+    Ema signal_;
+};
+
+struct BollingerValue {
+    double middle;
+    double upper;
+    double lower;
+};
+
+// SMA +/- k population standard deviations. Mean and variance slide with Welford-style
+// add/remove updates, which stay accurate at any price level, unlike a sum of squares.
+class Bollinger {
+public:
+    explicit Bollinger(size_t period = 20, double k = 2.0) : period_(period == 0 ? 1 : period), k_(k), window_(period_, 0.0) {}
+
+    BollingerValue update(double close) {
+        size_t slot = seen_ % period_;
+        if (seen_ < period_) {
+            double count = static_cast<double>(seen_ + 1);
+            double delta = close - mean_;
+            mean_ += delta / count;
+            m2_ += delta * (close - mean_);
+        } else {
+            double old = window_[slot];
+            double old_mean = mean_;
+            mean_ += (close - old) / static_cast<double>(period_);
+            m2_ += (close - old) * (close - mean_ + old - old_mean);
+            if (m2_ < 0.0) m2_ = 0.0; // rounding on a flat window
+        }
+        window_[slot] = close;
+        ++seen_;
+        return value();
+    }
+    bool ready() const { return seen_ >= period_; }
+    BollingerValue value() const {
+        if (!ready()) return {nan(), nan(), nan()};
+        double band = k_ * std::sqrt(m2_ / static_cast<double>(period_));
+        return {mean_, mean_ + band, mean_ - band};
+    }
+
+private:
+    size_t period_;
+    double k_;
+    std::vector<double> window_;
+    size_t seen_ = 0;
+    double mean_ = 0.0;
+    double m2_ = 0.0;
+};
+
+// True range against the previous close; the first bar's is just high - low
+inline double trueRange(double high, double low, double prev_close) {
+    return std::fmax(high - low, std::fmax(std::fabs(high - prev_close), std::fabs(low - prev_close)));
+}
+
+// Wilder's average true range, seeded with the mean of the first `period` ranges
+class Atr {
+public:
+    explicit Atr(size_t period = 14) : period_(period == 0 ? 1 : period) {}
+
+    double update(double high, double low, double close) {
+        double range = seen_ == 0 ? high - low : trueRange(high, low, prev_close_);
+        prev_close_ = close;
+        double n = static_cast<double>(period_);
+        if (seen_ < period_) {
+            atr_ += range;
+            if (++seen_ == period_) atr_ /= n;
+        } else {
+            atr_ = (atr_ * (n - 1.0) + range) / n;
+        }
+        return value();
+    }
+    bool ready() const { return seen_ >= period_; }
+    double value() const { return ready() ? atr_ : nan(); }
+
+private:
+    size_t period_;
+    size_t seen_ = 0;
+    double prev_close_ = 0.0;
+    double atr_ = 0.0;
+};
+
+// Volume-weighted average of the typical price (high + low + close) / 3 since the last
+// reset(); call reset() at each session open for the usual intraday VWAP
+class Vwap {
+public:
+    double update(double high, double low, double close, double volume) {
+        price_volume_ += (high + low + close) / 3.0 * volume;
+        volume_ += volume;
+        return value();
+    }
+    void reset() {
+        price_volume_ = 0.0;
+        volume_ = 0.0;
+    }
+    bool ready() const { return volume_ > 0.0; }
+    double value() const { return ready() ? price_volume_ / volume_ : nan(); }
+
+private:
+    double price_volume_ = 0.0;
+    double volume_ = 0.0;
+};
+
+// Batch forms: out[i] is the streaming value after bar i. Outputs hold count values and may
+// not alias the inputs. Element-wise stages are plain __restrict loops the compiler
+// vectorizes; the smoothing recurrences are one scalar step per bar.
+void smaSeries(const double* input, size_t count, size_t period, double* out);
+void emaSeries(const double* input, size_t count, size_t period, double* out);
+void rsiSeries(const double* close, size_t count, size_t period, double* out);
+void macdSeries(const double* close, size_t count, size_t fast, size_t slow, size_t signal, double* macd,
+                double* signal_out, double* histogram);
+void bollingerSeries(const double* close, size_t count, size_t period, double k, double* middle, double* upper,
+                     double* lower);
+void atrSeries(const double* high, const double* low, const double* close, size_t count, size_t period, double* out);
+void vwapSeries(const double* high, const double* low, const double* close, const double* volume, size_t count,
+                double* out);
+
+} // namespace indicators
+
+#endif // INDICATORS_H
@@ -1,6 +1,8 @@
 #include <iostream>
+#include <mutex>
 #include <string>
 #include <curl/curl.h>
+#include "../util/profiler.h"
 using namespace std;
 
 static size_t WriteCallback(void* contents, size_t size, size_t nmemb, void* userp) {
@@ -9,6 +11,7 @@ static size_t WriteCallback(void* contents, size_t size, size_t nmemb, void* use
 }
 
 std::string fetchStockData(const std::string& symbol) {
+    PROFILE_SCOPE("fetchStockData");
     CURL* curl;
     CURLcode res;
     std::string readBuffer;
@@ -20,7 +23,9 @@ std::string fetchStockData(const std::string& symbol) {
                       "&timezone=exchange"
                       "&format=JSON";
 
-    curl_global_init(CURL_GLOBAL_DEFAULT);
+    // Global init isn't thread-safe, and fetches run on more than one thread; done once and never cleaned up
+    static std::once_flag curl_ready;
+    std::call_once(curl_ready, [] { curl_global_init(CURL_GLOBAL_DEFAULT); });
     curl = curl_easy_init();
 
     if (curl) {
@@ -28,7 +33,10 @@ std::string fetchStockData(const std::string& symbol) {
         curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
         curl_easy_setopt(curl, CURLOPT_WRITEDATA, &readBuffer);
 
-        res = curl_easy_perform(curl);
+        {
+            PROFILE_SCOPE("curl_easy_perform");
+            res = curl_easy_perform(curl);
+        }
 
         if (res != CURLE_OK) {
             std::cerr << "curl_easy_perform() failed: " << curl_easy_strerror(res) << std::endl;
@@ -47,6 +55,5 @@ std::string fetchStockData(const std::string& symbol) {
         std::cerr << "Failed to initialize CURL" << std::endl;
     }
 
-    curl_global_cleanup();
     return readBuffer;
 }
\ No newline at end of file
@@ -3,6 +3,7 @@
 
 #include <string>
 
+// Blocking; safe to call from several threads at once
 std::string fetchStockData(const std::string& symbol);
 
 #endif // API_H
\ No newline at end of file
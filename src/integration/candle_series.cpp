@@ -0,0 +1,149 @@
+#include "candle_series.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <sstream>
+
+void CandleSeries::reserve(size_t n) {
+    time.reserve(n);
+    open.reserve(n);
+    high.reserve(n);
+    low.reserve(n);
+    close.reserve(n);
+    volume.reserve(n);
+}
+
+void CandleSeries::push_back(double t, double o, double h, double l, double c, double v) {
+    time.push_back(t);
+    open.push_back(o);
+    high.push_back(h);
+    low.push_back(l);
+    close.push_back(c);
+    volume.push_back(v);
+}
+
+CandleView CandleSeries::view() const {
+    CandleView v;
+    v.time = time.data();
+    v.open = open.data();
+    v.high = high.data();
+    v.low = low.data();
+    v.close = close.data();
+    v.volume = volume.data();
+    v.count = size();
+    return v;
+}
+
+static const char kCandleMagic[8] = {'T', 'S', 'C', 'A', 'N', 'D', 'L', 'E'};
+static const uint32_t kCandleVersion = 1;
+
+bool saveCandlesBinary(const std::string& path, const CandleSeries& series) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) return false;
+    CandleFileHeader header{};
+    std::memcpy(header.magic, kCandleMagic, sizeof(kCandleMagic));
+    header.version = kCandleVersion;
+    header.count = series.size();
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    for (const std::vector<double>* column : {&series.time, &series.open, &series.high, &series.low,
+                                              &series.close, &series.volume}) {
+        out.write(reinterpret_cast<const char*>(column->data()), static_cast<std::streamsize>(series.size() * sizeof(double)));
+    }
+    return static_cast<bool>(out);
+}
+
+bool MappedCandles::open(const std::string& path) {
+    view_ = CandleView();
+    if (!file_.open(path)) return false;
+    if (file_.size() < sizeof(CandleFileHeader)) return false;
+
+    const auto* header = static_cast<const CandleFileHeader*>(file_.data());
+    if (std::memcmp(header->magic, kCandleMagic, sizeof(kCandleMagic)) != 0 || header->version != kCandleVersion) return false;
+    // Divided rather than multiplied, so a corrupt count can't wrap around and pass
+    if (header->count > (file_.size() - sizeof(CandleFileHeader)) / (6 * sizeof(double))) return false;
+    size_t count = static_cast<size_t>(header->count);
+
+    const double* columns = reinterpret_cast<const double*>(header + 1);
+    view_.time = columns;
+    view_.open = columns + count;
+    view_.high = columns + 2 * count;
+    view_.low = columns + 3 * count;
+    view_.close = columns + 4 * count;
+    view_.volume = columns + 5 * count;
+    view_.count = count;
+    return true;
+}
+
+bool loadCandles(const std::string& path, CandleSeries& out) {
+    MappedCandles mapped;
+    if (!mapped.open(path)) return loadCandlesCsv(path, out);
+    CandleView v = mapped.view();
+    out.time.assign(v.time, v.time + v.count);
+    out.open.assign(v.open, v.open + v.count);
+    out.high.assign(v.high, v.high + v.count);
+    out.low.assign(v.low, v.low + v.count);
+    out.close.assign(v.close, v.close + v.count);
+    out.volume.assign(v.volume, v.volume + v.count);
+    return true;
+}
+
+// Days since 1970-01-01 for a proleptic Gregorian date (H. Hinnant's algorithm)
+static long daysFromCivil(long y, unsigned m, unsigned d) {
+    y -= m <= 2;
+    long era = (y >= 0 ? y : y - 399) / 400;
+    unsigned yoe = static_cast<unsigned>(y - era * 400);
+    unsigned doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + static_cast<long>(doe) - 719468;
+}
+
+double parseDateTime(const std::string& text) {
+    int year = 0, month = 0, day = 0, hour = 0, minute = 0, second = 0;
+    int fields = std::sscanf(text.c_str(), "%d-%d-%d %d:%d:%d", &year, &month, &day, &hour, &minute, &second);
+    if (fields < 3) return std::strtod(text.c_str(), nullptr);
+    return static_cast<double>(daysFromCivil(year, static_cast<unsigned>(month), static_cast<unsigned>(day))) * 86400.0 +
+           hour * 3600.0 + minute * 60.0 + second;
+}
+
+bool loadCandlesCsv(const std::string& path, CandleSeries& out) {
+    std::ifstream file(path);
+    if (!file) return false;
+
+    std::string line;
+    std::string cells[6];
+    while (std::getline(file, line)) {
+        if (line.empty()) continue;
+        std::stringstream row(line);
+        int count = 0;
+        while (count < 6 && std::getline(row, cells[count], ',')) ++count;
+        if (count < 5) continue;
+        char* end = nullptr;
+        double open = std::strtod(cells[1].c_str(), &end);
+        if (end == cells[1].c_str()) continue; // header or garbage
+        out.push_back(parseDateTime(cells[0]), open, std::strtod(cells[2].c_str(), nullptr),
+                      std::strtod(cells[3].c_str(), nullptr), std::strtod(cells[4].c_str(), nullptr),
+                      count > 5 ? std::strtod(cells[5].c_str(), nullptr) : 0.0);
+    }
+    return true;
+}
+
+CandleSeries syntheticCandles(size_t count, double start_price, unsigned seed) {
+    CandleSeries series;
+    series.reserve(count);
+    std::mt19937_64 rng(seed);
+    std::normal_distribution<double> step(0.0, 0.001);
+    std::uniform_real_distribution<double> wick(0.0, 0.0005);
+    double price = start_price;
+    for (size_t i = 0; i < count; ++i) {
+        double open = price;
+        price *= std::exp(step(rng));
+        double high = std::max(open, price) * (1.0 + wick(rng));
+        double low = std::min(open, price) * (1.0 - wick(rng));
+        series.push_back(static_cast<double>(i) * 60.0, open, high, low, price, 1000.0);
+    }
+    return series;
+}
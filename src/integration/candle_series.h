@@ -0,0 +1,74 @@
+#ifndef CANDLE_SERIES_H
+#define CANDLE_SERIES_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "../util/mapped_file.h"
+
+// Non-owning columns; what backtests actually iterate over, whether the data lives in a
+// CandleSeries or in a memory-mapped file shared by many runs
+struct CandleView {
+    const double* time = nullptr;
+    const double* open = nullptr;
+    const double* high = nullptr;
+    const double* low = nullptr;
+    const double* close = nullptr;
+    const double* volume = nullptr;
+    size_t count = 0;
+
+    size_t size() const { return count; }
+};
+
+// Column-per-field candle storage. Backtests and indicators walk one field at a time,
+// so keeping fields contiguous is what lets those loops run at memory speed.
+struct CandleSeries {
+    std::vector<double> time; // seconds since epoch (UTC)
+    std::vector<double> open;
+    std::vector<double> high;
+    std::vector<double> low;
+    std::vector<double> close;
+    std::vector<double> volume;
+
+    size_t size() const { return close.size(); }
+    bool empty() const { return close.empty(); }
+    void reserve(size_t n);
+    void push_back(double t, double o, double h, double l, double c, double v);
+    CandleView view() const;
+};
+
+// Binary candle file: header followed by each column as `count` raw doubles
+struct CandleFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+    uint64_t count;
+};
+
+bool saveCandlesBinary(const std::string& path, const CandleSeries& series);
+
+// Read-only mapping of a binary candle file; views into it stay valid while this lives
+class MappedCandles {
+public:
+    bool open(const std::string& path);
+    CandleView view() const { return view_; }
+
+private:
+    MappedFile file_;
+    CandleView view_;
+};
+
+// Loads either format: binary files are copied out of the mapping, anything else is CSV
+bool loadCandles(const std::string& path, CandleSeries& out);
+
+// Reads "datetime,open,high,low,close[,volume]" rows. datetime is either epoch seconds or
+// "YYYY-MM-DD[ HH:MM:SS]". A header row is skipped. Returns false if the file can't be opened.
+bool loadCandlesCsv(const std::string& path, CandleSeries& out);
+
+// Random walk for benchmarks and demos
+CandleSeries syntheticCandles(size_t count, double start_price = 100.0, unsigned seed = 42);
+
+double parseDateTime(const std::string& text);
+
+#endif // CANDLE_SERIES_H
@@ -0,0 +1,53 @@
+#include "watchlist.h"
+#include <algorithm>
+#include <cmath>
+
+size_t Watchlist::add(const std::string& symbol) {
+    auto it = index_.find(symbol);
+    if (it != index_.end()) return it->second;
+    size_t index = rows_.size();
+    rows_.emplace_back();
+    rows_.back().symbol = symbol;
+    rows_.back().spark.reserve(2 * kSparkPoints);
+    index_.emplace(symbol, index);
+    return index;
+}
+
+size_t Watchlist::find(const std::string& symbol) const {
+    auto it = index_.find(symbol);
+    return it == index_.end() ? npos : it->second;
+}
+
+void Watchlist::onCandle(size_t index, double time, double close, double volume) {
+    if (index >= rows_.size()) return;
+    Row& row = rows_[index];
+    if (time <= row.last_time) return;
+    row.last_time = time;
+
+    long day = static_cast<long>(std::floor(time / 86400.0));
+    if (day != row.day) {
+        // New session: yesterday's last close is the reference, or this first close if there is none
+        row.reference = row.day < 0 ? close : row.last;
+        row.volume = 0.0;
+        row.day = day;
+    }
+    row.last = close;
+    row.volume += volume;
+    row.change_pct = row.reference > 0.0 ? (close / row.reference - 1.0) * 100.0 : 0.0;
+
+    if (row.bucket_fill == 0) {
+        if (row.spark.size() == 2 * kSparkPoints) {
+            // Merge pairs: each surviving point is the later close of the pair
+            for (size_t i = 0; i < kSparkPoints; ++i) row.spark[i] = row.spark[2 * i + 1];
+            row.spark.resize(kSparkPoints);
+            row.bucket *= 2;
+        }
+        row.spark.push_back(static_cast<float>(close));
+    } else {
+        row.spark.back() = static_cast<float>(close);
+    }
+    if (++row.bucket_fill == row.bucket) row.bucket_fill = 0;
+    auto range = std::minmax_element(row.spark.begin(), row.spark.end());
+    row.spark_min = *range.first;
+    row.spark_max = *range.second;
+}
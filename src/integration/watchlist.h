@@ -0,0 +1,46 @@
+#ifndef WATCHLIST_H
+#define WATCHLIST_H
+
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Latest quote and a small price history per symbol for the dashboard. Memory per row is
+// bounded however long the history: the sparkline keeps at most 2 * kSparkPoints closes
+// and halves its resolution whenever it fills up.
+class Watchlist {
+public:
+    static constexpr size_t kSparkPoints = 48;
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    struct Row {
+        std::string symbol;
+        double last = 0.0;
+        double change_pct = 0.0; // against the previous session's close, or this session's first close
+        double volume = 0.0;     // this session so far
+        double last_time = -1.0; // candles at or before this are ignored, so refetches don't double count
+        long day = -1;
+        double reference = 0.0;
+        std::vector<float> spark; // last close of each bucket of `bucket` candles, oldest first
+        size_t bucket = 1;
+        size_t bucket_fill = 0;
+        float spark_min = 0.0f;
+        float spark_max = 0.0f;
+    };
+
+    // Index of the symbol's row, adding it if needed
+    size_t add(const std::string& symbol);
+    size_t find(const std::string& symbol) const;
+    // time is epoch seconds; sessions are split on UTC day boundaries of that time
+    void onCandle(size_t row, double time, double close, double volume);
+
+    size_t size() const { return rows_.size(); }
+    const Row& row(size_t index) const { return rows_[index]; }
+
+private:
+    std::vector<Row> rows_;
+    std::unordered_map<std::string, size_t> index_;
+};
+
+#endif // WATCHLIST_H
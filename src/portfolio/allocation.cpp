@@ -0,0 +1,240 @@
+#include "allocation.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <numeric>
+
+const char* allocationMethodName(AllocationMethod method) {
+    switch (method) {
+        case AllocationMethod::MeanVariance: return "Mean-variance";
+        case AllocationMethod::RiskParity: return "Risk parity";
+    }
+    return "";
+}
+
+AllocationProblem allocationProblem(const CovarianceEngine& covariance) {
+    AllocationProblem problem;
+    problem.assets = covariance.assets();
+    covariance.covariance(problem.covariance);
+    covariance.mean(problem.expected);
+    return problem;
+}
+
+// y = Σx over a dense row-major matrix; each row is a contiguous dot product
+static void multiply(const std::vector<double>& matrix, size_t n, const double* x, double* y) {
+    for (size_t i = 0; i < n; ++i) {
+        const double* __restrict row = matrix.data() + i * n;
+        double acc = 0.0;
+        for (size_t j = 0; j < n; ++j) acc += row[j] * x[j];
+        y[i] = acc;
+    }
+}
+
+// Euclidean projection onto {Σw = 1, lo <= w <= hi}: find the shift τ with
+// Σ clamp(v - τ) = 1 by bisection, which is O(n) per step and needs no sort
+static void projectCappedSimplex(const std::vector<double>& v, double lo, double hi, std::vector<double>& out) {
+    const size_t n = v.size();
+    auto total = [&](double tau) {
+        double sum = 0.0;
+        for (size_t i = 0; i < n; ++i) sum += std::min(hi, std::max(lo, v[i] - tau));
+        return sum;
+    };
+    double low = *std::min_element(v.begin(), v.end()) - hi;
+    double high = *std::max_element(v.begin(), v.end()) - lo;
+    for (int step = 0; step < 100 && high - low > 1e-15; ++step) {
+        double mid = 0.5 * (low + high);
+        if (total(mid) > 1.0) {
+            low = mid;
+        } else {
+            high = mid;
+        }
+    }
+    double tau = 0.5 * (low + high);
+    out.resize(n);
+    for (size_t i = 0; i < n; ++i) out[i] = std::min(hi, std::max(lo, v[i] - tau));
+}
+
+// Largest eigenvalue by power iteration, for the gradient step size
+static double largestEigenvalue(const std::vector<double>& matrix, size_t n) {
+    std::vector<double> x(n, 1.0 / std::sqrt(static_cast<double>(n))), y(n);
+    double lambda = 0.0;
+    for (int step = 0; step < 50; ++step) {
+        multiply(matrix, n, x.data(), y.data());
+        double norm = 0.0;
+        for (double v : y) norm += v * v;
+        norm = std::sqrt(norm);
+        if (norm == 0.0) return 0.0;
+        for (size_t i = 0; i < n; ++i) x[i] = y[i] / norm;
+        if (std::fabs(norm - lambda) <= 1e-6 * norm) return norm;
+        lambda = norm;
+    }
+    return lambda;
+}
+
+static void solveMeanVariance(const AllocationProblem& problem, const AllocationSettings& settings,
+                              double lo, double hi, AllocationResult& result) {
+    const size_t n = problem.assets;
+    std::vector<double>& w = result.weights;
+    w.assign(n, 1.0 / static_cast<double>(n));
+    projectCappedSimplex(std::vector<double>(w), lo, hi, w);
+
+    double lipschitz = settings.risk_aversion * largestEigenvalue(problem.covariance, n);
+    if (lipschitz <= 0.0) {
+        // No risk term: maximizing μ·w over the capped simplex is a linear program, solved by
+        // starting every weight at lo and filling the best expected returns up to hi in turn
+        std::vector<size_t> order(n);
+        std::iota(order.begin(), order.end(), size_t(0));
+        std::stable_sort(order.begin(), order.end(),
+                         [&](size_t a, size_t b) { return problem.expected[a] > problem.expected[b]; });
+        w.assign(n, lo);
+        double remaining = 1.0 - lo * static_cast<double>(n);
+        for (size_t i : order) {
+            double add = std::min(hi - lo, std::max(remaining, 0.0));
+            w[i] += add;
+            remaining -= add;
+        }
+        result.converged = true;
+        return;
+    }
+    const double step = 1.0 / lipschitz;
+
+    // FISTA: gradient step on the smooth objective at the extrapolated point, then project
+    std::vector<double> y = w, next(n), sigma_y(n), target(n);
+    double t = 1.0;
+    for (int k = 0; k < settings.max_iterations; ++k) {
+        multiply(problem.covariance, n, y.data(), sigma_y.data());
+        for (size_t i = 0; i < n; ++i) {
+            target[i] = y[i] + step * (problem.expected[i] - settings.risk_aversion * sigma_y[i]);
+        }
+        projectCappedSimplex(target, lo, hi, next);
+
+        double moved = 0.0;
+        double alignment = 0.0;
+        for (size_t i = 0; i < n; ++i) {
+            moved = std::max(moved, std::fabs(next[i] - w[i]));
+            alignment += (y[i] - next[i]) * (next[i] - w[i]);
+        }
+        if (alignment > 0.0) {
+            // Momentum is pointing uphill: restart it (adaptive restart, which keeps the
+            // ill-conditioned covariance of many correlated assets from stalling progress)
+            t = 1.0;
+            y = next;
+        } else {
+            double t_next = 0.5 * (1.0 + std::sqrt(1.0 + 4.0 * t * t));
+            double momentum = (t - 1.0) / t_next;
+            for (size_t i = 0; i < n; ++i) y[i] = next[i] + momentum * (next[i] - w[i]);
+            t = t_next;
+        }
+        w.swap(next);
+        result.iterations = k + 1;
+        if (moved <= settings.tolerance) {
+            result.converged = true;
+            break;
+        }
+    }
+}
+
+// Equal risk contribution: minimise ½wᵀΣw - Σ b_i·log(w_i) one coordinate at a time. Each
+// coordinate has a closed-form root, and Σw is patched in O(n) after every change.
+static void solveRiskParity(const AllocationProblem& problem, const AllocationSettings& settings,
+                            AllocationResult& result) {
+    const size_t n = problem.assets;
+    const std::vector<double>& cov = problem.covariance;
+    std::vector<size_t> active;
+    for (size_t i = 0; i < n; ++i) {
+        if (cov[i * n + i] > 0.0) active.push_back(i);
+    }
+    std::vector<double>& w = result.weights;
+    w.assign(n, 0.0);
+    if (active.empty()) {
+        result.converged = true;
+        return;
+    }
+    const double budget = 1.0 / static_cast<double>(active.size());
+    for (size_t i : active) w[i] = budget / std::sqrt(cov[i * n + i]);
+    std::vector<double> sigma_w(n);
+    multiply(cov, n, w.data(), sigma_w.data());
+
+    for (int sweep = 0; sweep < settings.max_iterations; ++sweep) {
+        double moved = 0.0;
+        double total = 0.0;
+        for (size_t i : active) {
+            double var = cov[i * n + i];
+            double others = sigma_w[i] - var * w[i];
+            double updated = (-others + std::sqrt(others * others + 4.0 * var * budget)) / (2.0 * var);
+            double delta = updated - w[i];
+            if (delta != 0.0) {
+                const double* __restrict column = cov.data() + i * n; // symmetric, so row i is column i
+                double* __restrict sw = sigma_w.data();
+                for (size_t j = 0; j < n; ++j) sw[j] += column[j] * delta;
+                w[i] = updated;
+            }
+            moved = std::max(moved, std::fabs(delta));
+            total += updated;
+        }
+        result.iterations = sweep + 1;
+        if (moved <= settings.tolerance * total) {
+            result.converged = true;
+            break;
+        }
+    }
+    double total = 0.0;
+    for (double v : w) total += v;
+    for (double& v : w) v /= total;
+}
+
+AllocationResult optimizeAllocation(const AllocationProblem& problem, const AllocationSettings& settings) {
+    auto start = std::chrono::steady_clock::now();
+    AllocationResult result;
+    const size_t n = problem.assets;
+    if (n == 0 || problem.covariance.size() < n * n || problem.expected.size() < n) return result;
+
+    // Keep the box feasible: caps can't stop the weights from summing to one
+    double lo = std::max(0.0, settings.min_weight);
+    double hi = std::max(settings.max_weight, 1.0 / static_cast<double>(n));
+    lo = std::min(lo, 1.0 / static_cast<double>(n));
+
+    if (settings.method == AllocationMethod::RiskParity) {
+        solveRiskParity(problem, settings, result);
+    } else {
+        solveMeanVariance(problem, settings, lo, hi, result);
+    }
+
+    std::vector<double> sigma_w(n);
+    multiply(problem.covariance, n, result.weights.data(), sigma_w.data());
+    double variance = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        result.expected_return += result.weights[i] * problem.expected[i];
+        variance += result.weights[i] * sigma_w[i];
+    }
+    result.volatility = std::sqrt(std::max(0.0, variance));
+    result.elapsed_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+std::vector<RebalanceTrade> rebalanceTrades(const Portfolio& portfolio, const std::vector<double>& target_weights,
+                                            const std::vector<double>& prices) {
+    std::vector<RebalanceTrade> trades;
+    const double equity = portfolio.equity();
+    if (equity <= 0.0) return trades;
+    for (size_t i = 0; i < target_weights.size() && i < prices.size(); ++i) {
+        double price = prices[i];
+        if (price <= 0.0) continue;
+        SymbolId symbol = static_cast<SymbolId>(i);
+        int64_t held = portfolio.quantity(symbol);
+        // Round towards zero so the buys never need more cash than the target implies
+        int64_t target = static_cast<int64_t>(std::floor(target_weights[i] * equity / price));
+        if (target == held) continue;
+        RebalanceTrade trade;
+        trade.symbol = symbol;
+        trade.side = target > held ? Side::Buy : Side::Sell;
+        trade.quantity = std::llabs(target - held);
+        trade.price = price;
+        trade.current_weight = static_cast<double>(held) * price / equity;
+        trade.target_weight = target_weights[i];
+        trades.push_back(trade);
+    }
+    // Sells first, so their proceeds fund the buys
+    std::stable_partition(trades.begin(), trades.end(), [](const RebalanceTrade& t) { return t.side == Side::Sell; });
+    return trades;
+}
@@ -0,0 +1,62 @@
+#ifndef ALLOCATION_H
+#define ALLOCATION_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "../engine/order.h"
+#include "covariance.h"
+#include "portfolio.h"
+
+enum class AllocationMethod : uint8_t { MeanVariance, RiskParity };
+
+const char* allocationMethodName(AllocationMethod method);
+
+struct AllocationSettings {
+    AllocationMethod method = AllocationMethod::MeanVariance;
+    double risk_aversion = 5.0; // mean-variance: λ in μᵀw - λ/2·wᵀΣw
+    double min_weight = 0.0;    // long-only floor per asset
+    double max_weight = 1.0;    // concentration cap per asset
+    int max_iterations = 2000;
+    double tolerance = 1e-9;    // stop once no weight moves by more than this
+};
+
+// Snapshot of what the optimizer needs, so it can run on another thread while the
+// covariance engine keeps updating
+struct AllocationProblem {
+    size_t assets = 0;
+    std::vector<double> covariance; // assets × assets, row-major
+    std::vector<double> expected;   // per-bar expected return
+};
+
+AllocationProblem allocationProblem(const CovarianceEngine& covariance);
+
+struct AllocationResult {
+    std::vector<double> weights; // fully invested, sums to 1
+    double expected_return = 0.0; // per bar
+    double volatility = 0.0;      // per bar
+    int iterations = 0;
+    bool converged = false;
+    double elapsed_seconds = 0.0;
+};
+
+// Mean-variance is solved with accelerated projected gradient onto the capped simplex
+// (O(n²) per iteration); risk parity with cyclical coordinate descent on the log-barrier
+// formulation (O(n²) per sweep). Assets without variance get no weight under risk parity.
+AllocationResult optimizeAllocation(const AllocationProblem& problem, const AllocationSettings& settings);
+
+struct RebalanceTrade {
+    SymbolId symbol = 0;
+    Side side = Side::Buy;
+    int64_t quantity = 0;
+    double price = 0.0;
+    double current_weight = 0.0;
+    double target_weight = 0.0;
+};
+
+// Whole-share orders that move the portfolio to the target weights at the given prices
+// (indexed by symbol id). Assets without a price are skipped.
+std::vector<RebalanceTrade> rebalanceTrades(const Portfolio& portfolio, const std::vector<double>& target_weights,
+                                            const std::vector<double>& prices);
+
+#endif // ALLOCATION_H
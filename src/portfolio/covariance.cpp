@@ -0,0 +1,169 @@
+#include "covariance.h"
+#include <algorithm>
+#include <cmath>
+
+// Columns per tile. Both vectors' slices for a tile (2 × 2 KB) stay in L1 while every row
+// of the triangle streams through it.
+static constexpr size_t kTile = 256;
+
+CovarianceEngine::CovarianceEngine(size_t assets, size_t window, WorkStealingPool* pool)
+    : assets_(0), window_(window == 0 ? 1 : window), pool_(pool) {
+    resize(assets);
+}
+
+void CovarianceEngine::resize(size_t assets) {
+    if (assets <= assets_ && stride_ != 0) return;
+    size_t stride = (assets + 3) & ~size_t(3);
+
+    std::vector<double> rows(window_ * assets, 0.0);
+    for (size_t r = 0; r < window_; ++r) {
+        std::copy_n(rows_.data() + r * assets_, assets_, rows.data() + r * assets);
+    }
+    std::vector<double> cross(stride * stride, 0.0);
+    for (size_t i = 0; i < assets_; ++i) {
+        std::copy_n(cross_.data() + i * stride_, assets_, cross.data() + i * stride);
+    }
+    rows_.swap(rows);
+    cross_.swap(cross);
+    sum_.resize(assets, 0.0);
+    zero_.assign(assets, 0.0);
+    assets_ = assets;
+    stride_ = stride;
+}
+
+// cross[i][j] += add_i·add_j - remove_i·remove_j for j >= i, tiled by columns
+void CovarianceEngine::rank2(const double* add, const double* remove) {
+    const size_t n = assets_;
+    const size_t tiles = (n + kTile - 1) / kTile;
+    double* cross = cross_.data();
+
+    auto runTile = [&](size_t t) {
+        size_t col_begin = t * kTile;
+        size_t col_end = std::min(col_begin + kTile, n);
+        const double* __restrict a = add;
+        const double* __restrict r = remove;
+        for (size_t i = 0; i < col_end; ++i) {
+            double ai = a[i];
+            double ri = r[i];
+            if (ai == 0.0 && ri == 0.0) continue;
+            size_t j = std::max(i, col_begin);
+            double* __restrict row = cross + i * stride_;
+            for (; j < col_end; ++j) row[j] += ai * a[j] - ri * r[j];
+        }
+    };
+
+    // Tiles own disjoint columns, so they can run concurrently without locks
+    if (pool_ && tiles > 1) {
+        pool_->parallelFor(tiles, runTile);
+    } else {
+        for (size_t t = 0; t < tiles; ++t) runTile(t);
+    }
+}
+
+void CovarianceEngine::append(const double* row) {
+    if (assets_ == 0) return;
+    double* slot = rows_.data() + head_ * assets_;
+    const bool full = filled_ == window_;
+    if (full) {
+        for (size_t i = 0; i < assets_; ++i) sum_[i] += row[i] - slot[i];
+        rank2(row, slot);
+    } else {
+        for (size_t i = 0; i < assets_; ++i) sum_[i] += row[i];
+        rank2(row, zero_.data());
+    }
+    std::copy_n(row, assets_, slot);
+    head_ = (head_ + 1) % window_;
+    filled_ = std::min(filled_ + 1, window_);
+
+    // Add/remove pairs drift apart slowly in floating point; a rebuild per window keeps the
+    // cost amortised at one extra rank-1 update per bar
+    if (full && ++since_rebuild_ >= window_) rebuild();
+}
+
+void CovarianceEngine::rebuild() {
+    since_rebuild_ = 0;
+    std::fill(sum_.begin(), sum_.end(), 0.0);
+    std::fill(cross_.begin(), cross_.end(), 0.0);
+    for (size_t r = 0; r < filled_; ++r) {
+        const double* row = rows_.data() + r * assets_;
+        for (size_t i = 0; i < assets_; ++i) sum_[i] += row[i];
+        rank2(row, zero_.data());
+    }
+}
+
+void CovarianceEngine::mean(std::vector<double>& out) const {
+    out.assign(assets_, 0.0);
+    if (filled_ == 0) return;
+    double inv = 1.0 / static_cast<double>(filled_);
+    for (size_t i = 0; i < assets_; ++i) out[i] = sum_[i] * inv;
+}
+
+void CovarianceEngine::covariance(std::vector<double>& out) const {
+    const size_t n = assets_;
+    out.assign(n * n, 0.0);
+    if (filled_ < 2) return;
+    const double m = static_cast<double>(filled_);
+    const double inv = 1.0 / (m - 1.0);
+    for (size_t i = 0; i < n; ++i) {
+        const double* __restrict row = cross_.data() + i * stride_;
+        const double* __restrict s = sum_.data();
+        double* __restrict dst = out.data() + i * n;
+        double si = sum_[i] / m;
+        for (size_t j = i; j < n; ++j) dst[j] = (row[j] - si * s[j]) * inv;
+    }
+    // Mirror the upper triangle, a tile at a time so both sides stay in cache
+    for (size_t ib = 0; ib < n; ib += 64) {
+        for (size_t jb = ib; jb < n; jb += 64) {
+            for (size_t i = ib; i < std::min(ib + 64, n); ++i) {
+                for (size_t j = std::max(jb, i + 1); j < std::min(jb + 64, n); ++j) out[j * n + i] = out[i * n + j];
+            }
+        }
+    }
+}
+
+void CovarianceEngine::correlation(std::vector<double>& out) const {
+    covariance(out);
+    const size_t n = assets_;
+    std::vector<double> inv_sd(n);
+    for (size_t i = 0; i < n; ++i) {
+        double var = out[i * n + i];
+        inv_sd[i] = var > 0.0 ? 1.0 / std::sqrt(var) : 0.0;
+    }
+    for (size_t i = 0; i < n; ++i) {
+        double* __restrict row = out.data() + i * n;
+        for (size_t j = 0; j < n; ++j) row[j] *= inv_sd[i] * inv_sd[j];
+        if (inv_sd[i] > 0.0) row[i] = 1.0;
+    }
+}
+
+void CovarianceEngine::multiply(const std::vector<double>& weights, std::vector<double>& out) const {
+    const size_t n = std::min(assets_, weights.size());
+    out.assign(weights.size(), 0.0);
+    if (filled_ < 2) return;
+    const double m = static_cast<double>(filled_);
+    // Σw = (Cw - s·(sᵀw)/m) / (m-1), with C read once through its upper triangle
+    double* __restrict y = out.data();
+    const double* __restrict w = weights.data();
+    for (size_t i = 0; i < n; ++i) {
+        const double* __restrict row = cross_.data() + i * stride_;
+        double wi = w[i];
+        double acc = row[i] * wi;
+        for (size_t j = i + 1; j < n; ++j) {
+            acc += row[j] * w[j];
+            y[j] += row[j] * wi;
+        }
+        y[i] += acc;
+    }
+    double sw = 0.0;
+    for (size_t i = 0; i < n; ++i) sw += sum_[i] * w[i];
+    const double inv = 1.0 / (m - 1.0);
+    for (size_t i = 0; i < n; ++i) y[i] = (y[i] - sum_[i] * sw / m) * inv;
+}
+
+double CovarianceEngine::portfolioVariance(const std::vector<double>& weights) const {
+    std::vector<double> sigma_w;
+    multiply(weights, sigma_w);
+    double variance = 0.0;
+    for (size_t i = 0; i < sigma_w.size(); ++i) variance += weights[i] * sigma_w[i];
+    return std::max(0.0, variance);
+}
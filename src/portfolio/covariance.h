@@ -0,0 +1,51 @@
+#ifndef COVARIANCE_H
+#define COVARIANCE_H
+
+#include <cstddef>
+#include <vector>
+#include "../util/thread_pool.h"
+
+// Rolling-window covariance of per-bar returns across assets. Keeps running sums of x and
+// of x·xᵀ (upper triangle), so a new bar costs one rank-2 update (add the new row, remove
+// the one leaving the window) instead of a pass over the whole window.
+class CovarianceEngine {
+public:
+    explicit CovarianceEngine(size_t assets = 0, size_t window = 500, WorkStealingPool* pool = nullptr);
+
+    void resize(size_t assets);      // new assets start with zero returns
+    void append(const double* row);  // one return per asset
+    void append(const std::vector<double>& row) { append(row.data()); }
+
+    size_t assets() const { return assets_; }
+    size_t window() const { return window_; }
+    size_t observations() const { return filled_; }
+
+    // Full symmetric n×n matrices, row-major. Sample (n-1) normalisation.
+    void covariance(std::vector<double>& out) const;
+    void correlation(std::vector<double>& out) const;
+    void mean(std::vector<double>& out) const;
+    // Σw and wᵀΣw straight from the running sums, without materialising Σ
+    void multiply(const std::vector<double>& weights, std::vector<double>& out) const;
+    double portfolioVariance(const std::vector<double>& weights) const;
+
+    // Recomputes the sums from the stored window to shed accumulated rounding error.
+    // append() does this on its own once per full window.
+    void rebuild();
+
+private:
+    void rank2(const double* add, const double* remove);
+
+    size_t assets_;
+    size_t window_;
+    size_t stride_ = 0; // row length of cross_, padded to a multiple of 4 doubles
+    size_t head_ = 0;
+    size_t filled_ = 0;
+    size_t since_rebuild_ = 0;
+    WorkStealingPool* pool_;
+    std::vector<double> rows_;  // window × assets ring of raw returns
+    std::vector<double> sum_;   // Σx per asset
+    std::vector<double> cross_; // Σx_i·x_j, only j >= i is maintained
+    std::vector<double> zero_;  // stands in for the leaving row while the window fills
+};
+
+#endif // COVARIANCE_H
@@ -0,0 +1,256 @@
+#include "leaderboard.h"
+#include <algorithm>
+
+void Leaderboard::reserve(size_t accounts) {
+    nodes_.reserve(accounts + 1);
+    node_of_account_.reserve(accounts);
+}
+
+void Leaderboard::split(uint32_t tree, double score, AccountId account, uint32_t& less, uint32_t& rest) {
+    if (tree == 0) {
+        less = rest = 0;
+        return;
+    }
+    Node& t = nodes_[tree];
+    if (before(t, score, account)) {
+        split(t.right, score, account, nodes_[tree].right, rest);
+        less = tree;
+    } else {
+        split(t.left, score, account, less, nodes_[tree].left);
+        rest = tree;
+    }
+    resize(tree);
+}
+
+uint32_t Leaderboard::merge(uint32_t a, uint32_t b) {
+    if (a == 0) return b;
+    if (b == 0) return a;
+    if (nodes_[a].priority > nodes_[b].priority) {
+        nodes_[a].right = merge(nodes_[a].right, b);
+        resize(a);
+        return a;
+    }
+    nodes_[b].left = merge(a, nodes_[b].left);
+    resize(b);
+    return b;
+}
+
+uint32_t Leaderboard::insert(uint32_t tree, uint32_t n) {
+    if (tree == 0) return n;
+    Node& inserted = nodes_[n];
+    if (inserted.priority > nodes_[tree].priority) {
+        split(tree, inserted.score, inserted.account, nodes_[n].left, nodes_[n].right);
+        resize(n);
+        return n;
+    }
+    if (before(nodes_[n], nodes_[tree].score, nodes_[tree].account)) {
+        uint32_t child = insert(nodes_[tree].left, n);
+        nodes_[tree].left = child;
+    } else {
+        uint32_t child = insert(nodes_[tree].right, n);
+        nodes_[tree].right = child;
+    }
+    resize(tree);
+    return tree;
+}
+
+uint32_t Leaderboard::erase(uint32_t tree, double score, AccountId account) {
+    if (tree == 0) return 0;
+    Node& t = nodes_[tree];
+    if (t.account == account && t.score == score) return merge(t.left, t.right);
+    if (before(t, score, account)) {
+        uint32_t child = erase(t.right, score, account);
+        nodes_[tree].right = child;
+    } else {
+        uint32_t child = erase(t.left, score, account);
+        nodes_[tree].left = child;
+    }
+    resize(tree);
+    return tree;
+}
+
+void Leaderboard::update(AccountId account, double score) {
+    uint32_t n = node(account);
+    if (n != 0) {
+        if (nodes_[n].score == score) return;
+        root_ = erase(root_, nodes_[n].score, account);
+    } else {
+        if (free_.empty()) {
+            n = static_cast<uint32_t>(nodes_.size());
+            nodes_.emplace_back();
+        } else {
+            n = free_.back();
+            free_.pop_back();
+        }
+        node_of_account_[account] = n;
+        // xorshift: cheap, and good enough to keep the expected depth logarithmic
+        seed_ ^= seed_ << 13;
+        seed_ ^= seed_ >> 17;
+        seed_ ^= seed_ << 5;
+        nodes_[n].priority = seed_;
+        nodes_[n].account = account;
+    }
+    Node& updated = nodes_[n];
+    updated.score = score;
+    updated.left = updated.right = 0;
+    updated.size = 1;
+    root_ = insert(root_, n);
+}
+
+bool Leaderboard::remove(AccountId account) {
+    uint32_t n = node(account);
+    if (n == 0) return false;
+    root_ = erase(root_, nodes_[n].score, account);
+    node_of_account_.erase(account);
+    free_.push_back(n);
+    return true;
+}
+
+void Leaderboard::clear() {
+    nodes_.resize(1);
+    free_.clear();
+    node_of_account_.clear();
+    root_ = 0;
+}
+
+size_t Leaderboard::rank(AccountId account) const {
+    uint32_t n = node(account);
+    if (n == 0) return npos;
+    const Node& target = nodes_[n];
+    size_t ahead = 0;
+    uint32_t tree = root_;
+    while (tree != 0 && tree != n) {
+        const Node& t = nodes_[tree];
+        if (before(t, target.score, target.account)) {
+            ahead += nodes_[t.left].size + 1;
+            tree = t.right;
+        } else {
+            tree = t.left;
+        }
+    }
+    return ahead + nodes_[nodes_[n].left].size;
+}
+
+Leaderboard::Entry Leaderboard::at(size_t rank) const {
+    uint32_t tree = root_;
+    while (tree != 0) {
+        const Node& t = nodes_[tree];
+        size_t left = nodes_[t.left].size;
+        if (rank < left) {
+            tree = t.left;
+        } else if (rank == left) {
+            return {t.account, t.score};
+        } else {
+            rank -= left + 1;
+            tree = t.right;
+        }
+    }
+    return {0, 0.0};
+}
+
+void Leaderboard::range(size_t first, size_t count, std::vector<Entry>& out) const {
+    out.clear();
+    if (first >= size()) return;
+    count = std::min(count, size() - first);
+    out.reserve(count);
+    // In-order walk with an explicit stack, starting from the first requested rank
+    std::vector<uint32_t> stack;
+    uint32_t tree = root_;
+    size_t skip = first;
+    while (tree != 0) {
+        const Node& t = nodes_[tree];
+        size_t left = nodes_[t.left].size;
+        if (skip < left) {
+            stack.push_back(tree);
+            tree = t.left;
+        } else if (skip == left) {
+            stack.push_back(tree);
+            break;
+        } else {
+            skip -= left + 1;
+            tree = t.right;
+        }
+    }
+    while (!stack.empty() && out.size() < count) {
+        uint32_t n = stack.back();
+        stack.pop_back();
+        out.push_back({nodes_[n].account, nodes_[n].score});
+        for (uint32_t child = nodes_[n].right; child != 0; child = nodes_[child].left) stack.push_back(child);
+    }
+}
+
+PortfolioRanking::Tracked* PortfolioRanking::find(AccountId account) {
+    auto found = slot_of_account_.find(account);
+    return found != slot_of_account_.end() ? &tracked_[found->second] : nullptr;
+}
+
+void PortfolioRanking::track(AccountId account, Portfolio* portfolio, double starting_equity) {
+    auto slot = slot_of_account_.emplace(account, static_cast<uint32_t>(tracked_.size()));
+    if (slot.second) tracked_.emplace_back();
+    Tracked& tracked = tracked_[slot.first->second];
+    tracked.account = account;
+    tracked.portfolio = portfolio;
+    tracked.starting_equity = starting_equity;
+    // held survives untrack(), so an account tracked again isn't listed twice
+    for (const Position& position : portfolio->positions()) {
+        if (position.quantity != 0) listHolder(slot.first->second, position.symbol);
+    }
+    board_.update(account, scoreOf(tracked));
+}
+
+void PortfolioRanking::untrack(AccountId account) {
+    Tracked* tracked = find(account);
+    if (!tracked) return;
+    tracked->portfolio = nullptr; // holders_ entries are dropped on the next mark
+    board_.remove(account);
+}
+
+void PortfolioRanking::listHolder(uint32_t slot, SymbolId symbol) {
+    Tracked& tracked = tracked_[slot];
+    if (std::find(tracked.held.begin(), tracked.held.end(), symbol) != tracked.held.end()) return;
+    tracked.held.push_back(symbol);
+    if (symbol >= holders_.size()) holders_.resize(static_cast<size_t>(symbol) + 1);
+    holders_[symbol].push_back(slot);
+}
+
+void PortfolioRanking::onFill(AccountId account, SymbolId symbol) {
+    auto slot = slot_of_account_.find(account);
+    if (slot == slot_of_account_.end() || !tracked_[slot->second].portfolio) return;
+    Tracked& tracked = tracked_[slot->second];
+    if (tracked.portfolio->quantity(symbol) != 0) listHolder(slot->second, symbol);
+    board_.update(account, scoreOf(tracked));
+}
+
+void PortfolioRanking::onPrice(SymbolId symbol, double price) {
+    if (symbol >= holders_.size()) return;
+    std::vector<uint32_t>& holders = holders_[symbol];
+    size_t kept = 0;
+    for (uint32_t slot : holders) {
+        Tracked& tracked = tracked_[slot];
+        bool holds = tracked.portfolio && tracked.portfolio->quantity(symbol) != 0;
+        if (!holds) {
+            // Closed out since the last mark: unlist it here so marks stay proportional to holders
+            tracked.held.erase(std::remove(tracked.held.begin(), tracked.held.end(), symbol), tracked.held.end());
+            continue;
+        }
+        holders[kept++] = slot;
+        tracked.portfolio->onPrice(symbol, price);
+        board_.update(tracked.account, scoreOf(tracked));
+    }
+    holders.resize(kept);
+}
+
+void PortfolioRanking::setMetric(LeaderboardMetric metric) {
+    if (metric == metric_) return;
+    metric_ = metric;
+    board_.clear();
+    for (const Tracked& tracked : tracked_) {
+        if (tracked.portfolio) board_.update(tracked.account, scoreOf(tracked));
+    }
+}
+
+double PortfolioRanking::scoreOf(const Tracked& tracked) const {
+    double equity = tracked.portfolio->equity();
+    if (metric_ == LeaderboardMetric::Equity) return equity;
+    return tracked.starting_equity > 0.0 ? equity / tracked.starting_equity - 1.0 : 0.0;
+}
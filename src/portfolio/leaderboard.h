@@ -0,0 +1,108 @@
+#ifndef LEADERBOARD_H
+#define LEADERBOARD_H
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "portfolio.h"
+
+// Accounts ordered by score, best first (ties go to the lower account id). Backed by a
+// treap whose nodes carry subtree sizes, so moving an account, looking up its rank and
+// selecting the n-th entry are all O(log n), and the top k is O(log n + k).
+class Leaderboard {
+public:
+    struct Entry {
+        AccountId account;
+        double score;
+    };
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    void reserve(size_t accounts);
+
+    // Inserts the account or moves it to its new score
+    void update(AccountId account, double score);
+    bool remove(AccountId account);
+    void clear();
+
+    bool contains(AccountId account) const { return node(account) != 0; }
+    size_t size() const { return nodes_[root_].size; }
+    double score(AccountId account) const { return nodes_[node(account)].score; }
+    // 0 is the leader; npos if the account isn't on the board
+    size_t rank(AccountId account) const;
+    Entry at(size_t rank) const;
+    // Up to count entries starting at rank first, in order
+    void range(size_t first, size_t count, std::vector<Entry>& out) const;
+    void top(size_t k, std::vector<Entry>& out) const { range(0, k, out); }
+
+private:
+    // Index 0 is the empty sentinel, so child links never need a null check on size
+    struct Node {
+        double score = 0.0;
+        AccountId account = 0;
+        uint32_t priority = 0;
+        uint32_t left = 0;
+        uint32_t right = 0;
+        uint32_t size = 0;
+    };
+
+    static bool before(const Node& a, double score, AccountId account) {
+        return a.score > score || (a.score == score && a.account < account);
+    }
+    uint32_t node(AccountId account) const {
+        auto found = node_of_account_.find(account);
+        return found != node_of_account_.end() ? found->second : 0;
+    }
+    void resize(uint32_t n) { nodes_[n].size = nodes_[nodes_[n].left].size + nodes_[nodes_[n].right].size + 1; }
+    void split(uint32_t tree, double score, AccountId account, uint32_t& less, uint32_t& rest);
+    uint32_t merge(uint32_t a, uint32_t b);
+    uint32_t insert(uint32_t tree, uint32_t n);
+    uint32_t erase(uint32_t tree, double score, AccountId account);
+
+    std::vector<Node> nodes_ = std::vector<Node>(1);
+    std::vector<uint32_t> free_;
+    std::unordered_map<AccountId, uint32_t> node_of_account_; // ids can be sparse, e.g. kLocalUserId
+    uint32_t root_ = 0;
+    uint32_t seed_ = 0x9e3779b9u;
+};
+
+enum class LeaderboardMetric : uint8_t { Equity, Return };
+
+// Keeps a Leaderboard in step with a set of portfolios the caller owns. A fill re-scores one
+// account and a new mark re-scores only the accounts holding that symbol, each in O(log n).
+class PortfolioRanking {
+public:
+    explicit PortfolioRanking(LeaderboardMetric metric = LeaderboardMetric::Equity) : metric_(metric) {}
+
+    // starting_equity is the base for LeaderboardMetric::Return
+    void track(AccountId account, Portfolio* portfolio, double starting_equity);
+    void untrack(AccountId account);
+    // Call after the fill has been applied to the account's portfolio
+    void onFill(AccountId account, SymbolId symbol);
+    // Marks every holder's position at price and re-scores them
+    void onPrice(SymbolId symbol, double price);
+
+    void setMetric(LeaderboardMetric metric);
+    LeaderboardMetric metric() const { return metric_; }
+    const Leaderboard& board() const { return board_; }
+
+private:
+    struct Tracked {
+        AccountId account = 0;
+        Portfolio* portfolio = nullptr;
+        double starting_equity = 0.0;
+        std::vector<SymbolId> held; // symbols this account is listed under in holders_
+    };
+
+    double scoreOf(const Tracked& tracked) const;
+    Tracked* find(AccountId account);
+    void listHolder(uint32_t slot, SymbolId symbol);
+
+    LeaderboardMetric metric_;
+    Leaderboard board_;
+    std::vector<Tracked> tracked_;                        // by slot, in order of first track()
+    std::unordered_map<AccountId, uint32_t> slot_of_account_;
+    std::vector<std::vector<uint32_t>> holders_;          // slots by symbol id; flat positions are pruned lazily
+};
+
+#endif // LEADERBOARD_H
@@ -1,3 +1,79 @@
 //
 // Created by Shazaib malik on 13/05/2025.
 //
+
+#include "portfolio.h"
+#include <algorithm>
+#include <cstdlib>
+
+Position& Portfolio::slot(SymbolId symbol) {
+    if (symbol >= slot_of_symbol_.size()) slot_of_symbol_.resize(symbol + 1, -1);
+    int32_t& index = slot_of_symbol_[symbol];
+    if (index < 0) {
+        index = static_cast<int32_t>(positions_.size());
+        positions_.emplace_back();
+        positions_.back().symbol = symbol;
+    }
+    return positions_[static_cast<size_t>(index)];
+}
+
+void Portfolio::applyFill(SymbolId symbol, Side side, int64_t quantity, double price, double fee,
+                          uint64_t time_ns) {
+    if (quantity <= 0) return;
+    Position& p = slot(symbol);
+    ++fill_count_;
+
+    // Take this position out of the totals, update it, then add it back
+    market_value_ -= p.marketValue();
+    cost_basis_ -= p.costBasis();
+
+    int64_t signed_qty = side == Side::Buy ? quantity : -quantity;
+    double notional = static_cast<double>(quantity) * price;
+    cash_ += side == Side::Buy ? -notional - fee : notional - fee;
+
+    bool adds = p.quantity == 0 || (p.quantity > 0) == (signed_qty > 0);
+    if (adds) {
+        int64_t total = p.quantity + signed_qty;
+        p.avg_cost = (p.costBasis() + static_cast<double>(signed_qty) * price) / static_cast<double>(total);
+        p.quantity = total;
+    } else {
+        // Closing some or all of the position, possibly flipping to the other side
+        int64_t closed = std::min(std::llabs(signed_qty), std::llabs(p.quantity));
+        double direction = p.quantity > 0 ? 1.0 : -1.0;
+        double pnl = direction * static_cast<double>(closed) * (price - p.avg_cost);
+        p.realized_pnl += pnl;
+        realized_pnl_ += pnl;
+        p.quantity += signed_qty;
+        if (p.quantity == 0) {
+            p.avg_cost = 0.0;
+        } else if ((p.quantity > 0) == (signed_qty > 0)) {
+            p.avg_cost = price; // flipped: the remainder was opened at this fill
+        }
+    }
+    realized_pnl_ -= fee;
+    p.realized_pnl -= fee;
+    p.last_price = price;
+
+    market_value_ += p.marketValue();
+    cost_basis_ += p.costBasis();
+    if (lots_) lots_->applyFill(symbol, side, quantity, price, fee, time_ns);
+}
+
+void Portfolio::restore(double cash, double realized_pnl, const std::vector<Position>& positions) {
+    cash_ = cash;
+    realized_pnl_ = realized_pnl;
+    positions_.clear();
+    slot_of_symbol_.clear();
+    for (const Position& p : positions) slot(p.symbol) = p;
+    ++fill_count_;
+    resync();
+}
+
+void Portfolio::resync() {
+    market_value_ = 0.0;
+    cost_basis_ = 0.0;
+    for (const Position& p : positions_) {
+        market_value_ += p.marketValue();
+        cost_basis_ += p.costBasis();
+    }
+}
@@ -5,4 +5,82 @@
 #ifndef PORTFOLIO_H
 #define PORTFOLIO_H
 
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "../engine/order.h"
+#include "tax_lots.h"
+
+struct Position {
+    SymbolId symbol = 0;
+    int64_t quantity = 0;     // negative when short
+    double avg_cost = 0.0;    // average entry price of the open quantity
+    double last_price = 0.0;
+    double realized_pnl = 0.0;
+
+    double marketValue() const { return static_cast<double>(quantity) * last_price; }
+    double costBasis() const { return static_cast<double>(quantity) * avg_cost; }
+    double unrealizedPnl() const { return marketValue() - costBasis(); }
+};
+
+// Cash plus per-symbol positions. Totals (market value, cost basis, realized P&L) are kept
+// as running sums adjusted by each tick or fill, so valuation never walks the positions.
+class Portfolio {
+public:
+    explicit Portfolio(double cash = 0.0) : cash_(cash) {}
+
+    // time_ns dates the tax lots the fill opens or closes; 0 uses the wall clock
+    void applyFill(SymbolId symbol, Side side, int64_t quantity, double price, double fee = 0.0,
+                   uint64_t time_ns = 0);
+    // O(1): only the change in this position's value touches the totals
+    void onPrice(SymbolId symbol, double price) {
+        if (symbol >= slot_of_symbol_.size() || slot_of_symbol_[symbol] < 0) return; // nothing held
+        Position& p = positions_[static_cast<size_t>(slot_of_symbol_[symbol])];
+        market_value_ += static_cast<double>(p.quantity) * (price - p.last_price);
+        p.last_price = price;
+    }
+    void adjustCash(double amount) { cash_ += amount; }
+
+    // Fills from now on are also booked as tax lots; off by default since the backtester doesn't need them
+    void attachLots(TaxLotLedger* lots) { lots_ = lots; }
+    TaxLotLedger* lots() const { return lots_; }
+
+    // Fills applied so far, so views derived from the positions know when to rebuild
+    uint64_t fillCount() const { return fill_count_; }
+
+    double cash() const { return cash_; }
+    double marketValue() const { return market_value_; }
+    double equity() const { return cash_ + market_value_; }
+    double unrealizedPnl() const { return market_value_ - cost_basis_; }
+    double realizedPnl() const { return realized_pnl_; }
+
+    int64_t quantity(SymbolId symbol) const {
+        const Position* p = position(symbol);
+        return p ? p->quantity : 0;
+    }
+    const Position* position(SymbolId symbol) const {
+        if (symbol >= slot_of_symbol_.size() || slot_of_symbol_[symbol] < 0) return nullptr;
+        return &positions_[static_cast<size_t>(slot_of_symbol_[symbol])];
+    }
+    const std::vector<Position>& positions() const { return positions_; }
+
+    // Replaces the whole state, e.g. when loading a snapshot
+    void restore(double cash, double realized_pnl, const std::vector<Position>& positions);
+
+    // Recomputes the running totals from scratch to shed accumulated rounding error
+    void resync();
+
+private:
+    Position& slot(SymbolId symbol);
+
+    double cash_;
+    double market_value_ = 0.0;
+    double cost_basis_ = 0.0;
+    double realized_pnl_ = 0.0;
+    std::vector<Position> positions_;
+    std::vector<int32_t> slot_of_symbol_; // symbol ids are dense, so a vector beats a hash map
+    TaxLotLedger* lots_ = nullptr;
+    uint64_t fill_count_ = 0;
+};
+
 #endif //PORTFOLIO_H
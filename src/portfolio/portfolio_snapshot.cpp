@@ -0,0 +1,304 @@
+#include "portfolio_snapshot.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+std::shared_ptr<const AccountState> captureAccount(AccountId account, const Portfolio& portfolio,
+                                                   std::vector<Order> orders) {
+    auto state = std::make_shared<AccountState>();
+    state->account = account;
+    state->cash = portfolio.cash();
+    state->realized_pnl = portfolio.realizedPnl();
+    state->positions = portfolio.positions();
+    state->orders = std::move(orders);
+    if (const TaxLotLedger* lots = portfolio.lots()) {
+        state->has_lots = true;
+        state->lot_method = lots->method();
+        state->lots = lots->openLots();
+        state->realized = lots->realized();
+    }
+    return state;
+}
+
+bool writeSnapshot(const std::string& path, const SnapshotSet& set) {
+    // Accounts are written sorted so readers can binary search them
+    std::vector<const AccountState*> accounts;
+    accounts.reserve(set.accounts.size());
+    for (const auto& account : set.accounts) {
+        if (account) accounts.push_back(account.get());
+    }
+    std::sort(accounts.begin(), accounts.end(),
+              [](const AccountState* a, const AccountState* b) { return a->account < b->account; });
+
+    SnapshotHeader header{};
+    std::memcpy(header.magic, kSnapshotMagic, sizeof(kSnapshotMagic));
+    header.version = kSnapshotVersion;
+    header.created_ns = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+    header.journal_seq = set.journal_seq;
+    header.next_order_id = set.next_order_id;
+    header.symbol_count = set.symbols.size();
+    header.account_count = accounts.size();
+
+    std::vector<SnapshotSymbol> symbols(set.symbols.size());
+    for (size_t i = 0; i < set.symbols.size(); ++i) {
+        std::strncpy(symbols[i].name, set.symbols[i].c_str(), sizeof(symbols[i].name) - 1);
+        symbols[i].last_price = i < set.last_prices.size() ? set.last_prices[i] : 0.0;
+    }
+
+    std::vector<SnapshotAccount> account_records;
+    std::vector<SnapshotPosition> positions;
+    std::vector<SnapshotOrder> orders;
+    std::vector<SnapshotLot> lots;
+    std::vector<SnapshotGain> gains;
+    account_records.reserve(accounts.size());
+    for (const AccountState* state : accounts) {
+        SnapshotAccount record{};
+        record.account = state->account;
+        record.cash = state->cash;
+        record.realized_pnl = state->realized_pnl;
+        record.first_position = positions.size();
+        record.first_order = orders.size();
+        record.first_lot = lots.size();
+        record.first_gain = gains.size();
+        record.lot_method = state->lot_method;
+        record.has_lots = state->has_lots ? 1 : 0;
+        for (const Position& p : state->positions) {
+            if (p.quantity == 0 && p.realized_pnl == 0.0) continue;
+            positions.push_back({p.symbol, 0, p.quantity, p.avg_cost, p.last_price, p.realized_pnl});
+        }
+        for (const Order& o : state->orders) {
+            orders.push_back({o.id, o.symbol, o.side, o.type, 0, o.price, o.quantity});
+        }
+        for (const TaxLot& l : state->lots) {
+            lots.push_back({l.id, l.symbol, l.side, {}, l.quantity, l.price, l.open_ns});
+        }
+        for (const RealizedGain& g : state->realized) {
+            gains.push_back({g.lot_id, g.symbol, g.side, {}, g.quantity, g.open_price, g.close_price, g.open_ns, g.close_ns});
+        }
+        record.position_count = static_cast<uint32_t>(positions.size() - record.first_position);
+        record.lot_count = static_cast<uint32_t>(lots.size() - record.first_lot);
+        record.gain_count = gains.size() - record.first_gain;
+        record.order_count = static_cast<uint32_t>(orders.size() - record.first_order);
+        account_records.push_back(record);
+    }
+    header.position_count = positions.size();
+    header.order_count = orders.size();
+    header.lot_count = lots.size();
+    header.gain_count = gains.size();
+
+    // Write beside the target and rename over it, so readers only ever see a complete file
+    std::string temp = path + ".tmp";
+    FILE* file = std::fopen(temp.c_str(), "wb");
+    if (!file) return false;
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1;
+    auto writeAll = [&](const auto& records) {
+        if (ok && !records.empty()) {
+            ok = std::fwrite(records.data(), sizeof(records[0]), records.size(), file) == records.size();
+        }
+    };
+    writeAll(symbols);
+    writeAll(account_records);
+    writeAll(positions);
+    writeAll(orders);
+    writeAll(lots);
+    writeAll(gains);
+    ok = std::fflush(file) == 0 && ok;
+    if (ok) fsync(fileno(file));
+    ok = std::fclose(file) == 0 && ok;
+    if (!ok || std::rename(temp.c_str(), path.c_str()) != 0) {
+        std::remove(temp.c_str());
+        return false;
+    }
+    return true;
+}
+
+// Adds a section of count records to used, failing instead of overflowing or passing available
+static bool takeSection(uint64_t& used, uint64_t available, uint64_t count, size_t record_size) {
+    if (count > (available - used) / record_size) return false;
+    used += count * record_size;
+    return true;
+}
+
+static bool inRange(uint64_t first, uint64_t count, uint64_t total) {
+    return first <= total && count <= total - first;
+}
+
+bool SnapshotView::open(const std::string& path) {
+    header_ = nullptr;
+    if (!file_.open(path) || file_.size() < sizeof(SnapshotHeader)) return false;
+
+    const auto* header = static_cast<const SnapshotHeader*>(file_.data());
+    if (std::memcmp(header->magic, kSnapshotMagic, sizeof(kSnapshotMagic)) != 0 || header->version != kSnapshotVersion) {
+        return false;
+    }
+    // Every count comes from the file, so the sizes are checked against what is mapped as they
+    // are summed, and every account's ranges against the section totals, before anything is indexed
+    uint64_t used = sizeof(SnapshotHeader);
+    if (!takeSection(used, file_.size(), header->symbol_count, sizeof(SnapshotSymbol)) ||
+        !takeSection(used, file_.size(), header->account_count, sizeof(SnapshotAccount)) ||
+        !takeSection(used, file_.size(), header->position_count, sizeof(SnapshotPosition)) ||
+        !takeSection(used, file_.size(), header->order_count, sizeof(SnapshotOrder)) ||
+        !takeSection(used, file_.size(), header->lot_count, sizeof(SnapshotLot)) ||
+        !takeSection(used, file_.size(), header->gain_count, sizeof(SnapshotGain))) {
+        return false;
+    }
+
+    const char* cursor = static_cast<const char*>(file_.data()) + sizeof(SnapshotHeader);
+    symbols_ = reinterpret_cast<const SnapshotSymbol*>(cursor);
+    cursor += header->symbol_count * sizeof(SnapshotSymbol);
+    accounts_ = reinterpret_cast<const SnapshotAccount*>(cursor);
+    cursor += header->account_count * sizeof(SnapshotAccount);
+    positions_ = reinterpret_cast<const SnapshotPosition*>(cursor);
+    cursor += header->position_count * sizeof(SnapshotPosition);
+    orders_ = reinterpret_cast<const SnapshotOrder*>(cursor);
+    cursor += header->order_count * sizeof(SnapshotOrder);
+    lots_ = reinterpret_cast<const SnapshotLot*>(cursor);
+    cursor += header->lot_count * sizeof(SnapshotLot);
+    gains_ = reinterpret_cast<const SnapshotGain*>(cursor);
+
+    for (uint64_t i = 0; i < header->account_count; ++i) {
+        const SnapshotAccount& account = accounts_[i];
+        if (!inRange(account.first_position, account.position_count, header->position_count) ||
+            !inRange(account.first_order, account.order_count, header->order_count) ||
+            !inRange(account.first_lot, account.lot_count, header->lot_count) ||
+            !inRange(account.first_gain, account.gain_count, header->gain_count)) {
+            return false;
+        }
+    }
+    header_ = header;
+    return true;
+}
+
+std::string SnapshotView::symbolName(SymbolId id) const {
+    if (id >= symbolCount()) return {};
+    const char* name = symbols_[id].name;
+    return std::string(name, strnlen(name, sizeof(symbols_[id].name)));
+}
+
+const SnapshotAccount* SnapshotView::findAccount(AccountId account) const {
+    const SnapshotAccount* begin = accounts_;
+    const SnapshotAccount* end = accounts_ + accountCount();
+    const SnapshotAccount* found = std::lower_bound(begin, end, account,
+        [](const SnapshotAccount& record, AccountId id) { return record.account < id; });
+    return found != end && found->account == account ? found : nullptr;
+}
+
+void SnapshotView::restore(const SnapshotAccount& account, const std::vector<SymbolId>& remap, Portfolio& out) const {
+    std::vector<Position> positions;
+    positions.reserve(account.position_count);
+    const SnapshotPosition* records = this->positions(account);
+    for (uint32_t i = 0; i < account.position_count; ++i) {
+        const SnapshotPosition& record = records[i];
+        if (record.symbol >= remap.size()) continue;
+        Position p;
+        p.symbol = remap[record.symbol];
+        p.quantity = record.quantity;
+        p.avg_cost = record.avg_cost;
+        p.last_price = record.last_price;
+        p.realized_pnl = record.realized_pnl;
+        positions.push_back(p);
+    }
+    out.restore(account.cash, account.realized_pnl, positions);
+
+    TaxLotLedger* ledger = out.lots();
+    if (!ledger || !account.has_lots) return;
+    std::vector<TaxLot> open_lots;
+    open_lots.reserve(account.lot_count);
+    const SnapshotLot* lot_records = lots(account);
+    for (uint32_t i = 0; i < account.lot_count; ++i) {
+        const SnapshotLot& record = lot_records[i];
+        if (record.symbol >= remap.size()) continue;
+        open_lots.push_back({record.id, remap[record.symbol], record.side, record.quantity, record.price, record.open_ns});
+    }
+    std::vector<RealizedGain> realized;
+    realized.reserve(static_cast<size_t>(account.gain_count));
+    const SnapshotGain* gain_records = gains(account);
+    for (uint64_t i = 0; i < account.gain_count; ++i) {
+        const SnapshotGain& record = gain_records[i];
+        if (record.symbol >= remap.size()) continue;
+        realized.push_back({record.lot_id, remap[record.symbol], record.side, record.quantity, record.open_price,
+                            record.close_price, record.open_ns, record.close_ns});
+    }
+    ledger->setMethod(account.lot_method);
+    ledger->restore(open_lots, std::move(realized));
+}
+
+void SnapshotView::recoveryPoint(const std::vector<SymbolId>& remap, RecoveryPoint& out) const {
+    out.journal_seq = header_->journal_seq;
+    out.next_order_id = header_->next_order_id;
+    out.last_prices.clear();
+    for (size_t i = 0; i < symbolCount() && i < remap.size(); ++i) {
+        if (remap[i] >= out.last_prices.size()) out.last_prices.resize(remap[i] + 1, 0.0);
+        out.last_prices[remap[i]] = symbols_[i].last_price;
+    }
+    out.resting.clear();
+    out.resting.reserve(static_cast<size_t>(header_->order_count));
+    for (size_t a = 0; a < accountCount(); ++a) {
+        const SnapshotAccount& account = accounts_[a];
+        const SnapshotOrder* records = orders(account);
+        for (uint32_t i = 0; i < account.order_count; ++i) {
+            const SnapshotOrder& record = records[i];
+            if (record.symbol >= remap.size()) continue;
+            Order order;
+            order.id = record.id;
+            order.account = account.account;
+            order.symbol = remap[record.symbol];
+            order.side = record.side;
+            order.type = record.type;
+            order.price = record.price;
+            order.quantity = record.quantity;
+            out.resting.push_back(order);
+        }
+    }
+    std::sort(out.resting.begin(), out.resting.end(), [](const Order& a, const Order& b) { return a.id < b.id; });
+}
+
+SnapshotWriter::SnapshotWriter(std::string path, std::chrono::milliseconds interval)
+    : path_(std::move(path)), interval_(interval), thread_([this] { run(); }) {}
+
+SnapshotWriter::~SnapshotWriter() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_one();
+    thread_.join();
+}
+
+void SnapshotWriter::publish(std::shared_ptr<const SnapshotSet> set) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    latest_ = std::move(set);
+    dirty_ = true;
+}
+
+uint64_t SnapshotWriter::snapshotsWritten() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return written_;
+}
+
+uint64_t SnapshotWriter::writtenSeq() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return written_seq_;
+}
+
+void SnapshotWriter::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        wake_.wait_for(lock, interval_, [&] { return stopping_; });
+        if (dirty_) {
+            std::shared_ptr<const SnapshotSet> set = latest_;
+            dirty_ = false;
+            lock.unlock();
+            bool ok = writeSnapshot(path_, *set);
+            lock.lock();
+            if (ok) {
+                written_++;
+                written_seq_ = set->journal_seq;
+            }
+        }
+        if (stopping_) return; // the final publish has been written above
+    }
+}
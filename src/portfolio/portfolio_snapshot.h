@@ -0,0 +1,199 @@
+#ifndef PORTFOLIO_SNAPSHOT_H
+#define PORTFOLIO_SNAPSHOT_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "portfolio.h"
+#include "../engine/order.h"
+#include "../util/mapped_file.h"
+
+// On-disk layout, all sections fixed-size records so a mapped file is usable in place:
+//   SnapshotHeader
+//   SnapshotSymbol   [symbol_count]   names and last prices, indexed by the SymbolId used in the file
+//   SnapshotAccount  [account_count]
+//   SnapshotPosition [position_count] grouped by account
+//   SnapshotOrder    [order_count]    resting orders, grouped by account
+//   SnapshotLot      [lot_count]      open tax lots, grouped by account (version 2)
+//   SnapshotGain     [gain_count]     realized lot closures, grouped by account (version 2)
+// Version 3 added the books' last prices and next order id, so the engine restarts from the
+// snapshot's orders and replays only the journal after it. Older versions are rejected; they
+// were only written while the journal still held everything from seq 1.
+constexpr char kSnapshotMagic[8] = {'T', 'S', 'P', 'O', 'R', 'T', 'F', 'O'};
+constexpr uint32_t kSnapshotVersion = 3;
+
+struct SnapshotHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+    uint64_t created_ns;
+    uint64_t journal_seq; // state includes every journal record up to this seq
+    uint64_t next_order_id;
+    uint64_t symbol_count;
+    uint64_t account_count;
+    uint64_t position_count;
+    uint64_t order_count;
+    uint64_t lot_count;
+    uint64_t gain_count;
+};
+
+struct SnapshotSymbol {
+    char name[24];
+    double last_price; // the book's, 0 if it never saw one
+};
+
+struct SnapshotAccount {
+    AccountId account;
+    uint32_t position_count;
+    double cash;
+    double realized_pnl;
+    uint64_t first_position;
+    uint64_t first_order;
+    uint32_t order_count;
+    uint32_t lot_count;
+    uint64_t first_lot;
+    uint64_t first_gain;
+    uint64_t gain_count;
+    LotMethod lot_method;
+    uint8_t has_lots; // 0 when the account wasn't tracking lots
+    uint8_t reserved[6];
+};
+
+struct SnapshotPosition {
+    SymbolId symbol;
+    uint32_t reserved;
+    int64_t quantity;
+    double avg_cost;
+    double last_price;
+    double realized_pnl;
+};
+
+struct SnapshotOrder {
+    uint64_t id;
+    SymbolId symbol;
+    Side side;
+    OrderType type;
+    uint16_t reserved;
+    double price;
+    int64_t quantity;
+};
+
+struct SnapshotLot {
+    uint64_t id;
+    SymbolId symbol;
+    Side side;
+    uint8_t reserved[3];
+    int64_t quantity;
+    double price;
+    uint64_t open_ns;
+};
+
+struct SnapshotGain {
+    uint64_t lot_id;
+    SymbolId symbol;
+    Side side;
+    uint8_t reserved[3];
+    int64_t quantity;
+    double open_price;
+    double close_price;
+    uint64_t open_ns;
+    uint64_t close_ns;
+};
+
+// Immutable copy of one account. Writers share these between snapshots and only
+// re-capture accounts that changed (copy-on-write at account granularity).
+struct AccountState {
+    AccountId account = 0;
+    double cash = 0.0;
+    double realized_pnl = 0.0;
+    std::vector<Position> positions;
+    std::vector<Order> orders;
+    bool has_lots = false;
+    LotMethod lot_method = LotMethod::FIFO;
+    std::vector<TaxLot> lots;
+    std::vector<RealizedGain> realized;
+};
+
+struct SnapshotSet {
+    std::vector<std::string> symbols; // name of each SymbolId
+    std::vector<std::shared_ptr<const AccountState>> accounts;
+    uint64_t journal_seq = 0;
+    uint64_t next_order_id = 1;
+    std::vector<double> last_prices; // by symbol id
+};
+
+std::shared_ptr<const AccountState> captureAccount(AccountId account, const Portfolio& portfolio,
+                                                   std::vector<Order> orders = {});
+bool writeSnapshot(const std::string& path, const SnapshotSet& set);
+
+// Zero-copy view of a snapshot file. Opening maps the file and validates the header and
+// each account's record ranges (a few compares per account, no copying), so a corrupt or
+// truncated file is rejected before anything indexes into it.
+class SnapshotView {
+public:
+    bool open(const std::string& path);
+
+    const SnapshotHeader& header() const { return *header_; }
+    size_t symbolCount() const { return static_cast<size_t>(header_->symbol_count); }
+    std::string symbolName(SymbolId id) const;
+    size_t accountCount() const { return static_cast<size_t>(header_->account_count); }
+    const SnapshotAccount& account(size_t index) const { return accounts_[index]; }
+    const SnapshotAccount* findAccount(AccountId account) const; // binary search, accounts are sorted
+    const SnapshotPosition* positions(const SnapshotAccount& account) const { return positions_ + account.first_position; }
+    const SnapshotOrder* orders(const SnapshotAccount& account) const { return orders_ + account.first_order; }
+    const SnapshotLot* lots(const SnapshotAccount& account) const { return lots_ + account.first_lot; }
+    const SnapshotGain* gains(const SnapshotAccount& account) const { return gains_ + account.first_gain; }
+
+    // Rebuilds a Portfolio, and its tax lots when a ledger is attached; remap translates
+    // file symbol ids to the running process's ids
+    void restore(const SnapshotAccount& account, const std::vector<SymbolId>& remap, Portfolio& out) const;
+    // Every account's resting orders plus the books' prices, for TradingEngine::recover()
+    void recoveryPoint(const std::vector<SymbolId>& remap, RecoveryPoint& out) const;
+
+private:
+    MappedFile file_;
+    const SnapshotHeader* header_ = nullptr;
+    const SnapshotSymbol* symbols_ = nullptr;
+    const SnapshotAccount* accounts_ = nullptr;
+    const SnapshotPosition* positions_ = nullptr;
+    const SnapshotOrder* orders_ = nullptr;
+    const SnapshotLot* lots_ = nullptr;
+    const SnapshotGain* gains_ = nullptr;
+};
+
+// Writes the most recently published set every interval on its own thread. publish() only
+// swaps a shared_ptr, so the trading side never waits on disk.
+class SnapshotWriter {
+public:
+    SnapshotWriter(std::string path, std::chrono::milliseconds interval);
+    ~SnapshotWriter();
+
+    SnapshotWriter(const SnapshotWriter&) = delete;
+    SnapshotWriter& operator=(const SnapshotWriter&) = delete;
+
+    void publish(std::shared_ptr<const SnapshotSet> set);
+    uint64_t snapshotsWritten() const;
+    // journal_seq of the last set that made it to disk, 0 before the first
+    uint64_t writtenSeq() const;
+
+private:
+    void run();
+
+    std::string path_;
+    std::chrono::milliseconds interval_;
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;
+    std::shared_ptr<const SnapshotSet> latest_;
+    bool dirty_ = false;
+    bool stopping_ = false;
+    uint64_t written_ = 0;
+    uint64_t written_seq_ = 0;
+    std::thread thread_;
+};
+
+#endif // PORTFOLIO_SNAPSHOT_H
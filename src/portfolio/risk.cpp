@@ -0,0 +1,191 @@
+#include "risk.h"
+#include <algorithm>
+#include <cmath>
+
+ReturnMatrix::ReturnMatrix(size_t assets, size_t window)
+    : assets_(assets), window_(window == 0 ? 1 : window), data_(assets * window_, 0.0) {}
+
+void ReturnMatrix::resize(size_t assets) {
+    if (assets <= assets_) return;
+    data_.resize(assets * window_, 0.0);
+    assets_ = assets;
+}
+
+void ReturnMatrix::append(const double* row) {
+    for (size_t i = 0; i < assets_; ++i) data_[i * window_ + head_] = row[i];
+    head_ = (head_ + 1) % window_;
+    filled_ = std::min(filled_ + 1, window_);
+}
+
+AlignedReturns::Asset& AlignedReturns::asset(size_t index) {
+    if (index >= assets_.size()) assets_.resize(index + 1);
+    return assets_[index];
+}
+
+void AlignedReturns::track(size_t index) {
+    asset(index).tracked = true;
+}
+
+void AlignedReturns::drop(size_t index) {
+    asset(index).tracked = false;
+}
+
+void AlignedReturns::add(size_t index, double time, double close) {
+    Asset& a = asset(index);
+    a.tracked = true;
+    if (time <= a.last_time) return; // already seen
+    a.last_time = time;
+    if (time <= released_) {
+        a.mark = close; // too late for its row, but the next return starts here
+        return;
+    }
+    pending_[time].emplace_back(index, close);
+}
+
+bool AlignedReturns::next(std::vector<double>& row) {
+    while (!pending_.empty()) {
+        // Every tracked asset has reported up to the slowest one's last bar
+        double complete = -1.0;
+        bool first = true;
+        for (const Asset& a : assets_) {
+            if (!a.tracked) continue;
+            complete = first ? a.last_time : std::min(complete, a.last_time);
+            first = false;
+        }
+        auto oldest = pending_.begin();
+        if (oldest->first > complete && pending_.size() <= max_pending_) return false;
+
+        row.assign(assets_.size(), 0.0);
+        bool any = false;
+        for (const auto& bar : oldest->second) {
+            Asset& a = assets_[bar.first];
+            if (a.mark > 0.0) {
+                row[bar.first] = bar.second / a.mark - 1.0;
+                any = true;
+            }
+            a.mark = bar.second;
+        }
+        released_ = oldest->first;
+        pending_.erase(oldest);
+        if (any) return true; // a row of first bars has no returns yet
+    }
+    return false;
+}
+
+void RiskEngine::scenarioPnl(const ReturnMatrix& returns, const std::vector<double>& exposures) {
+    const size_t scenarios = returns.scenarios();
+    const size_t assets = std::min(returns.assets(), exposures.size());
+    pnl_.assign(scenarios, 0.0);
+
+    // 512 scenarios = 4 KB of accumulators, which stays in L1 while every column streams past
+    const size_t block = 512;
+    const size_t blocks = (scenarios + block - 1) / block;
+    double* pnl = pnl_.data();
+    auto runBlock = [&](size_t b) {
+        size_t begin = b * block;
+        size_t end = std::min(begin + block, scenarios);
+        double* __restrict out = pnl + begin;
+        size_t n = end - begin;
+        for (size_t i = 0; i < assets; ++i) {
+            double w = exposures[i];
+            if (w == 0.0) continue;
+            const double* __restrict r = returns.column(i) + begin;
+            for (size_t s = 0; s < n; ++s) out[s] += w * r[s];
+        }
+    };
+
+    if (pool_ && blocks > 1) {
+        pool_->parallelFor(blocks, runBlock);
+    } else {
+        for (size_t b = 0; b < blocks; ++b) runBlock(b);
+    }
+}
+
+std::vector<RiskReport> RiskEngine::compute(const ReturnMatrix& returns, const std::vector<double>& exposures,
+                                            const std::vector<double>& confidences) {
+    std::vector<RiskReport> reports(confidences.size());
+    const size_t n = returns.scenarios();
+    if (n == 0) return reports;
+
+    scenarioPnl(returns, exposures);
+
+    double sum = 0.0, sum_sq = 0.0;
+    for (double v : pnl_) {
+        sum += v;
+        sum_sq += v * v;
+    }
+    double mean = sum / static_cast<double>(n);
+    double variance = n > 1 ? std::max(0.0, (sum_sq - static_cast<double>(n) * mean * mean) / static_cast<double>(n - 1)) : 0.0;
+    double stddev = std::sqrt(variance);
+
+    losses_.resize(n);
+    for (size_t s = 0; s < n; ++s) losses_[s] = -pnl_[s];
+
+    for (size_t c = 0; c < confidences.size(); ++c) {
+        RiskReport& report = reports[c];
+        double confidence = std::min(std::max(confidences[c], 0.5), 0.9999);
+        report.confidence = confidence;
+        report.scenarios = n;
+        report.mean_pnl = mean;
+        report.stddev_pnl = stddev;
+
+        // Historical: the confidence quantile of losses, and the average loss beyond it
+        size_t k = static_cast<size_t>(std::ceil(confidence * static_cast<double>(n)));
+        k = std::min(k == 0 ? 0 : k - 1, n - 1);
+        std::nth_element(losses_.begin(), losses_.begin() + static_cast<long>(k), losses_.end());
+        report.historical_var = losses_[k];
+        double tail = 0.0;
+        for (size_t s = k; s < n; ++s) tail += losses_[s];
+        report.historical_cvar = tail / static_cast<double>(n - k);
+
+        // Parametric: normal with the scenario mean and standard deviation
+        double z = inverseNormalCdf(confidence);
+        double density = std::exp(-0.5 * z * z) / std::sqrt(2.0 * M_PI);
+        report.parametric_var = z * stddev - mean;
+        report.parametric_cvar = stddev * density / (1.0 - confidence) - mean;
+    }
+    return reports;
+}
+
+std::vector<double> componentVar(const CovarianceEngine& covariance, const std::vector<double>& exposures,
+                                 double confidence) {
+    std::vector<double> sigma_w;
+    covariance.multiply(exposures, sigma_w);
+    double variance = 0.0;
+    for (size_t i = 0; i < sigma_w.size(); ++i) variance += exposures[i] * sigma_w[i];
+    std::vector<double> components(exposures.size(), 0.0);
+    if (variance <= 0.0) return components;
+    double scale = inverseNormalCdf(confidence) / std::sqrt(variance);
+    for (size_t i = 0; i < components.size(); ++i) components[i] = exposures[i] * sigma_w[i] * scale;
+    return components;
+}
+
+// Acklam's rational approximation, relative error below 1.2e-9
+double inverseNormalCdf(double p) {
+    static const double a[] = {-3.969683028665376e+01, 2.209460984245205e+02, -2.759285104469687e+02,
+                               1.383577518672690e+02, -3.066479806614716e+01, 2.506628277459239e+00};
+    static const double b[] = {-5.447609879822406e+01, 1.615858368580409e+02, -1.556989798598866e+02,
+                               6.680131188771972e+01, -1.328068155288572e+01};
+    static const double c[] = {-7.784894002430293e-03, -3.223964580411365e-01, -2.400758277161838e+00,
+                               -2.549732539343734e+00, 4.374664141464968e+00, 2.938163982698783e+00};
+    static const double d[] = {7.784695709041462e-03, 3.224671290700398e-01, 2.445134137142996e+00,
+                               3.754408661907416e+00};
+    const double low = 0.02425, high = 1.0 - low;
+
+    if (p <= 0.0) return -INFINITY;
+    if (p >= 1.0) return INFINITY;
+    if (p < low) {
+        double q = std::sqrt(-2.0 * std::log(p));
+        return (((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5]) /
+               ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1.0);
+    }
+    if (p > high) {
+        double q = std::sqrt(-2.0 * std::log(1.0 - p));
+        return -(((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5]) /
+               ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1.0);
+    }
+    double q = p - 0.5;
+    double r = q * q;
+    return (((((a[0] * r + a[1]) * r + a[2]) * r + a[3]) * r + a[4]) * r + a[5]) * q /
+           (((((b[0] * r + b[1]) * r + b[2]) * r + b[3]) * r + b[4]) * r + 1.0);
+}
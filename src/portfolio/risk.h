@@ -0,0 +1,112 @@
+#ifndef RISK_H
+#define RISK_H
+
+#include <cstddef>
+#include <map>
+#include <utility>
+#include <vector>
+#include "../util/thread_pool.h"
+#include "covariance.h"
+
+// Rolling window of per-bar returns, one contiguous column per asset. A scenario is one
+// bar across all assets. Once the window is full the oldest scenario slot is overwritten;
+// VaR treats scenarios as a set, so their order inside a column doesn't matter.
+class ReturnMatrix {
+public:
+    explicit ReturnMatrix(size_t assets = 0, size_t window = 500);
+
+    void resize(size_t assets); // new assets start with zero returns
+    void append(const double* row); // one return per asset
+    void append(const std::vector<double>& row) { append(row.data()); }
+
+    size_t assets() const { return assets_; }
+    size_t window() const { return window_; }
+    size_t scenarios() const { return filled_; }
+    const double* column(size_t asset) const { return data_.data() + asset * window_; }
+
+private:
+    size_t assets_;
+    size_t window_;
+    size_t head_ = 0;
+    size_t filled_ = 0;
+    std::vector<double> data_;
+};
+
+// Builds synchronized scenario rows from per-symbol bars. Bars are grouped by timestamp and
+// a row is released once every tracked asset has reported a bar at or after its time, so a
+// row is one bar across all assets. An asset with no bar at that time (a gap, or not trading
+// yet) contributes a zero return. Bars at or before an asset's last one are ignored, so
+// refetching overlapping history doesn't repeat scenarios; bars older than the last released
+// row only move that asset's mark. If an asset stops reporting without being dropped, rows
+// are forced out once max_pending timestamps are waiting.
+class AlignedReturns {
+public:
+    explicit AlignedReturns(size_t max_pending = 1024) : max_pending_(max_pending) {}
+
+    // Rows wait for this asset from now on, even before its first bar
+    void track(size_t asset);
+    // Stop waiting for an asset that gets no more bars; its mark is kept
+    void drop(size_t asset);
+    // One asset's bars in time order; time in epoch seconds. Tracks the asset.
+    void add(size_t asset, double time, double close);
+    // Next complete row, one simple return per asset; false when none is ready
+    bool next(std::vector<double>& row);
+
+    size_t assets() const { return assets_.size(); }
+
+private:
+    struct Asset {
+        double last_time = -1.0; // newest bar seen
+        double mark = 0.0;        // close the next return is measured from
+        bool tracked = false;
+    };
+
+    Asset& asset(size_t index);
+
+    std::vector<Asset> assets_;
+    std::map<double, std::vector<std::pair<size_t, double>>> pending_; // time -> (asset, close)
+    double released_ = -1.0; // time of the last row released
+    size_t max_pending_;
+};
+
+struct RiskReport {
+    double confidence = 0.0;
+    double historical_var = 0.0;  // losses are reported as positive dollar amounts
+    double historical_cvar = 0.0;
+    double parametric_var = 0.0;  // normal approximation
+    double parametric_cvar = 0.0;
+    double mean_pnl = 0.0;
+    double stddev_pnl = 0.0;
+    size_t scenarios = 0;
+};
+
+// Scenario P&L is sum(exposure_i * return_i) evaluated as one axpy per asset over a block
+// of scenarios, so the inner loop is a contiguous multiply-add the compiler vectorises.
+// Blocks of scenarios are spread over the pool when one is given.
+class RiskEngine {
+public:
+    explicit RiskEngine(WorkStealingPool* pool = nullptr) : pool_(pool) {}
+
+    // exposures[i] is the dollar value held in asset i (negative when short)
+    std::vector<RiskReport> compute(const ReturnMatrix& returns, const std::vector<double>& exposures,
+                                    const std::vector<double>& confidences);
+    RiskReport compute(const ReturnMatrix& returns, const std::vector<double>& exposures, double confidence) {
+        return compute(returns, exposures, std::vector<double>{confidence}).front();
+    }
+
+private:
+    void scenarioPnl(const ReturnMatrix& returns, const std::vector<double>& exposures);
+
+    WorkStealingPool* pool_;
+    std::vector<double> pnl_;
+    std::vector<double> losses_;
+};
+
+// Delta-normal VaR split by asset (Euler allocation); the entries sum to the portfolio's
+// z·σ. Reads the covariance engine's running sums, so the window length doesn't matter.
+std::vector<double> componentVar(const CovarianceEngine& covariance, const std::vector<double>& exposures,
+                                 double confidence);
+
+double inverseNormalCdf(double p);
+
+#endif // RISK_H
@@ -0,0 +1,226 @@
+#include "tax_lots.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+
+const char* lotMethodName(LotMethod method) {
+    switch (method) {
+        case LotMethod::FIFO: return "FIFO";
+        case LotMethod::LIFO: return "LIFO";
+        case LotMethod::HIFO: return "HIFO";
+        case LotMethod::SpecificId: return "Specific lots";
+    }
+    return "";
+}
+
+static uint64_t wallClockNs() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+}
+
+TaxLotLedger::Book& TaxLotLedger::book(SymbolId symbol) {
+    if (symbol >= books_.size()) books_.resize(symbol + 1);
+    return books_[symbol];
+}
+
+void TaxLotLedger::designate(SymbolId symbol, std::vector<std::pair<uint64_t, int64_t>> lots) {
+    book(symbol).designated = std::move(lots);
+}
+
+const std::vector<std::pair<uint64_t, int64_t>>& TaxLotLedger::designated(SymbolId symbol) const {
+    static const std::vector<std::pair<uint64_t, int64_t>> none;
+    return symbol < books_.size() ? books_[symbol].designated : none;
+}
+
+void TaxLotLedger::open(Book& book, SymbolId symbol, Side side, int64_t quantity, double price, uint64_t time_ns) {
+    TaxLot lot;
+    lot.id = lots_.size() + 1;
+    lot.symbol = symbol;
+    lot.side = side;
+    lot.quantity = quantity;
+    lot.price = price;
+    lot.open_ns = time_ns;
+    lots_.push_back(lot);
+    book.by_age.insert(book.by_age.end(), lot.id);
+    book.by_price.emplace(price, lot.id);
+    book.side = side;
+    book.quantity += quantity;
+}
+
+int64_t TaxLotLedger::close(Book& book, TaxLot& lot, int64_t quantity, double price, uint64_t time_ns) {
+    quantity = std::min(quantity, lot.quantity);
+    if (quantity <= 0) return 0;
+    RealizedGain gain;
+    gain.lot_id = lot.id;
+    gain.symbol = lot.symbol;
+    gain.side = lot.side;
+    gain.quantity = quantity;
+    gain.open_price = lot.price;
+    gain.close_price = price;
+    gain.open_ns = lot.open_ns;
+    gain.close_ns = time_ns;
+    realized_.push_back(gain);
+    addToTotals(gain);
+
+    lot.quantity -= quantity;
+    book.quantity -= quantity;
+    if (lot.quantity == 0) {
+        book.by_age.erase(lot.id);
+        book.by_price.erase({lot.price, lot.id});
+    }
+    return quantity;
+}
+
+void TaxLotLedger::addToTotals(const RealizedGain& gain) {
+    if (gain.symbol >= totals_.size()) {
+        for (size_t i = totals_.size(); i <= gain.symbol; ++i) {
+            totals_.emplace_back();
+            totals_.back().symbol = static_cast<SymbolId>(i);
+        }
+    }
+    GainSummary& s = totals_[gain.symbol];
+    s.quantity += gain.quantity;
+    s.proceeds += gain.proceeds();
+    s.cost += gain.cost();
+    if (gain.close_ns > gain.open_ns && gain.close_ns - gain.open_ns > kLongTermNs) {
+        s.long_term += gain.gain();
+    } else {
+        s.short_term += gain.gain();
+    }
+}
+
+uint64_t TaxLotLedger::nextLot(const Book& book) const {
+    switch (method_) {
+        case LotMethod::LIFO: return *book.by_age.rbegin();
+        case LotMethod::HIFO:
+            // Closing the dearest long (or cheapest short) lot realizes the smallest gain
+            return book.side == Side::Buy ? book.by_price.rbegin()->second : book.by_price.begin()->second;
+        default: return *book.by_age.begin();
+    }
+}
+
+void TaxLotLedger::applyFill(SymbolId symbol, Side side, int64_t quantity, double price, double fee,
+                             uint64_t time_ns) {
+    if (quantity <= 0) return;
+    if (time_ns == 0) time_ns = wallClockNs();
+    Book& b = book(symbol);
+    double fee_per_share = fee / static_cast<double>(quantity);
+
+    if (b.quantity == 0 || b.side == side) {
+        // Opening fees are part of the lot's basis
+        open(b, symbol, side, quantity, side == Side::Buy ? price + fee_per_share : price - fee_per_share, time_ns);
+        return;
+    }
+
+    // Closing fees reduce what the sale brought in (or add to what the cover cost)
+    double close_price = side == Side::Sell ? price - fee_per_share : price + fee_per_share;
+    int64_t remaining = quantity;
+    if (method_ == LotMethod::SpecificId) {
+        for (auto& designation : b.designated) {
+            if (remaining == 0) break;
+            if (designation.first == 0 || designation.first > lots_.size()) continue;
+            TaxLot& lot = lots_[designation.first - 1];
+            if (lot.symbol != symbol || lot.quantity == 0) continue;
+            int64_t closed = close(b, lot, std::min(remaining, designation.second), close_price, time_ns);
+            designation.second -= closed;
+            remaining -= closed;
+        }
+        // Drop what is used up or no longer open; the rest waits for the next closing fill
+        b.designated.erase(std::remove_if(b.designated.begin(), b.designated.end(),
+                                          [&](const std::pair<uint64_t, int64_t>& designation) {
+                                              const TaxLot* open_lot = lot(designation.first);
+                                              return designation.second <= 0 || !open_lot ||
+                                                     open_lot->symbol != symbol || open_lot->quantity == 0;
+                                          }),
+                           b.designated.end());
+    }
+    while (remaining > 0 && b.quantity > 0) {
+        remaining -= close(b, lots_[nextLot(b) - 1], remaining, close_price, time_ns);
+    }
+    // Anything left over flips the position and opens a lot on the other side
+    if (remaining > 0) open(b, symbol, side, remaining, price + (side == Side::Buy ? fee_per_share : -fee_per_share), time_ns);
+}
+
+const TaxLot* TaxLotLedger::lot(uint64_t id) const {
+    if (id == 0 || id > lots_.size()) return nullptr;
+    return &lots_[id - 1];
+}
+
+size_t TaxLotLedger::openLotCount(SymbolId symbol) const {
+    return symbol < books_.size() ? books_[symbol].by_age.size() : 0;
+}
+
+void TaxLotLedger::openLots(SymbolId symbol, std::vector<TaxLot>& out) const {
+    if (symbol >= books_.size()) return;
+    for (uint64_t id : books_[symbol].by_age) out.push_back(lots_[id - 1]);
+}
+
+std::vector<TaxLot> TaxLotLedger::openLots() const {
+    std::vector<TaxLot> out;
+    for (SymbolId symbol = 0; symbol < books_.size(); ++symbol) openLots(symbol, out);
+    return out;
+}
+
+std::vector<GainSummary> TaxLotLedger::summarize(uint64_t from_ns, uint64_t to_ns, uint64_t long_term_ns) const {
+    std::vector<GainSummary> by_symbol;
+    for (const RealizedGain& gain : realized_) {
+        if (gain.close_ns < from_ns || gain.close_ns >= to_ns) continue;
+        if (gain.symbol >= by_symbol.size()) by_symbol.resize(gain.symbol + 1);
+        GainSummary& s = by_symbol[gain.symbol];
+        s.symbol = gain.symbol;
+        s.quantity += gain.quantity;
+        s.proceeds += gain.proceeds();
+        s.cost += gain.cost();
+        if (gain.close_ns > gain.open_ns && gain.close_ns - gain.open_ns > long_term_ns) {
+            s.long_term += gain.gain();
+        } else {
+            s.short_term += gain.gain();
+        }
+    }
+    by_symbol.erase(std::remove_if(by_symbol.begin(), by_symbol.end(),
+                                   [](const GainSummary& s) { return s.quantity == 0; }),
+                    by_symbol.end());
+    return by_symbol;
+}
+
+void TaxLotLedger::clear() {
+    lots_.clear();
+    books_.clear();
+    realized_.clear();
+    totals_.clear();
+}
+
+void TaxLotLedger::restore(const std::vector<TaxLot>& open_lots, std::vector<RealizedGain> realized) {
+    clear();
+    realized_ = std::move(realized);
+    for (const RealizedGain& gain : realized_) addToTotals(gain);
+    // Ids are kept, so closed lots leave empty slots behind
+    uint64_t max_id = 0;
+    for (const TaxLot& lot : open_lots) max_id = std::max(max_id, lot.id);
+    for (const RealizedGain& gain : realized_) max_id = std::max(max_id, gain.lot_id);
+    lots_.resize(max_id);
+    for (size_t i = 0; i < lots_.size(); ++i) lots_[i].id = i + 1;
+    for (const TaxLot& lot : open_lots) {
+        if (lot.id == 0 || lot.quantity <= 0) continue;
+        lots_[lot.id - 1] = lot;
+        Book& b = book(lot.symbol);
+        b.by_age.insert(lot.id);
+        b.by_price.emplace(lot.price, lot.id);
+        b.side = lot.side;
+        b.quantity += lot.quantity;
+    }
+}
+
+bool writeRealizedGainsCsv(const std::string& path, const std::vector<RealizedGain>& realized,
+                           const std::vector<std::string>& symbol_names) {
+    std::ofstream out(path);
+    if (!out) return false;
+    out << "lot,symbol,side,quantity,open_price,close_price,open_ns,close_ns,proceeds,cost,gain\n";
+    for (const RealizedGain& g : realized) {
+        out << g.lot_id << ',' << (g.symbol < symbol_names.size() ? symbol_names[g.symbol] : std::to_string(g.symbol))
+            << ',' << (g.side == Side::Buy ? "long" : "short") << ',' << g.quantity << ',' << g.open_price << ','
+            << g.close_price << ',' << g.open_ns << ',' << g.close_ns << ',' << g.proceeds() << ',' << g.cost() << ','
+            << g.gain() << '\n';
+    }
+    return static_cast<bool>(out);
+}
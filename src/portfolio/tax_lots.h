@@ -0,0 +1,117 @@
+#ifndef TAX_LOTS_H
+#define TAX_LOTS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+#include "../engine/order.h"
+
+enum class LotMethod : uint8_t { FIFO, LIFO, HIFO, SpecificId };
+
+const char* lotMethodName(LotMethod method);
+
+struct TaxLot {
+    uint64_t id = 0;
+    SymbolId symbol = 0;
+    Side side = Side::Buy;  // Buy for long lots, Sell for short lots
+    int64_t quantity = 0;   // still open; 0 once fully closed
+    double price = 0.0;     // per share, including the opening fee
+    uint64_t open_ns = 0;   // wall clock
+};
+
+// One lot (or part of one) closed by a fill
+struct RealizedGain {
+    uint64_t lot_id = 0;
+    SymbolId symbol = 0;
+    Side side = Side::Buy; // side of the lot that was closed
+    int64_t quantity = 0;
+    double open_price = 0.0;
+    double close_price = 0.0; // per share, net of the closing fee
+    uint64_t open_ns = 0;
+    uint64_t close_ns = 0;
+
+    double proceeds() const { return static_cast<double>(quantity) * (side == Side::Buy ? close_price : open_price); }
+    double cost() const { return static_cast<double>(quantity) * (side == Side::Buy ? open_price : close_price); }
+    double gain() const { return proceeds() - cost(); }
+};
+
+struct GainSummary {
+    SymbolId symbol = 0;
+    int64_t quantity = 0;
+    double proceeds = 0.0;
+    double cost = 0.0;
+    double short_term = 0.0;
+    double long_term = 0.0;
+};
+
+// Lot-level cost basis for one account. Every open lot sits in two ordered indexes, by age
+// and by price, so a sell finds its next lot in O(log n) whatever the method, and any lot
+// is reachable by id in O(1). Positions are still valued at average cost by Portfolio;
+// this is the tax view of the same fills.
+class TaxLotLedger {
+public:
+    explicit TaxLotLedger(LotMethod method = LotMethod::FIFO) : method_(method) {}
+
+    void setMethod(LotMethod method) { method_ = method; }
+    LotMethod method() const { return method_; }
+
+    // (lot id, quantity) to close first, in order, on closing fills for this symbol while the
+    // method is SpecificId. What a partial fill leaves of them carries over to the next closing
+    // fill; whatever they don't cover is matched FIFO. An empty list cancels the designation.
+    void designate(SymbolId symbol, std::vector<std::pair<uint64_t, int64_t>> lots);
+    const std::vector<std::pair<uint64_t, int64_t>>& designated(SymbolId symbol) const;
+
+    // Same-side fills open a lot, opposite fills close lots and may flip the position.
+    // time_ns 0 uses the wall clock.
+    void applyFill(SymbolId symbol, Side side, int64_t quantity, double price, double fee = 0.0,
+                   uint64_t time_ns = 0);
+
+    const TaxLot* lot(uint64_t id) const;
+    size_t openLotCount(SymbolId symbol) const;
+    void openLots(SymbolId symbol, std::vector<TaxLot>& out) const; // oldest first
+    std::vector<TaxLot> openLots() const;                           // every symbol
+    const std::vector<RealizedGain>& realized() const { return realized_; }
+
+    static constexpr uint64_t kLongTermNs = 365ull * 24 * 3600 * 1000000000ull;
+
+    // Per-symbol totals of gains closed in [from_ns, to_ns). Holdings longer than
+    // long_term_ns count as long term.
+    std::vector<GainSummary> summarize(uint64_t from_ns = 0, uint64_t to_ns = UINT64_MAX,
+                                       uint64_t long_term_ns = kLongTermNs) const;
+    // The all-time summary, kept up to date by every closure; indexed by symbol id, with
+    // quantity 0 for symbols that never closed a lot
+    const std::vector<GainSummary>& totals() const { return totals_; }
+
+    // Replaces the whole state, e.g. when loading a snapshot
+    void restore(const std::vector<TaxLot>& open_lots, std::vector<RealizedGain> realized);
+    void clear();
+
+private:
+    struct Book {
+        std::set<uint64_t> by_age;                    // ids grow with time
+        std::set<std::pair<double, uint64_t>> by_price;
+        std::vector<std::pair<uint64_t, int64_t>> designated;
+        Side side = Side::Buy;
+        int64_t quantity = 0; // total open, always >= 0
+    };
+
+    Book& book(SymbolId symbol);
+    void open(Book& book, SymbolId symbol, Side side, int64_t quantity, double price, uint64_t time_ns);
+    int64_t close(Book& book, TaxLot& lot, int64_t quantity, double price, uint64_t time_ns);
+    uint64_t nextLot(const Book& book) const;
+    void addToTotals(const RealizedGain& gain);
+
+    LotMethod method_;
+    std::vector<TaxLot> lots_; // every lot ever opened, lots_[id - 1]
+    std::vector<Book> books_;  // indexed by symbol id
+    std::vector<RealizedGain> realized_;
+    std::vector<GainSummary> totals_;
+};
+
+bool writeRealizedGainsCsv(const std::string& path, const std::vector<RealizedGain>& realized,
+                           const std::vector<std::string>& symbol_names);
+
+#endif // TAX_LOTS_H
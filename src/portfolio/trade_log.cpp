@@ -0,0 +1,73 @@
+#include "trade_log.h"
+#include <algorithm>
+#include <chrono>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+TradeLog::TradeLog(size_t memory_records) : memory_records_(std::max<size_t>(memory_records, 2)) {
+    recent_.reserve(memory_records_);
+}
+
+TradeLog::~TradeLog() {
+    if (fd_ >= 0) ::close(fd_);
+}
+
+bool TradeLog::spillTo(const std::string& path) {
+    if (fd_ >= 0) return false;
+    fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    return fd_ >= 0;
+}
+
+void TradeLog::append(const TradeRecord& record) {
+    if (fd_ >= 0 && !spill_failed_ && recent_.size() >= memory_records_) evict();
+    recent_.push_back(record);
+    if (recent_.back().time_ns == 0) {
+        recent_.back().time_ns = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count());
+    }
+}
+
+// Moves the older half to disk in one write, so the cost is amortized over many appends
+void TradeLog::evict() {
+    size_t count = recent_.size() / 2;
+    const char* data = reinterpret_cast<const char*>(recent_.data());
+    size_t bytes = count * sizeof(TradeRecord);
+    size_t written = 0;
+    while (written < bytes) {
+        ssize_t n = ::pwrite(fd_, data + written, bytes - written,
+                             static_cast<off_t>(spilled_ * sizeof(TradeRecord) + written));
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) {
+            // Disk trouble: keep everything in memory rather than lose records, and don't retry
+            // a write of half the buffer on every append from now on
+            std::fprintf(stderr, "trade log: spill write failed (%s), keeping new trades in memory\n",
+                         n < 0 ? std::strerror(errno) : "no progress");
+            spill_failed_ = true;
+            return;
+        }
+        written += static_cast<size_t>(n);
+    }
+    recent_.erase(recent_.begin(), recent_.begin() + static_cast<std::ptrdiff_t>(count));
+    spilled_ += count;
+}
+
+TradeRecord TradeLog::at(size_t index) const {
+    if (index >= spilled_) return recent_[index - spilled_];
+    TradeRecord record;
+    if (::pread(fd_, &record, sizeof(record), static_cast<off_t>(index * sizeof(TradeRecord))) !=
+        static_cast<ssize_t>(sizeof(record))) {
+        return TradeRecord{};
+    }
+    return record;
+}
+
+int TradeLog::format(const TradeRecord& record, const std::string& symbol, char* out, size_t capacity) {
+    if (record.type == TradeRecordType::Rejected) {
+        return std::snprintf(out, capacity, "Order for %s rejected (no market price yet)", symbol.c_str());
+    }
+    return std::snprintf(out, capacity, "%s %lld share of %s at $%.2f", record.side == Side::Buy ? "Bought" : "Sold",
+                         static_cast<long long>(record.quantity), symbol.c_str(), record.price);
+}
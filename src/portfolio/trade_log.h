@@ -0,0 +1,56 @@
+#ifndef TRADE_LOG_H
+#define TRADE_LOG_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "../engine/order.h"
+
+enum class TradeRecordType : uint8_t { Fill, Rejected };
+
+// One fixed-size entry per account event. Text is only produced when a row is on screen.
+struct TradeRecord {
+    uint64_t time_ns = 0; // wall clock
+    uint64_t order_id = 0;
+    SymbolId symbol = 0;
+    TradeRecordType type = TradeRecordType::Fill;
+    Side side = Side::Buy;
+    uint16_t reserved = 0;
+    double price = 0.0;
+    int64_t quantity = 0;
+};
+
+// Append-only trade history. Without a spill file everything stays in memory; with one,
+// only the newest records are kept in memory and older ones are read back from disk on demand.
+// If a spill write fails, spilling stops for good and new records stay in memory.
+class TradeLog {
+public:
+    explicit TradeLog(size_t memory_records = 4096);
+    ~TradeLog();
+
+    TradeLog(const TradeLog&) = delete;
+    TradeLog& operator=(const TradeLog&) = delete;
+
+    // Starts a fresh spill file; records already in memory stay there until evicted
+    bool spillTo(const std::string& path);
+
+    void append(const TradeRecord& record);
+    size_t size() const { return spilled_ + recent_.size(); }
+    bool empty() const { return size() == 0; }
+    TradeRecord at(size_t index) const;
+
+    // Formats one record the way the log view shows it
+    static int format(const TradeRecord& record, const std::string& symbol, char* out, size_t capacity);
+
+private:
+    void evict();
+
+    size_t memory_records_;
+    int fd_ = -1;
+    bool spill_failed_ = false;      // the file still serves reads of what reached it
+    size_t spilled_ = 0;             // records [0, spilled_) live in the file
+    std::vector<TradeRecord> recent_; // records [spilled_, size())
+};
+
+#endif // TRADE_LOG_H
@@ -0,0 +1,89 @@
+#include "market_feed.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+MarketFeed::MarketFeed(TradingEngine& engine, const std::vector<std::string>& symbols,
+                       std::chrono::milliseconds interval, double start_price, uint64_t seed)
+    : engine_(engine), names_(symbols), interval_(interval), seed_(seed) {
+    for (const auto& name : names_) ids_.push_back(engine_.symbolId(name));
+    price_count_ = ids_.empty() ? 0 : *std::max_element(ids_.begin(), ids_.end()) + 1;
+    prices_ = std::make_unique<std::atomic<double>[]>(price_count_);
+    for (size_t i = 0; i < price_count_; ++i) prices_[i].store(0.0, std::memory_order_relaxed);
+    for (SymbolId id : ids_) prices_[id].store(start_price, std::memory_order_relaxed);
+}
+
+MarketFeed::~MarketFeed() {
+    stop();
+}
+
+void MarketFeed::start() {
+    if (worker_.joinable()) return;
+    for (SymbolId id : ids_) engine_.onMarketPrice(id, lastPrice(id));
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = false;
+    }
+    worker_ = std::thread([this] { run(); });
+}
+
+void MarketFeed::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    if (worker_.joinable()) worker_.join();
+}
+
+void MarketFeed::pause() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    paused_ = true;
+    wake_.wait(lock, [&] { return !ticking_; });
+}
+
+void MarketFeed::resume() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        paused_ = false;
+    }
+    wake_.notify_all();
+}
+
+bool MarketFeed::find(const std::string& symbol, SymbolId& out) const {
+    for (size_t i = 0; i < names_.size(); ++i) {
+        if (names_[i] == symbol) {
+            out = ids_[i];
+            return true;
+        }
+    }
+    return false;
+}
+
+void MarketFeed::run() {
+    std::mt19937_64 rng(seed_);
+    std::normal_distribution<double> shock(0.0, 0.001);
+    auto next = std::chrono::steady_clock::now();
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stopping_) {
+        next += interval_;
+        if (wake_.wait_until(lock, next, [&] { return stopping_; })) break;
+        if (paused_) {
+            wake_.wait(lock, [&] { return stopping_ || !paused_; });
+            if (stopping_) break;
+            next = std::max(next, std::chrono::steady_clock::now()); // no burst of missed ticks
+        }
+        ticking_ = true;
+        lock.unlock();
+        for (SymbolId id : ids_) {
+            double price = lastPrice(id) * std::exp(shock(rng));
+            price = std::max(0.01, std::round(price * 100.0) / 100.0);
+            prices_[id].store(price, std::memory_order_relaxed);
+            engine_.onMarketPrice(id, price);
+        }
+        ticks_.fetch_add(1, std::memory_order_relaxed);
+        lock.lock();
+        ticking_ = false;
+        wake_.notify_all();
+    }
+}
@@ -0,0 +1,64 @@
+#ifndef MARKET_FEED_H
+#define MARKET_FEED_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../engine/trading_engine.h"
+
+// One simulated price stream per symbol, shared by every session on the server. A single
+// thread random-walks the prices and pushes each tick into the engine; sessions read the
+// latest price lock-free for quotes and buying-power checks.
+class MarketFeed {
+public:
+    MarketFeed(TradingEngine& engine, const std::vector<std::string>& symbols,
+               std::chrono::milliseconds interval = std::chrono::milliseconds(100),
+               double start_price = 100.0, uint64_t seed = 42);
+    ~MarketFeed();
+
+    MarketFeed(const MarketFeed&) = delete;
+    MarketFeed& operator=(const MarketFeed&) = delete;
+
+    // Publishes the opening prices synchronously, then ticks on a background thread
+    void start();
+    void stop();
+    // No tick reaches the engine between these; pause() returns once a tick in flight is done
+    void pause();
+    void resume();
+
+    // False for symbols the feed doesn't carry
+    bool find(const std::string& symbol, SymbolId& out) const;
+    // 0 for symbols the feed doesn't carry
+    double lastPrice(SymbolId symbol) const {
+        return symbol < price_count_ ? prices_[symbol].load(std::memory_order_relaxed) : 0.0;
+    }
+    const std::vector<SymbolId>& symbols() const { return ids_; }
+    const std::vector<std::string>& names() const { return names_; }
+    uint64_t ticks() const { return ticks_.load(std::memory_order_relaxed); }
+
+private:
+    void run();
+
+    TradingEngine& engine_;
+    std::vector<std::string> names_;
+    std::vector<SymbolId> ids_;
+    std::unique_ptr<std::atomic<double>[]> prices_; // indexed by SymbolId
+    size_t price_count_ = 0;
+    std::chrono::milliseconds interval_;
+    uint64_t seed_;
+    std::atomic<uint64_t> ticks_{0};
+
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    bool stopping_ = false;
+    bool paused_ = false;
+    bool ticking_ = false; // pushing a tick into the engine, outside the lock
+    std::thread worker_;
+};
+
+#endif // MARKET_FEED_H
@@ -0,0 +1,570 @@
+#include "session_server.h"
+#include "../engine/latency.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#ifdef MSG_NOSIGNAL
+static constexpr int kSendFlags = MSG_NOSIGNAL;
+#else
+static constexpr int kSendFlags = 0; // macOS: SO_NOSIGPIPE is set per socket instead
+#endif
+
+static constexpr size_t kMaxLine = 4096;
+static constexpr size_t kMaxPendingOutput = 1 << 20; // a client this far behind is dropped
+static constexpr double kMarketBuyHeadroom = 0.01;     // market buys may fill up to 1% above the last price
+
+static bool setNonBlocking(int fd) {
+    int flags = fcntl(fd, F_GETFL, 0);
+    return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+SessionServer::SessionServer(TradingEngine& engine, UserStore& users, MarketFeed& feed)
+    : engine_(engine), users_(users), feed_(feed) {
+    if (pipe(wake_pipe_) == 0) {
+        setNonBlocking(wake_pipe_[0]);
+        setNonBlocking(wake_pipe_[1]);
+    }
+}
+
+SessionServer::~SessionServer() {
+    for (auto& entry : sessions_) ::close(entry.first);
+    for (int listener : listeners_) ::close(listener);
+    if (!unix_path_.empty()) unlink(unix_path_.c_str());
+    if (wake_pipe_[0] >= 0) ::close(wake_pipe_[0]);
+    if (wake_pipe_[1] >= 0) ::close(wake_pipe_[1]);
+}
+
+bool SessionServer::listenTcp(uint16_t port, bool loopback_only) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return false;
+    int on = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(loopback_only ? INADDR_LOOPBACK : INADDR_ANY);
+    if (bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || listen(fd, SOMAXCONN) != 0 ||
+        !setNonBlocking(fd)) {
+        ::close(fd);
+        return false;
+    }
+    listeners_.push_back(fd);
+    return true;
+}
+
+bool SessionServer::listenUnix(const std::string& path) {
+    sockaddr_un address{};
+    if (path.size() >= sizeof(address.sun_path)) return false;
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return false;
+    address.sun_family = AF_UNIX;
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+    unlink(path.c_str()); // a stale socket file from a previous run would make bind fail
+    if (bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || listen(fd, SOMAXCONN) != 0 ||
+        !setNonBlocking(fd)) {
+        ::close(fd);
+        return false;
+    }
+    listeners_.push_back(fd);
+    unix_path_ = path;
+    return true;
+}
+
+bool SessionServer::attachSnapshots(const std::string& path, std::chrono::milliseconds interval) {
+    SnapshotView snapshot;
+    if (snapshot.open(path)) {
+        std::vector<SymbolId> remap(snapshot.symbolCount());
+        for (size_t i = 0; i < remap.size(); ++i) {
+            remap[i] = engine_.symbolId(snapshot.symbolName(static_cast<SymbolId>(i)));
+        }
+        for (size_t i = 0; i < snapshot.accountCount(); ++i) {
+            const SnapshotAccount& saved = snapshot.account(i);
+            auto loaded = std::make_unique<Account>();
+            snapshot.restore(saved, remap, loaded->portfolio);
+            loaded->captured = captureAccount(saved.account, loaded->portfolio);
+            ranking_.track(saved.account, &loaded->portfolio, loaded->portfolio.equity());
+            accounts_[saved.account] = std::move(loaded);
+        }
+        snapshot.recoveryPoint(remap, recovery_);
+    }
+    snapshot_writer_ = std::make_unique<SnapshotWriter>(path, std::chrono::milliseconds(1000));
+    snapshot_interval_ = interval;
+    last_snapshot_ = std::chrono::steady_clock::now();
+    return true;
+}
+
+bool SessionServer::attachJournal(Journal& journal, const std::string& path) {
+    uint64_t last_seq = engine_.recover({Journal::previousPath(path), path}, recovery_);
+    recovery_ = RecoveryPoint();
+    deliverEvents();
+    std::vector<Order> resting;
+    engine_.restingOrders(resting);
+    for (const Order& order : resting) {
+        Account& owner = account(order.account);
+        if (order.side == Side::Buy) {
+            owner.reserved_cash += order.price * static_cast<double>(order.quantity);
+        } else {
+            owner.reserved_shares[order.symbol] += order.quantity;
+        }
+        open_orders_[order.id] = {order.account, order.symbol, order.side, order.price, order.quantity};
+    }
+    if (!journal.open(path, last_seq + 1)) return false;
+    engine_.attachJournal(&journal);
+    journal_ = &journal;
+    rotated_seq_ = last_seq;
+    return true;
+}
+
+void SessionServer::stop() {
+    stopping_.store(true, std::memory_order_release);
+    if (wake_pipe_[1] >= 0) {
+        char byte = 0;
+        ssize_t ignored = write(wake_pipe_[1], &byte, 1);
+        (void)ignored;
+    }
+}
+
+void SessionServer::run() {
+    std::vector<pollfd> fds;
+    std::vector<int> finished;
+    while (!stopping_.load(std::memory_order_acquire)) {
+        fds.clear();
+        fds.push_back({wake_pipe_[0], POLLIN, 0});
+        for (int listener : listeners_) fds.push_back({listener, POLLIN, 0});
+        size_t first_session = fds.size();
+        for (const auto& entry : sessions_) {
+            const Session& session = entry.second;
+            short events = session.closing ? 0 : POLLIN;
+            if (session.out_sent < session.out.size()) events |= POLLOUT;
+            fds.push_back({entry.first, events, 0});
+        }
+
+        // Engine events have no file descriptor to wait on, so poll briefly while orders are in flight
+        int timeout_ms = open_orders_.empty() ? 50 : 1;
+        int ready = poll(fds.data(), static_cast<nfds_t>(fds.size()), timeout_ms);
+        if (ready < 0 && errno != EINTR) break;
+
+        if (ready > 0) {
+            if (fds[0].revents & POLLIN) {
+                char drain[64];
+                while (read(wake_pipe_[0], drain, sizeof(drain)) > 0) {}
+            }
+            for (size_t i = 1; i < first_session; ++i) {
+                if (fds[i].revents & POLLIN) acceptFrom(fds[i].fd);
+            }
+            for (size_t i = first_session; i < fds.size(); ++i) {
+                if (fds[i].revents == 0) continue;
+                auto found = sessions_.find(fds[i].fd);
+                if (found == sessions_.end()) continue;
+                if (fds[i].revents & (POLLIN | POLLHUP | POLLERR)) readFrom(found->second);
+                if (fds[i].revents & POLLOUT) writeTo(found->second);
+            }
+        }
+
+        deliverEvents();
+
+        // Replies and pushed fills go out now rather than after the next poll
+        finished.clear();
+        for (auto& entry : sessions_) {
+            Session& session = entry.second;
+            if (session.out_sent < session.out.size()) writeTo(session);
+            if (session.closing && session.out_sent >= session.out.size()) finished.push_back(entry.first);
+        }
+        for (int fd : finished) close(fd);
+
+        auto now = std::chrono::steady_clock::now();
+        if (now - last_mark_ >= std::chrono::seconds(1)) markLeaderboard();
+        if (snapshot_writer_ && now - last_snapshot_ >= snapshot_interval_) {
+            saveSnapshot();
+        }
+    }
+    if (snapshot_writer_) {
+        engine_.flush();
+        deliverEvents();
+        saveSnapshot();
+    }
+}
+
+void SessionServer::acceptFrom(int listener) {
+    while (true) {
+        int fd = accept(listener, nullptr, nullptr);
+        if (fd < 0) return; // EAGAIN once the backlog is empty; EMFILE leaves the rest queued
+        setNonBlocking(fd);
+        int on = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on)); // fails harmlessly on Unix sockets
+#ifdef SO_NOSIGPIPE
+        setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#endif
+        Session& session = sessions_[fd];
+        session.fd = fd;
+        session_count_.store(sessions_.size(), std::memory_order_relaxed);
+    }
+}
+
+void SessionServer::readFrom(Session& session) {
+    char buffer[4096];
+    bool hung_up = false, broken = false;
+    while (true) {
+        ssize_t received = recv(session.fd, buffer, sizeof(buffer), 0);
+        if (received > 0) {
+            session.in.append(buffer, static_cast<size_t>(received));
+            continue;
+        }
+        if (received < 0 && errno == EINTR) continue;
+        if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+        // A clean EOF may only close the client's half, so what it sent still gets answered
+        hung_up = true;
+        broken = received < 0;
+        break;
+    }
+
+    size_t start = 0;
+    while (!session.closing) {
+        size_t end = session.in.find('\n', start);
+        if (end == std::string::npos) break;
+        if (end > start && session.in[end - 1] == '\r') session.in[end - 1] = '\0';
+        session.in[end] = '\0';
+        handleLine(session, &session.in[start]);
+        start = end + 1;
+    }
+    session.in.erase(0, start);
+    if (session.in.size() > kMaxLine) {
+        reply(session, "ERR line too long\n");
+        session.closing = true;
+    }
+    if (hung_up) {
+        session.closing = true;
+        if (broken) {
+            session.out.clear();
+            session.out_sent = 0;
+        }
+    }
+}
+
+void SessionServer::writeTo(Session& session) {
+    while (session.out_sent < session.out.size()) {
+        ssize_t sent = send(session.fd, session.out.data() + session.out_sent, session.out.size() - session.out_sent,
+                            kSendFlags);
+        if (sent > 0) {
+            session.out_sent += static_cast<size_t>(sent);
+            continue;
+        }
+        if (sent < 0 && errno == EINTR) continue;
+        if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            if (session.out.size() - session.out_sent > kMaxPendingOutput) {
+                session.closing = true;
+                session.out.clear();
+                session.out_sent = 0;
+            }
+            return;
+        }
+        session.closing = true;
+        session.out.clear();
+        session.out_sent = 0;
+        return;
+    }
+    session.out.clear();
+    session.out_sent = 0;
+}
+
+void SessionServer::close(int fd) {
+    auto found = sessions_.find(fd);
+    if (found == sessions_.end()) return;
+    if (found->second.logged_in) {
+        auto owner = accounts_.find(found->second.user);
+        if (owner != accounts_.end()) {
+            auto& fds = owner->second->sessions;
+            fds.erase(std::remove(fds.begin(), fds.end(), fd), fds.end());
+        }
+    }
+    ::close(fd);
+    sessions_.erase(found);
+    session_count_.store(sessions_.size(), std::memory_order_relaxed);
+}
+
+void SessionServer::reply(Session& session, const char* format, ...) {
+    char buffer[256];
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+    if (length <= 0) return;
+    session.out.append(buffer, std::min(static_cast<size_t>(length), sizeof(buffer) - 1));
+}
+
+SessionServer::Account& SessionServer::account(UserId user) {
+    auto found = accounts_.find(user);
+    if (found != accounts_.end()) return *found->second;
+    auto created = std::make_unique<Account>();
+    created->portfolio.adjustCash(users_.balance(user));
+    Account& result = *created;
+    accounts_.emplace(user, std::move(created));
+    ranking_.track(user, &result.portfolio, result.portfolio.equity());
+    return result;
+}
+
+void SessionServer::handleLine(Session& session, char* line) {
+    char* rest = nullptr;
+    char* command = strtok_r(line, " \t", &rest);
+    if (!command) return;
+    char* args[4] = {};
+    for (char*& arg : args) arg = strtok_r(nullptr, " \t", &rest);
+
+    if (std::strcmp(command, "LOGIN") == 0) {
+        handleLogin(session, args[0], args[1]);
+    } else if (std::strcmp(command, "QUIT") == 0) {
+        session.closing = true;
+    } else if (std::strcmp(command, "PRICE") == 0) {
+        SymbolId symbol = 0;
+        if (!args[0] || !feed_.find(args[0], symbol)) {
+            reply(session, "ERR unknown symbol\n");
+        } else {
+            reply(session, "PRICE %s %.2f\n", args[0], feed_.lastPrice(symbol));
+        }
+    } else if (!session.logged_in) {
+        reply(session, "ERR not logged in\n");
+    } else if (std::strcmp(command, "BUY") == 0) {
+        handleOrder(session, Side::Buy, args[0], args[1], args[2]);
+    } else if (std::strcmp(command, "SELL") == 0) {
+        handleOrder(session, Side::Sell, args[0], args[1], args[2]);
+    } else if (std::strcmp(command, "CANCEL") == 0) {
+        SymbolId symbol = 0;
+        uint64_t order_id = args[1] ? std::strtoull(args[1], nullptr, 10) : 0;
+        auto found = open_orders_.find(order_id);
+        if (!args[0] || !feed_.find(args[0], symbol) || found == open_orders_.end() ||
+            found->second.user != session.user || found->second.symbol != symbol) {
+            reply(session, "ERR unknown order\n");
+        } else {
+            engine_.cancelOrder(symbol, order_id);
+            reply(session, "ACK %llu\n", static_cast<unsigned long long>(order_id));
+        }
+    } else if (std::strcmp(command, "POS") == 0) {
+        Account& owner = account(session.user);
+        for (SymbolId symbol : feed_.symbols()) owner.portfolio.onPrice(symbol, feed_.lastPrice(symbol));
+        reply(session, "CASH %.2f %.2f\n", owner.portfolio.cash(), owner.portfolio.equity());
+        for (const Position& position : owner.portfolio.positions()) {
+            if (position.quantity == 0) continue;
+            reply(session, "POS %s %lld %.4f\n", engine_.symbolName(position.symbol).c_str(),
+                  static_cast<long long>(position.quantity), position.avg_cost);
+        }
+        reply(session, "END\n");
+    } else if (std::strcmp(command, "LEADERS") == 0) {
+        size_t k = args[0] ? std::strtoul(args[0], nullptr, 10) : 10;
+        std::vector<Leaderboard::Entry> leaders;
+        ranking_.board().top(std::min<size_t>(k, 100), leaders);
+        UserProfile profile;
+        for (size_t i = 0; i < leaders.size(); ++i) {
+            if (!users_.profile(leaders[i].account, profile)) continue;
+            reply(session, "LEADER %zu %s %.2f\n", i + 1, profile.uid.c_str(), leaders[i].score);
+        }
+        reply(session, "END\n");
+    } else if (std::strcmp(command, "RANK") == 0) {
+        const Leaderboard& board = ranking_.board();
+        reply(session, "RANK %zu %zu %.2f\n", board.rank(session.user) + 1, board.size(), board.score(session.user));
+    } else {
+        reply(session, "ERR unknown command\n");
+    }
+}
+
+void SessionServer::handleLogin(Session& session, char* name, char* password) {
+    if (session.logged_in) {
+        reply(session, "ERR already logged in\n");
+        return;
+    }
+    UserId user = 0;
+    UserProfile profile;
+    if (!name || !password || !users_.login(name, password, user) || !users_.profile(user, profile)) {
+        reply(session, "ERR bad credentials\n");
+        return;
+    }
+    Account& owner = account(user);
+    owner.sessions.push_back(session.fd);
+    session.user = user;
+    session.logged_in = true;
+    reply(session, "OK %s %.2f\n", profile.uid.c_str(), owner.portfolio.cash());
+}
+
+void SessionServer::handleOrder(Session& session, Side side, char* symbol_name, char* quantity_text,
+                                char* limit_text) {
+    SymbolId symbol = 0;
+    if (!symbol_name || !feed_.find(symbol_name, symbol)) {
+        reply(session, "ERR unknown symbol\n");
+        return;
+    }
+    int64_t quantity = quantity_text ? std::strtoll(quantity_text, nullptr, 10) : 0;
+    double limit = limit_text ? std::strtod(limit_text, nullptr) : 0.0;
+    if (quantity <= 0 || (limit_text && limit <= 0.0)) {
+        reply(session, "ERR bad order\n");
+        return;
+    }
+
+    Account& owner = account(session.user);
+    // A market buy is held to the cash it reserved: it carries that price as its protection
+    // limit, so neither resting asks nor a price move can fill it above what was set aside
+    double reserve_price = limit_text ? limit : feed_.lastPrice(symbol) * (1.0 + kMarketBuyHeadroom);
+    if (side == Side::Buy) {
+        if (reserve_price <= 0.0) {
+            reply(session, "ERR no price\n");
+            return;
+        }
+        double cost = reserve_price * static_cast<double>(quantity);
+        if (owner.portfolio.cash() - owner.reserved_cash < cost) {
+            reply(session, "ERR insufficient funds\n");
+            return;
+        }
+        owner.reserved_cash += cost;
+    } else {
+        int64_t& held_back = owner.reserved_shares[symbol];
+        if (owner.portfolio.quantity(symbol) - held_back < quantity) {
+            reply(session, "ERR insufficient shares\n");
+            return;
+        }
+        held_back += quantity;
+    }
+
+    Order order;
+    order.account = session.user;
+    order.symbol = symbol;
+    order.side = side;
+    order.type = limit_text ? OrderType::Limit : OrderType::Market;
+    order.price = side == Side::Buy ? reserve_price : limit;
+    order.quantity = quantity;
+    uint64_t order_id = engine_.submitOrder(order);
+    open_orders_[order_id] = {session.user, symbol, side, reserve_price, quantity};
+    orders_accepted_.fetch_add(1, std::memory_order_relaxed);
+    reply(session, "ACK %llu\n", static_cast<unsigned long long>(order_id));
+}
+
+void SessionServer::release(Account& owner, const OpenOrder& order, int64_t quantity) {
+    if (order.side == Side::Buy) {
+        owner.reserved_cash = std::max(0.0, owner.reserved_cash - order.reserve_price * static_cast<double>(quantity));
+    } else {
+        auto held = owner.reserved_shares.find(order.symbol);
+        if (held != owner.reserved_shares.end()) held->second = std::max<int64_t>(0, held->second - quantity);
+    }
+}
+
+void SessionServer::deliverEvents() {
+    events_.clear();
+    if (engine_.pollEvents(events_) == 0) return;
+    for (const EngineEvent& event : events_) {
+        // Replayed fills can belong to accounts nobody has logged into since the restart
+        Account& owner = account(event.account);
+
+        auto open = open_orders_.find(event.order_id);
+        if (open != open_orders_.end()) {
+            int64_t settled = event.type == EventType::Fill ? event.quantity : open->second.remaining;
+            release(owner, open->second, settled);
+            open->second.remaining -= settled;
+            if (open->second.remaining <= 0) open_orders_.erase(open);
+        }
+
+        char message[128];
+        int length = 0;
+        if (event.type == EventType::Fill) {
+            owner.portfolio.applyFill(event.symbol, event.side, event.quantity, event.price);
+            owner.dirty = true;
+            ranking_.onFill(event.account, event.symbol);
+            latency::record(LatencyStage::MatchToPortfolio, event.match_ns, latency::now());
+            fills_delivered_.fetch_add(1, std::memory_order_relaxed);
+            length = std::snprintf(message, sizeof(message), "FILL %llu %s %s %lld %.2f\n",
+                                   static_cast<unsigned long long>(event.order_id),
+                                   engine_.symbolName(event.symbol).c_str(), event.side == Side::Buy ? "BUY" : "SELL",
+                                   static_cast<long long>(event.quantity), event.price);
+        } else {
+            length = std::snprintf(message, sizeof(message), "%s %llu\n",
+                                   event.type == EventType::Cancelled ? "CANCELLED" : "REJECTED",
+                                   static_cast<unsigned long long>(event.order_id));
+        }
+        if (length <= 0) continue;
+        for (int fd : owner.sessions) {
+            auto session = sessions_.find(fd);
+            if (session != sessions_.end() && !session->second.closing) {
+                session->second.out.append(message, static_cast<size_t>(length));
+            }
+        }
+    }
+}
+
+void SessionServer::markLeaderboard() {
+    // Batched once a second rather than per tick: each mark costs O(holders · log n)
+    for (SymbolId symbol : feed_.symbols()) {
+        if (symbol >= marked_prices_.size()) marked_prices_.resize(symbol + 1, 0.0);
+        double price = feed_.lastPrice(symbol);
+        if (price == marked_prices_[symbol]) continue;
+        marked_prices_[symbol] = price;
+        ranking_.onPrice(symbol, price);
+    }
+    last_mark_ = std::chrono::steady_clock::now();
+}
+
+static bool sameOrders(const std::vector<Order>& a, const std::vector<Order>& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (a[i].id != b[i].id || a[i].quantity != b[i].quantity) return false;
+    }
+    return true;
+}
+
+void SessionServer::saveSnapshot() {
+    // With a journal the snapshot must hold exactly the commands up to its seq, or a restart
+    // would replay some twice or lose them. Sessions only submit from this thread, so with the
+    // feed held back nothing new is journaled until the books and fills are read.
+    uint64_t journal_seq = 0;
+    if (journal_) {
+        feed_.pause();
+        engine_.flush();
+        journal_seq = journal_->lastSeq();
+        deliverEvents();
+    }
+    RecoveryPoint books;
+    engine_.recoveryPoint(books);
+    if (journal_) {
+        // Records up to the last rotation can go once a snapshot past them is on disk
+        if (snapshot_writer_->writtenSeq() >= rotated_seq_) {
+            if (journal_->rotate()) rotated_seq_ = journal_seq;
+            engine_.attachJournal(journal_->isOpen() ? journal_ : nullptr); // the new file needs the symbols
+        }
+        feed_.resume();
+    }
+
+    std::unordered_map<UserId, std::vector<Order>> orders_of;
+    for (const Order& order : books.resting) orders_of[order.account].push_back(order);
+    for (const auto& entry : orders_of) account(entry.first);
+    auto set = std::make_shared<SnapshotSet>();
+    for (SymbolId id = 0; id < engine_.symbolCount(); ++id) set->symbols.push_back(engine_.symbolName(id));
+    set->accounts.reserve(accounts_.size());
+    for (auto& entry : accounts_) {
+        Account& owner = *entry.second;
+        auto orders = orders_of.find(entry.first);
+        std::vector<Order> resting = orders != orders_of.end() ? std::move(orders->second) : std::vector<Order>();
+        if (owner.dirty || !owner.captured || !sameOrders(owner.captured->orders, resting)) {
+            owner.captured = captureAccount(entry.first, owner.portfolio, std::move(resting));
+            if (owner.dirty) users_.setBalance(entry.first, owner.portfolio.cash());
+            owner.dirty = false;
+        }
+        set->accounts.push_back(owner.captured);
+    }
+    // Each capture logs a Set per changed account, so the user log is folded back into one
+    // record per user once those make up most of it
+    if (users_.logRecords() > 2 * users_.size() + 1024 && !users_.compact()) {
+        std::fprintf(stderr, "user log: compaction failed\n");
+    }
+    set->journal_seq = journal_seq;
+    set->next_order_id = books.next_order_id;
+    set->last_prices = std::move(books.last_prices);
+    snapshot_writer_->publish(std::move(set));
+    last_snapshot_ = std::chrono::steady_clock::now();
+}
@@ -0,0 +1,143 @@
+#ifndef SESSION_SERVER_H
+#define SESSION_SERVER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "../engine/trading_engine.h"
+#include "../portfolio/leaderboard.h"
+#include "../portfolio/portfolio.h"
+#include "../portfolio/portfolio_snapshot.h"
+#include "../user/user_profile.h"
+#include "market_feed.h"
+
+// Line protocol spoken over the socket, one command per line, replies are single lines:
+//   LOGIN <uid|email> <password>      -> OK <uid> <cash>           | ERR <reason>
+//   BUY|SELL <symbol> <qty> [limit]   -> ACK <order id>            | ERR <reason>
+//   CANCEL <symbol> <order id>        -> ACK <order id>
+//   PRICE <symbol>                    -> PRICE <symbol> <last>
+//   POS                               -> CASH <cash> <equity>, POS <symbol> <qty> <avg cost>..., END
+//   LEADERS [k]                       -> LEADER <rank> <uid> <equity>... (top k, default 10), END
+//   RANK                              -> RANK <rank> <of> <equity>
+//   QUIT
+// Engine results are pushed to every session logged into the account as they happen:
+//   FILL <order id> <symbol> <BUY|SELL> <qty> <price>, CANCELLED <order id>, REJECTED <order id>
+// A market buy holds back cash at the last price plus 1% and never fills above that; whatever
+// it can't fill within it is CANCELLED.
+//
+// One thread owns every socket and every account: it polls the connections, turns lines
+// into engine commands and routes the engine's events back by account. The engine's
+// shard workers and the market feed are the only other threads, and all sessions share them.
+class SessionServer {
+public:
+    SessionServer(TradingEngine& engine, UserStore& users, MarketFeed& feed);
+    ~SessionServer();
+
+    SessionServer(const SessionServer&) = delete;
+    SessionServer& operator=(const SessionServer&) = delete;
+
+    bool listenTcp(uint16_t port, bool loopback_only = true);
+    bool listenUnix(const std::string& path);
+
+    // Accounts survive restarts through a portfolio snapshot: every account in it is loaded
+    // now, and changed accounts are re-captured every interval. The user store's balances
+    // are brought up to date at the same time.
+    bool attachSnapshots(const std::string& path, std::chrono::milliseconds interval);
+    // Journals every engine command, so fills since the last snapshot survive a crash too.
+    // Call after attachSnapshots() and before the feed starts: the books restart from the
+    // snapshot's orders plus the journal after it, fills the snapshot doesn't hold are applied
+    // to their accounts, and orders still resting hold back their cash or shares again. The
+    // journal is rotated at snapshots once the one before is on disk, so it stays short.
+    bool attachJournal(Journal& journal, const std::string& path);
+
+    // Serves connections on the calling thread until stop()
+    void run();
+    // Safe to call from any thread or a signal handler
+    void stop();
+
+    size_t sessionCount() const { return session_count_.load(std::memory_order_relaxed); }
+    uint64_t ordersAccepted() const { return orders_accepted_.load(std::memory_order_relaxed); }
+    uint64_t fillsDelivered() const { return fills_delivered_.load(std::memory_order_relaxed); }
+    // Only safe to read from the thread running run(), or once it has returned
+    const Leaderboard& leaderboard() const { return ranking_.board(); }
+
+private:
+    struct Session {
+        int fd = -1;
+        std::string in;
+        std::string out;
+        size_t out_sent = 0; // bytes of out already written
+        UserId user = 0;
+        bool logged_in = false;
+        bool closing = false; // close once out is written
+    };
+
+    // Per-user trading state, shared by every session logged into the user. Open orders
+    // hold back their cash or shares so parallel sessions can't spend the same balance twice.
+    struct Account {
+        Portfolio portfolio;
+        std::vector<int> sessions; // fds
+        double reserved_cash = 0.0;
+        std::unordered_map<SymbolId, int64_t> reserved_shares;
+        bool dirty = false; // changed since the last snapshot
+        std::shared_ptr<const AccountState> captured;
+    };
+
+    struct OpenOrder {
+        UserId user;
+        SymbolId symbol;
+        Side side;
+        double reserve_price; // buys: cash held back per share
+        int64_t remaining;
+    };
+
+    void acceptFrom(int listener);
+    void readFrom(Session& session);
+    void writeTo(Session& session);
+    void close(int fd);
+    void handleLine(Session& session, char* line);
+    void handleLogin(Session& session, char* name, char* password);
+    void handleOrder(Session& session, Side side, char* symbol, char* quantity, char* limit);
+    Account& account(UserId user);
+    void release(Account& account, const OpenOrder& order, int64_t quantity);
+    void deliverEvents();
+    void markLeaderboard();
+    void saveSnapshot();
+    void reply(Session& session, const char* format, ...);
+
+    TradingEngine& engine_;
+    UserStore& users_;
+    MarketFeed& feed_;
+    std::vector<int> listeners_;
+    std::string unix_path_;
+    int wake_pipe_[2] = {-1, -1};
+    std::atomic<bool> stopping_{false};
+
+    std::unordered_map<int, Session> sessions_;
+    std::unordered_map<UserId, std::unique_ptr<Account>> accounts_;
+    std::unordered_map<uint64_t, OpenOrder> open_orders_;
+    std::vector<EngineEvent> events_;
+
+    // Ranked by equity; fills move one account, marks move the holders of a symbol
+    PortfolioRanking ranking_;
+    std::vector<double> marked_prices_; // by symbol id, as of the last markLeaderboard()
+    std::chrono::steady_clock::time_point last_mark_;
+
+    Journal* journal_ = nullptr;
+    RecoveryPoint recovery_; // the loaded snapshot's books
+    uint64_t rotated_seq_ = 0; // the retired journal ends here; rotate again once a snapshot covers it
+
+    std::unique_ptr<SnapshotWriter> snapshot_writer_;
+    std::chrono::milliseconds snapshot_interval_{0};
+    std::chrono::steady_clock::time_point last_snapshot_;
+
+    std::atomic<size_t> session_count_{0};
+    std::atomic<uint64_t> orders_accepted_{0};
+    std::atomic<uint64_t> fills_delivered_{0};
+};
+
+#endif // SESSION_SERVER_H
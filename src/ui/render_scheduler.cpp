@@ -0,0 +1,57 @@
+#include "render_scheduler.h"
+#include <algorithm>
+#include <imgui.h>
+#include <GLFW/glfw3.h>
+
+// How long input keeps the loop at full rate: long enough for hover delays and ImGui's
+// one-frame-late widgets (popups, resizes) to settle
+static constexpr double kSettleSeconds = 0.5;
+// Redraw rate of an active text field, for the caret blink
+static constexpr double kCaretBlinkSeconds = 0.5;
+static constexpr double kIconifiedInterval = 1.0;
+
+RenderScheduler::RenderScheduler(GLFWwindow* window, double background_fps)
+    : window_(window), background_interval_(background_fps > 0.0 ? 1.0 / background_fps : 0.25) {
+    glfwSetWindowUserPointer(window, this);
+    glfwSetCursorPosCallback(window, [](GLFWwindow* w, double, double) { onInput(w); });
+    glfwSetCursorEnterCallback(window, [](GLFWwindow* w, int) { onInput(w); });
+    glfwSetMouseButtonCallback(window, [](GLFWwindow* w, int, int, int) { onInput(w); });
+    glfwSetScrollCallback(window, [](GLFWwindow* w, double, double) { onInput(w); });
+    glfwSetKeyCallback(window, [](GLFWwindow* w, int, int, int, int) { onInput(w); });
+    glfwSetCharCallback(window, [](GLFWwindow* w, unsigned int) { onInput(w); });
+    glfwSetWindowFocusCallback(window, [](GLFWwindow* w, int) { onInput(w); });
+    glfwSetFramebufferSizeCallback(window, [](GLFWwindow* w, int, int) { onInput(w); });
+    glfwSetWindowRefreshCallback(window, [](GLFWwindow* w) { onInput(w); });
+    glfwSetWindowIconifyCallback(window, [](GLFWwindow* w, int) { onInput(w); });
+}
+
+void RenderScheduler::onInput(GLFWwindow* window) {
+    if (auto* scheduler = static_cast<RenderScheduler*>(glfwGetWindowUserPointer(window))) {
+        scheduler->active_until_ = glfwGetTime() + kSettleSeconds;
+    }
+}
+
+void RenderScheduler::requestFrame() {
+    if (!requested_.exchange(true)) glfwPostEmptyEvent();
+}
+
+double RenderScheduler::throttle() const {
+    if (glfwGetWindowAttrib(window_, GLFW_ICONIFIED)) return kIconifiedInterval;
+    return glfwGetWindowAttrib(window_, GLFW_FOCUSED) ? 0.0 : background_interval_;
+}
+
+void RenderScheduler::waitForFrame(double deadline) {
+    glfwPollEvents();
+    for (;;) {
+        double now = glfwGetTime();
+        if (now < active_until_ && !glfwGetWindowAttrib(window_, GLFW_ICONIFIED)) break;
+        double next = deadline;
+        if (ImGui::GetIO().WantTextInput) next = std::min(next, last_frame_ + kCaretBlinkSeconds);
+        if (requested_.load()) next = std::min(next, last_frame_ + throttle());
+        if (now >= next) break;
+        glfwWaitEventsTimeout(next - now);
+    }
+    requested_.store(false);
+    last_frame_ = glfwGetTime();
+    frames_++;
+}
@@ -0,0 +1,42 @@
+#ifndef RENDER_SCHEDULER_H
+#define RENDER_SCHEDULER_H
+
+#include <atomic>
+#include <cstdint>
+
+struct GLFWwindow;
+
+// Decides when the main loop draws, so a window nobody is touching costs next to nothing.
+// Input keeps it drawing at the vsync rate for a short settle period; requestFrame() (new
+// market data, engine events) asks for one more frame; otherwise it sleeps in
+// glfwWaitEventsTimeout until the caller's next timer. Requested frames are throttled to
+// background_fps while the window is unfocused and to once a second while it is iconified.
+class RenderScheduler {
+public:
+    // Install before ImGui_ImplGlfw_InitForOpenGL(window, true), which chains these callbacks
+    explicit RenderScheduler(GLFWwindow* window, double background_fps = 4.0);
+
+    RenderScheduler(const RenderScheduler&) = delete;
+    RenderScheduler& operator=(const RenderScheduler&) = delete;
+
+    // Replaces glfwPollEvents(): returns once a frame should be drawn, or at deadline
+    // (a glfwGetTime() value) so the caller's timers still run
+    void waitForFrame(double deadline);
+    // Thread-safe; wakes waitForFrame
+    void requestFrame();
+
+    uint64_t frames() const { return frames_; }
+
+private:
+    static void onInput(GLFWwindow* window);
+    double throttle() const;
+
+    GLFWwindow* window_;
+    double background_interval_;
+    double active_until_ = 0.0;
+    double last_frame_ = 0.0;
+    uint64_t frames_ = 0;
+    std::atomic<bool> requested_{true};
+};
+
+#endif // RENDER_SCHEDULER_H
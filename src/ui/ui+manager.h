@@ -5,4 +5,123 @@
 #ifndef UI_MANAGER_H
 #define UI_MANAGER_H
 
+#include <cstdint>
+#include <future>
+#include <string>
+#include <vector>
+#include <imgui.h>
+#include "../backtest/optimizer.h"
+#include "../engine/trading_engine.h"
+#include "../graph/graph_plotter.h"
+#include "../integration/watchlist.h"
+#include "../portfolio/allocation.h"
+#include "../portfolio/leaderboard.h"
+#include "../portfolio/portfolio.h"
+#include "../portfolio/risk.h"
+#include "../portfolio/trade_log.h"
+
+// Latency percentiles per order stage, with reset and dump-to-file buttons
+void DrawLatencyPanel(bool* open);
+
+// One row per open or previously traded position
+void DrawPositionsTable(const Portfolio& portfolio, const TradingEngine& engine);
+
+// Trade history in a fixed-height child; only the rows in view are formatted
+void DrawTradeLog(const TradeLog& log, const TradingEngine& engine, float height);
+
+// Historical and parametric VaR/CVaR, one row per confidence level, then each symbol's
+// share of the 99% VaR (component_var is indexed by symbol id)
+void DrawRiskPanel(const std::vector<RiskReport>& reports, const std::vector<double>& component_var,
+                   const TradingEngine& engine, bool* open);
+
+// Heatmap of a row-major symbol × symbol correlation matrix
+void DrawCorrelationPanel(const std::vector<double>& correlation, const TradingEngine& engine, bool* open);
+
+// Tax lot window state: the symbol whose open lots are listed and the quantity picked from
+// each (indexed by lot id) for specific identification
+struct TaxLotPanel {
+    SymbolId symbol = 0;
+    std::vector<TaxLot> open_lots;
+    std::vector<int> picked;
+    char status[128] = "";
+};
+
+// Lot matching method, realized gains per symbol and every lot closure, with CSV export.
+// With specific identification, lots of one symbol are picked here before a sell or cover.
+void DrawTaxLotPanel(TaxLotPanel& panel, TaxLotLedger& lots, const TradingEngine& engine, bool* open);
+
+// The whole board, best first, with only the visible rows fetched from the tree; the
+// highlighted account's row is labelled "You" and its rank shown above the table
+void DrawLeaderboardPanel(PortfolioRanking& ranking, AccountId highlight, bool* open);
+
+// Chart indicator toggles and periods; true when anything changed
+bool DrawIndicatorSettings(IndicatorSettings& settings);
+
+// Watchlist window state: display order (re-sorted only when the sort column changes) and
+// scratch for sparkline points, so drawing the visible rows allocates nothing
+struct WatchlistPanel {
+    char new_symbol[16] = "";
+    std::vector<size_t> order;
+    std::vector<ImVec2> points;
+};
+
+// Symbols with last price, change %, session volume and a sparkline. Only the rows in view
+// are formatted or drawn, so the list scales to thousands of symbols. Returns true when a
+// row was clicked; selected then holds its symbol.
+bool DrawWatchlistPanel(WatchlistPanel& panel, Watchlist& watchlist, std::string& selected);
+
+// Profiler window state: the frame under inspection (by number, so it stays put as new
+// frames arrive) and scratch for the per-zone totals
+struct ProfilerPanel {
+    struct Total {
+        const char* name;
+        uint64_t ns;
+        uint32_t calls;
+    };
+    bool follow = true; // inspect the newest frame
+    uint64_t frame = 0;
+    std::vector<Total> totals;
+    std::vector<uint32_t> lanes; // threads in the inspected frame, frame thread first
+    char status[128] = "";
+};
+
+// Frame times of the profiler's ring as bars (click one to inspect it), that frame's zones
+// as a flame graph with one lane per thread, its hottest zones, and Chrome trace export
+void DrawProfilerPanel(ProfilerPanel& panel, bool* open);
+
+// Optimizer window state. Sweeps run on a background thread so the UI keeps drawing.
+struct SweepPanel {
+    char candle_path[256] = ""; // binary (memory-mapped) or CSV; empty uses synthetic data
+    int fast[2] = {5, 50};
+    int slow[2] = {20, 200};
+    int step = 5;
+    std::vector<ParameterRange> ranges;
+    std::vector<SweepResult> results;
+    std::future<std::vector<SweepResult>> running;
+    std::string status;
+};
+
+// SMA crossover parameter sweep with a sortable results table and CSV export
+void DrawSweepPanel(SweepPanel& panel, bool* open);
+
+// Allocation window state. The solver works on a copy of the covariance matrix on a
+// background thread.
+struct AllocationPanel {
+    AllocationSettings settings;
+    std::future<AllocationResult> running;
+    AllocationResult result;
+    std::string status;
+    // Orders that would reach result.weights, rebuilt when a result arrives, after a fill, or
+    // once a second as prices move, rather than every frame
+    std::vector<RebalanceTrade> trades;
+    std::vector<int> trade_of; // index into trades per symbol id, -1 for none
+    uint64_t trades_fill_count = 0;
+    double trades_time = -1.0; // ImGui time of the last rebuild, -1 to force one
+};
+
+// Target weights from the mean-variance or risk-parity optimizer and the orders that would
+// get there; prices are the last close per symbol id
+void DrawAllocationPanel(AllocationPanel& panel, const CovarianceEngine& covariance, const Portfolio& portfolio,
+                         const std::vector<double>& prices, TradingEngine& engine, AccountId account, bool* open);
+
 #endif //UI_MANAGER_H
@@ -1,3 +1,997 @@
 //
 // Created by Shazaib malik on 13/05/2025.
 //
+
+#include "ui+manager.h"
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <imgui.h>
+#include <implot.h>
+#include "../backtest/strategies.h"
+#include "../engine/latency.h"
+#include "../integration/candle_series.h"
+#include "../util/profiler.h"
+
+static void TextLatency(uint64_t ns) {
+    if (ns < 10000) {
+        ImGui::Text("%llu ns", static_cast<unsigned long long>(ns));
+    } else if (ns < 10000000) {
+        ImGui::Text("%.1f us", ns / 1e3);
+    } else {
+        ImGui::Text("%.2f ms", ns / 1e6);
+    }
+}
+
+void DrawLatencyPanel(bool* open) {
+    if (!ImGui::Begin("Diagnostics", open)) {
+        ImGui::End();
+        return;
+    }
+
+    static char status[128] = "";
+    if (ImGui::Button("Reset")) {
+        latency::resetAll();
+        status[0] = '\0';
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Dump to file")) {
+        const char* path = "latency_dump.csv";
+        snprintf(status, sizeof(status), latency::dumpToFile(path) ? "Wrote %s" : "Failed to write %s", path);
+    }
+    if (status[0] != '\0') {
+        ImGui::SameLine();
+        ImGui::TextUnformatted(status);
+    }
+
+    if (ImGui::BeginTable("Latency", 6, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+        ImGui::TableSetupColumn("Stage");
+        ImGui::TableSetupColumn("Count");
+        ImGui::TableSetupColumn("p50");
+        ImGui::TableSetupColumn("p99");
+        ImGui::TableSetupColumn("p99.9");
+        ImGui::TableSetupColumn("Max");
+        ImGui::TableHeadersRow();
+        for (size_t s = 0; s < static_cast<size_t>(LatencyStage::Count); ++s) {
+            LatencyStage stage = static_cast<LatencyStage>(s);
+            const LatencyHistogram& h = latency::histogram(stage);
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(latency::stageName(stage));
+            ImGui::TableNextColumn();
+            ImGui::Text("%llu", static_cast<unsigned long long>(h.count()));
+            ImGui::TableNextColumn();
+            TextLatency(h.percentile(50.0));
+            ImGui::TableNextColumn();
+            TextLatency(h.percentile(99.0));
+            ImGui::TableNextColumn();
+            TextLatency(h.percentile(99.9));
+            ImGui::TableNextColumn();
+            TextLatency(h.max());
+        }
+        ImGui::EndTable();
+    }
+    ImGui::End();
+}
+
+// Stable per zone name across runs and translation units (the same literal may have several addresses)
+static ImU32 ZoneColor(const char* name) {
+    uint32_t hash = 2166136261u;
+    for (const char* c = name; *c; ++c) hash = (hash ^ static_cast<unsigned char>(*c)) * 16777619u;
+    ImVec4 color(0.0f, 0.0f, 0.0f, 1.0f);
+    ImGui::ColorConvertHSVtoRGB(static_cast<float>(hash % 360) / 360.0f, 0.45f, 0.8f, color.x, color.y, color.z);
+    return ImGui::GetColorU32(color);
+}
+
+// Frame durations, newest on the right; returns the age of a clicked bar, or -1
+static int DrawFrameBars(size_t selected, size_t count) {
+    const float height = 60.0f;
+    const float width = ImGui::GetContentRegionAvail().x;
+    const ImVec2 origin = ImGui::GetCursorScreenPos();
+    ImGui::InvisibleButton("##frames", ImVec2(width, height));
+    bool hovered = ImGui::IsItemHovered();
+    bool clicked = ImGui::IsItemClicked();
+    ImDrawList& draw = *ImGui::GetWindowDrawList();
+    draw.AddRectFilled(origin, ImVec2(origin.x + width, origin.y + height), ImGui::GetColorU32(ImGuiCol_FrameBg));
+
+    uint64_t longest = 1;
+    for (size_t age = 0; age < count; ++age) {
+        const profiler::Frame& frame = profiler::frame(age);
+        longest = std::max(longest, frame.end_ns - frame.start_ns);
+    }
+    // Fixed slots, so bars don't move sideways until the ring is full
+    const float bar = width / static_cast<float>(profiler::kFrames - 1);
+    const float right = origin.x + width;
+    const float scale = height / static_cast<float>(longest);
+    int picked = -1;
+    for (size_t age = 0; age < count; ++age) {
+        const profiler::Frame& frame = profiler::frame(age);
+        float x1 = right - static_cast<float>(age) * bar;
+        float x0 = x1 - std::max(bar - 1.0f, 1.0f);
+        float y0 = origin.y + height - static_cast<float>(frame.end_ns - frame.start_ns) * scale;
+        ImU32 color = age == selected ? IM_COL32(255, 200, 60, 255)
+                      : frame.end_ns - frame.start_ns > 16667000 ? IM_COL32(220, 80, 80, 255)
+                                                                  : IM_COL32(90, 160, 220, 255);
+        draw.AddRectFilled(ImVec2(x0, y0), ImVec2(x1, origin.y + height), color);
+        if (hovered && ImGui::GetIO().MousePos.x >= x1 - bar && ImGui::GetIO().MousePos.x < x1) {
+            ImGui::SetTooltip("Frame %llu: %.2f ms, %zu zones", static_cast<unsigned long long>(frame.number),
+                              (frame.end_ns - frame.start_ns) / 1e6, frame.zones.size());
+            if (clicked) picked = static_cast<int>(age);
+        }
+    }
+    // 60 fps budget
+    float budget_y = origin.y + height - 16667000.0f * scale;
+    if (budget_y > origin.y) draw.AddLine(ImVec2(origin.x, budget_y), ImVec2(right, budget_y), IM_COL32(255, 255, 255, 90));
+    ImGui::Text("Longest %.2f ms over %zu frames", longest / 1e6, count);
+    return picked;
+}
+
+// One lane per thread, one row per nesting depth, x spanning the frame
+static void DrawFlameGraph(ProfilerPanel& panel, const profiler::Frame& frame) {
+    panel.lanes.clear();
+    panel.lanes.push_back(profiler::frameThread());
+    uint32_t max_depth = 0;
+    for (const profiler::Zone& zone : frame.zones) {
+        if (std::find(panel.lanes.begin(), panel.lanes.end(), zone.thread) == panel.lanes.end()) {
+            panel.lanes.push_back(zone.thread);
+        }
+        max_depth = std::max(max_depth, zone.depth);
+    }
+    const float row = ImGui::GetTextLineHeight() + 4.0f;
+    const float lane_height = row * static_cast<float>(max_depth + 1) + 6.0f;
+    const float width = ImGui::GetContentRegionAvail().x;
+    const float height = lane_height * static_cast<float>(panel.lanes.size());
+    const ImVec2 origin = ImGui::GetCursorScreenPos();
+    ImGui::InvisibleButton("##flame", ImVec2(width, height));
+    bool hovered = ImGui::IsItemHovered();
+    const ImVec2 mouse = ImGui::GetIO().MousePos;
+    ImDrawList& draw = *ImGui::GetWindowDrawList();
+    draw.PushClipRect(origin, ImVec2(origin.x + width, origin.y + height), true);
+
+    const double span = static_cast<double>(std::max<uint64_t>(frame.end_ns - frame.start_ns, 1));
+    for (const profiler::Zone& zone : frame.zones) {
+        size_t lane = static_cast<size_t>(std::find(panel.lanes.begin(), panel.lanes.end(), zone.thread) - panel.lanes.begin());
+        // Zones from other threads can start before the frame
+        uint64_t start = std::max(zone.start_ns, frame.start_ns);
+        uint64_t end = std::max(zone.end_ns, start);
+        float x0 = origin.x + static_cast<float>((start - frame.start_ns) / span) * width;
+        float x1 = std::max(origin.x + static_cast<float>((end - frame.start_ns) / span) * width, x0 + 1.0f);
+        float y0 = origin.y + lane_height * static_cast<float>(lane) + row * static_cast<float>(zone.depth);
+        float y1 = y0 + row - 1.0f;
+        draw.AddRectFilled(ImVec2(x0, y0), ImVec2(x1, y1), ZoneColor(zone.name));
+        if (x1 - x0 > ImGui::CalcTextSize(zone.name).x + 4.0f) {
+            draw.AddText(ImVec2(x0 + 2.0f, y0 + 2.0f), IM_COL32(0, 0, 0, 255), zone.name);
+        }
+        if (hovered && mouse.x >= x0 && mouse.x < x1 && mouse.y >= y0 && mouse.y < y1) {
+            ImGui::SetTooltip("%s: %.3f ms (thread %u)", zone.name, (zone.end_ns - zone.start_ns) / 1e6, zone.thread);
+        }
+    }
+    for (size_t lane = 1; lane < panel.lanes.size(); ++lane) {
+        float y = origin.y + lane_height * static_cast<float>(lane) - 3.0f;
+        draw.AddLine(ImVec2(origin.x, y), ImVec2(origin.x + width, y), ImGui::GetColorU32(ImGuiCol_Separator));
+    }
+    draw.PopClipRect();
+}
+
+void DrawProfilerPanel(ProfilerPanel& panel, bool* open) {
+    if (!ImGui::Begin("Profiler", open)) {
+        ImGui::End();
+        return;
+    }
+    bool recording = profiler::enabled();
+    if (ImGui::Checkbox("Record", &recording)) profiler::setEnabled(recording);
+    ImGui::SameLine();
+    ImGui::Checkbox("Follow newest", &panel.follow);
+    ImGui::SameLine();
+    if (ImGui::Button("Export trace")) {
+        const char* path = "profile_trace.json";
+        snprintf(panel.status, sizeof(panel.status), profiler::exportChromeTrace(path) ? "Wrote %s" : "Failed to write %s",
+                 path);
+    }
+    if (panel.status[0] != '\0') {
+        ImGui::SameLine();
+        ImGui::TextUnformatted(panel.status);
+    }
+
+    size_t count = profiler::frameCount();
+    if (count == 0) {
+        ImGui::TextUnformatted("No frames recorded yet");
+        ImGui::End();
+        return;
+    }
+    // Back to the newest frame once the inspected one has left the ring
+    size_t selected = 0;
+    if (!panel.follow) {
+        while (selected < count && profiler::frame(selected).number != panel.frame) ++selected;
+        if (selected == count) {
+            panel.follow = true;
+            selected = 0;
+        }
+    }
+    int picked = DrawFrameBars(selected, count);
+    if (picked >= 0) {
+        selected = static_cast<size_t>(picked);
+        panel.follow = false;
+    }
+    const profiler::Frame& frame = profiler::frame(selected);
+    panel.frame = frame.number;
+
+    ImGui::Separator();
+    ImGui::Text("Frame %llu: %.3f ms, %zu zones", static_cast<unsigned long long>(frame.number),
+                (frame.end_ns - frame.start_ns) / 1e6, frame.zones.size());
+    if (frame.dropped > 0) {
+        ImGui::SameLine();
+        ImGui::TextColored(ImVec4(0.9f, 0.6f, 0.2f, 1.0f), "(%u dropped)", frame.dropped);
+    }
+    DrawFlameGraph(panel, frame);
+
+    // Inclusive time per zone name, longest first
+    panel.totals.clear();
+    for (const profiler::Zone& zone : frame.zones) {
+        auto it = std::find_if(panel.totals.begin(), panel.totals.end(), [&zone](const ProfilerPanel::Total& total) {
+            return total.name == zone.name || std::strcmp(total.name, zone.name) == 0;
+        });
+        if (it == panel.totals.end()) it = panel.totals.insert(panel.totals.end(), {zone.name, 0, 0});
+        it->ns += zone.end_ns - zone.start_ns;
+        it->calls++;
+    }
+    std::sort(panel.totals.begin(), panel.totals.end(),
+              [](const ProfilerPanel::Total& a, const ProfilerPanel::Total& b) { return a.ns > b.ns; });
+    if (ImGui::BeginTable("Zones", 3, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+        ImGui::TableSetupColumn("Zone");
+        ImGui::TableSetupColumn("Calls");
+        ImGui::TableSetupColumn("Total");
+        ImGui::TableHeadersRow();
+        for (const ProfilerPanel::Total& total : panel.totals) {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(total.name);
+            ImGui::TableNextColumn();
+            ImGui::Text("%u", total.calls);
+            ImGui::TableNextColumn();
+            TextLatency(total.ns);
+        }
+        ImGui::EndTable();
+    }
+    ImGui::End();
+}
+
+void DrawPositionsTable(const Portfolio& portfolio, const TradingEngine& engine) {
+    const std::vector<Position>& positions = portfolio.positions();
+    if (positions.empty()) return;
+    ImGuiTableFlags flags = ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY;
+    float height = ImGui::GetTextLineHeightWithSpacing() * static_cast<float>(std::min<size_t>(positions.size(), 8) + 1);
+    if (!ImGui::BeginTable("Positions", 6, flags, ImVec2(0, height + 4.0f))) return;
+    ImGui::TableSetupScrollFreeze(0, 1);
+    ImGui::TableSetupColumn("Symbol");
+    ImGui::TableSetupColumn("Qty");
+    ImGui::TableSetupColumn("Avg Cost");
+    ImGui::TableSetupColumn("Last");
+    ImGui::TableSetupColumn("Unrealized");
+    ImGui::TableSetupColumn("Realized");
+    ImGui::TableHeadersRow();
+
+    ImGuiListClipper clipper;
+    clipper.Begin(static_cast<int>(positions.size()));
+    while (clipper.Step()) {
+        for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row) {
+            const Position& p = positions[static_cast<size_t>(row)];
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(engine.symbolName(p.symbol).c_str());
+            ImGui::TableNextColumn();
+            ImGui::Text("%lld", static_cast<long long>(p.quantity));
+            ImGui::TableNextColumn();
+            ImGui::Text("%.2f", p.avg_cost);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.2f", p.last_price);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.2f", p.unrealizedPnl());
+            ImGui::TableNextColumn();
+            ImGui::Text("%.2f", p.realized_pnl);
+        }
+    }
+    ImGui::EndTable();
+}
+
+void DrawTradeLog(const TradeLog& log, const TradingEngine& engine, float height) {
+    ImGui::BeginChild("Log", ImVec2(0, height), true);
+    bool at_bottom = ImGui::GetScrollY() >= ImGui::GetScrollMaxY();
+    char line[128];
+    ImGuiListClipper clipper;
+    clipper.Begin(static_cast<int>(log.size()));
+    while (clipper.Step()) {
+        for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row) {
+            TradeRecord record = log.at(static_cast<size_t>(row));
+            TradeLog::format(record, engine.symbolName(record.symbol), line, sizeof(line));
+            ImGui::TextUnformatted(line);
+        }
+    }
+    // Follow new trades unless the user has scrolled up to read older ones
+    if (at_bottom) ImGui::SetScrollHereY(1.0f);
+    ImGui::EndChild();
+}
+
+void DrawRiskPanel(const std::vector<RiskReport>& reports, const std::vector<double>& component_var,
+                   const TradingEngine& engine, bool* open) {
+    if (!ImGui::Begin("Risk", open)) {
+        ImGui::End();
+        return;
+    }
+    if (reports.empty() || reports.front().scenarios == 0) {
+        ImGui::TextUnformatted("Waiting for return history...");
+        ImGui::End();
+        return;
+    }
+    ImGui::Text("%zu scenarios, P&L mean $%.2f, stddev $%.2f", reports.front().scenarios, reports.front().mean_pnl,
+                reports.front().stddev_pnl);
+    if (ImGui::BeginTable("RiskTable", 5, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+        ImGui::TableSetupColumn("Confidence");
+        ImGui::TableSetupColumn("Hist VaR");
+        ImGui::TableSetupColumn("Hist CVaR");
+        ImGui::TableSetupColumn("Normal VaR");
+        ImGui::TableSetupColumn("Normal CVaR");
+        ImGui::TableHeadersRow();
+        for (const RiskReport& r : reports) {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::Text("%.1f%%", r.confidence * 100.0);
+            ImGui::TableNextColumn();
+            ImGui::Text("$%.2f", r.historical_var);
+            ImGui::TableNextColumn();
+            ImGui::Text("$%.2f", r.historical_cvar);
+            ImGui::TableNextColumn();
+            ImGui::Text("$%.2f", r.parametric_var);
+            ImGui::TableNextColumn();
+            ImGui::Text("$%.2f", r.parametric_cvar);
+        }
+        ImGui::EndTable();
+    }
+    if (!component_var.empty() && ImGui::BeginTable("ComponentVar", 2, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+        ImGui::TableSetupColumn("Symbol");
+        ImGui::TableSetupColumn("99% VaR contribution");
+        ImGui::TableHeadersRow();
+        for (size_t i = 0; i < component_var.size() && i < engine.symbolCount(); ++i) {
+            if (component_var[i] == 0.0) continue;
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(engine.symbolName(static_cast<SymbolId>(i)).c_str());
+            ImGui::TableNextColumn();
+            ImGui::Text("$%.2f", component_var[i]);
+        }
+        ImGui::EndTable();
+    }
+    ImGui::End();
+}
+
+void DrawCorrelationPanel(const std::vector<double>& correlation, const TradingEngine& engine, bool* open) {
+    if (!ImGui::Begin("Correlation", open)) {
+        ImGui::End();
+        return;
+    }
+    int n = static_cast<int>(std::lround(std::sqrt(static_cast<double>(correlation.size()))));
+    if (n < 2) {
+        ImGui::TextUnformatted("Needs return history for at least two symbols");
+        ImGui::End();
+        return;
+    }
+    // The heatmap draws row 0 at the top, so y ticks run the other way
+    std::vector<const char*> labels;
+    std::vector<double> x_ticks, y_ticks;
+    for (int i = 0; i < n; ++i) {
+        labels.push_back(engine.symbolName(static_cast<SymbolId>(i)).c_str());
+        x_ticks.push_back(i + 0.5);
+        y_ticks.push_back(n - i - 0.5);
+    }
+    // Printing values in every cell only helps while they are still legible
+    const char* cell_format = n <= 12 ? "%.2f" : nullptr;
+    ImPlot::PushColormap(ImPlotColormap_RdBu);
+    if (ImPlot::BeginPlot("##Correlation", ImVec2(-80, -1), ImPlotFlags_NoLegend | ImPlotFlags_NoMouseText)) {
+        ImPlot::SetupAxes(nullptr, nullptr, ImPlotAxisFlags_Lock | ImPlotAxisFlags_NoGridLines,
+                          ImPlotAxisFlags_Lock | ImPlotAxisFlags_NoGridLines);
+        ImPlot::SetupAxesLimits(0, n, 0, n, ImGuiCond_Always);
+        ImPlot::SetupAxisTicks(ImAxis_X1, x_ticks.data(), n, labels.data());
+        ImPlot::SetupAxisTicks(ImAxis_Y1, y_ticks.data(), n, labels.data());
+        ImPlot::PlotHeatmap("corr", correlation.data(), n, n, -1.0, 1.0, cell_format, ImPlotPoint(0, 0), ImPlotPoint(n, n));
+        ImPlot::EndPlot();
+    }
+    ImGui::SameLine();
+    ImPlot::ColormapScale("##CorrScale", -1.0, 1.0, ImVec2(60, -1));
+    ImPlot::PopColormap();
+    ImGui::End();
+}
+
+// Open lots of one symbol with a quantity to close from each; the picks become the
+// designation used by the next closing fills
+static void DrawLotPicker(TaxLotPanel& panel, TaxLotLedger& lots, const TradingEngine& engine) {
+    if (engine.symbolCount() == 0) return;
+    if (panel.symbol >= engine.symbolCount()) panel.symbol = 0;
+    if (ImGui::BeginCombo("Symbol", engine.symbolName(panel.symbol).c_str())) {
+        for (SymbolId id = 0; id < engine.symbolCount(); ++id) {
+            if (ImGui::Selectable(engine.symbolName(id).c_str(), id == panel.symbol)) panel.symbol = id;
+        }
+        ImGui::EndCombo();
+    }
+
+    panel.open_lots.clear();
+    lots.openLots(panel.symbol, panel.open_lots);
+    if (panel.open_lots.empty()) {
+        ImGui::TextDisabled("No open lots");
+        return;
+    }
+    ImGuiTableFlags flags = ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY;
+    if (ImGui::BeginTable("OpenLots", 5, flags, ImVec2(0, 160))) {
+        ImGui::TableSetupScrollFreeze(0, 1);
+        ImGui::TableSetupColumn("Lot");
+        ImGui::TableSetupColumn("Opened");
+        ImGui::TableSetupColumn("Open qty");
+        ImGui::TableSetupColumn("Basis");
+        ImGui::TableSetupColumn("Close first");
+        ImGui::TableHeadersRow();
+        ImGuiListClipper clipper;
+        clipper.Begin(static_cast<int>(panel.open_lots.size()));
+        while (clipper.Step()) {
+            for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row) {
+                const TaxLot& lot = panel.open_lots[static_cast<size_t>(row)];
+                if (lot.id >= panel.picked.size()) panel.picked.resize(lot.id + 1, 0);
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::Text("%llu", static_cast<unsigned long long>(lot.id));
+                ImGui::TableNextColumn();
+                time_t opened = static_cast<time_t>(lot.open_ns / 1000000000ull);
+                char date[32];
+                strftime(date, sizeof(date), "%Y-%m-%d %H:%M", localtime(&opened));
+                ImGui::TextUnformatted(date);
+                ImGui::TableNextColumn();
+                ImGui::Text("%lld %s", static_cast<long long>(lot.quantity), lot.side == Side::Buy ? "long" : "short");
+                ImGui::TableNextColumn();
+                ImGui::Text("%.2f", lot.price);
+                ImGui::TableNextColumn();
+                ImGui::PushID(static_cast<int>(lot.id));
+                ImGui::SetNextItemWidth(-FLT_MIN);
+                int& picked = panel.picked[lot.id];
+                if (ImGui::InputInt("##close", &picked)) {
+                    picked = static_cast<int>(std::max<int64_t>(0, std::min<int64_t>(picked, lot.quantity)));
+                }
+                ImGui::PopID();
+            }
+        }
+        ImGui::EndTable();
+    }
+
+    if (ImGui::Button("Close these lots first")) {
+        std::vector<std::pair<uint64_t, int64_t>> designation;
+        for (const TaxLot& lot : panel.open_lots) {
+            if (lot.id < panel.picked.size() && panel.picked[lot.id] > 0) {
+                designation.emplace_back(lot.id, panel.picked[lot.id]);
+                panel.picked[lot.id] = 0;
+            }
+        }
+        lots.designate(panel.symbol, std::move(designation));
+    }
+    const auto& designated = lots.designated(panel.symbol);
+    if (designated.empty()) {
+        ImGui::TextDisabled("Nothing designated: the next %s matches FIFO",
+                            panel.open_lots.front().side == Side::Buy ? "sell" : "cover");
+        return;
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Clear")) {
+        lots.designate(panel.symbol, {});
+        return;
+    }
+    ImGui::TextUnformatted("Next closing fills take:");
+    for (const auto& designation : designated) {
+        ImGui::SameLine();
+        ImGui::Text("#%llu x%lld", static_cast<unsigned long long>(designation.first),
+                    static_cast<long long>(designation.second));
+    }
+}
+
+void DrawTaxLotPanel(TaxLotPanel& panel, TaxLotLedger& lots, const TradingEngine& engine, bool* open) {
+    if (!ImGui::Begin("Tax Lots", open)) {
+        ImGui::End();
+        return;
+    }
+    int method = static_cast<int>(lots.method());
+    const char* methods[] = {lotMethodName(LotMethod::FIFO), lotMethodName(LotMethod::LIFO),
+                             lotMethodName(LotMethod::HIFO), lotMethodName(LotMethod::SpecificId)};
+    if (ImGui::Combo("Matching", &method, methods, IM_ARRAYSIZE(methods))) {
+        lots.setMethod(static_cast<LotMethod>(method));
+    }
+    if (lots.method() == LotMethod::SpecificId) DrawLotPicker(panel, lots, engine);
+    if (ImGui::Button("Export realized gains")) {
+        std::vector<std::string> names;
+        for (SymbolId id = 0; id < engine.symbolCount(); ++id) names.push_back(engine.symbolName(id));
+        const char* path = "realized_gains.csv";
+        snprintf(panel.status, sizeof(panel.status),
+                 writeRealizedGainsCsv(path, lots.realized(), names) ? "Wrote %s" : "Failed to write %s", path);
+    }
+    if (panel.status[0] != '\0') {
+        ImGui::SameLine();
+        ImGui::TextUnformatted(panel.status);
+    }
+
+    // Running totals kept by the ledger, so a frame costs one pass over the symbols
+    if (ImGui::BeginTable("GainSummary", 6, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+        ImGui::TableSetupColumn("Symbol");
+        ImGui::TableSetupColumn("Open lots");
+        ImGui::TableSetupColumn("Closed qty");
+        ImGui::TableSetupColumn("Proceeds");
+        ImGui::TableSetupColumn("Short term");
+        ImGui::TableSetupColumn("Long term");
+        ImGui::TableHeadersRow();
+        for (const GainSummary& s : lots.totals()) {
+            if (s.quantity == 0) continue;
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(engine.symbolName(s.symbol).c_str());
+            ImGui::TableNextColumn();
+            ImGui::Text("%zu", lots.openLotCount(s.symbol));
+            ImGui::TableNextColumn();
+            ImGui::Text("%lld", static_cast<long long>(s.quantity));
+            ImGui::TableNextColumn();
+            ImGui::Text("$%.2f", s.proceeds);
+            ImGui::TableNextColumn();
+            ImGui::Text("$%.2f", s.short_term);
+            ImGui::TableNextColumn();
+            ImGui::Text("$%.2f", s.long_term);
+        }
+        ImGui::EndTable();
+    }
+
+    const std::vector<RealizedGain>& realized = lots.realized();
+    ImGui::Text("%zu lot closures", realized.size());
+    ImGuiTableFlags flags = ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY;
+    if (ImGui::BeginTable("Realized", 5, flags, ImVec2(0, 200))) {
+        ImGui::TableSetupScrollFreeze(0, 1);
+        ImGui::TableSetupColumn("Lot");
+        ImGui::TableSetupColumn("Symbol");
+        ImGui::TableSetupColumn("Qty");
+        ImGui::TableSetupColumn("Basis");
+        ImGui::TableSetupColumn("Gain");
+        ImGui::TableHeadersRow();
+        ImGuiListClipper clipper;
+        clipper.Begin(static_cast<int>(realized.size()));
+        while (clipper.Step()) {
+            for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row) {
+                const RealizedGain& g = realized[static_cast<size_t>(row)];
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::Text("%llu", static_cast<unsigned long long>(g.lot_id));
+                ImGui::TableNextColumn();
+                ImGui::TextUnformatted(engine.symbolName(g.symbol).c_str());
+                ImGui::TableNextColumn();
+                ImGui::Text("%lld", static_cast<long long>(g.quantity));
+                ImGui::TableNextColumn();
+                ImGui::Text("%.2f", g.open_price);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.2f", g.gain());
+            }
+        }
+        ImGui::EndTable();
+    }
+    ImGui::End();
+}
+
+void DrawLeaderboardPanel(PortfolioRanking& ranking, AccountId highlight, bool* open) {
+    if (!ImGui::Begin("Leaderboard", open)) {
+        ImGui::End();
+        return;
+    }
+    int metric = static_cast<int>(ranking.metric());
+    const char* metrics[] = {"Equity", "Return"};
+    if (ImGui::Combo("Rank by", &metric, metrics, IM_ARRAYSIZE(metrics))) {
+        ranking.setMetric(static_cast<LeaderboardMetric>(metric));
+    }
+    const Leaderboard& board = ranking.board();
+    bool by_return = ranking.metric() == LeaderboardMetric::Return;
+    size_t own_rank = board.rank(highlight);
+    if (own_rank != Leaderboard::npos) {
+        ImGui::Text("Your rank: %zu of %zu", own_rank + 1, board.size());
+    } else {
+        ImGui::Text("%zu accounts", board.size());
+    }
+
+    ImGuiTableFlags flags = ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY;
+    if (ImGui::BeginTable("Leaders", 3, flags, ImVec2(0, 300))) {
+        ImGui::TableSetupScrollFreeze(0, 1);
+        ImGui::TableSetupColumn("Rank");
+        ImGui::TableSetupColumn("Account");
+        ImGui::TableSetupColumn(by_return ? "Return" : "Equity");
+        ImGui::TableHeadersRow();
+        std::vector<Leaderboard::Entry> rows;
+        ImGuiListClipper clipper;
+        clipper.Begin(static_cast<int>(board.size()));
+        while (clipper.Step()) {
+            board.range(static_cast<size_t>(clipper.DisplayStart),
+                        static_cast<size_t>(clipper.DisplayEnd - clipper.DisplayStart), rows);
+            for (size_t i = 0; i < rows.size(); ++i) {
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::Text("%zu", static_cast<size_t>(clipper.DisplayStart) + i + 1);
+                ImGui::TableNextColumn();
+                if (rows[i].account == highlight) {
+                    ImGui::TextUnformatted("You");
+                } else {
+                    ImGui::Text("Account %u", rows[i].account);
+                }
+                ImGui::TableNextColumn();
+                if (by_return) {
+                    ImGui::Text("%+.2f%%", rows[i].score * 100.0);
+                } else {
+                    ImGui::Text("$%.2f", rows[i].score);
+                }
+            }
+        }
+        ImGui::EndTable();
+    }
+    ImGui::End();
+}
+
+static bool PeriodInput(const char* label, int* period) {
+    ImGui::SameLine();
+    ImGui::SetNextItemWidth(80.0f);
+    if (!ImGui::InputInt(label, period)) return false;
+    *period = std::max(1, std::min(*period, 1000));
+    return true;
+}
+
+bool DrawIndicatorSettings(IndicatorSettings& settings) {
+    bool changed = false;
+    changed |= ImGui::Checkbox("SMA", &settings.sma);
+    changed |= PeriodInput("##sma", &settings.sma_period);
+    ImGui::SameLine();
+    changed |= ImGui::Checkbox("EMA", &settings.ema);
+    changed |= PeriodInput("##ema", &settings.ema_period);
+    ImGui::SameLine();
+    changed |= ImGui::Checkbox("Bollinger", &settings.bollinger);
+    changed |= PeriodInput("##bollinger", &settings.bollinger_period);
+    changed |= ImGui::Checkbox("RSI", &settings.rsi);
+    changed |= PeriodInput("##rsi", &settings.rsi_period);
+    ImGui::SameLine();
+    changed |= ImGui::Checkbox("MACD 12/26/9", &settings.macd);
+    return changed;
+}
+
+static void SortWatchlist(std::vector<size_t>& order, const Watchlist& watchlist, const ImGuiTableSortSpecs* specs) {
+    if (specs->SpecsCount == 0) return;
+    const ImGuiTableColumnSortSpecs& spec = specs->Specs[0];
+    bool ascending = spec.SortDirection == ImGuiSortDirection_Ascending;
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        const Watchlist::Row& x = watchlist.row(a);
+        const Watchlist::Row& y = watchlist.row(b);
+        switch (spec.ColumnIndex) {
+            case 0: return ascending ? x.symbol < y.symbol : x.symbol > y.symbol;
+            case 1: return ascending ? x.last < y.last : x.last > y.last;
+            case 2: return ascending ? x.change_pct < y.change_pct : x.change_pct > y.change_pct;
+            default: return ascending ? x.volume < y.volume : x.volume > y.volume;
+        }
+    });
+}
+
+static void DrawSparkline(const Watchlist::Row& row, std::vector<ImVec2>& points) {
+    ImVec2 origin = ImGui::GetCursorScreenPos();
+    ImVec2 size(ImGui::GetContentRegionAvail().x, ImGui::GetTextLineHeight());
+    ImGui::Dummy(size);
+    if (row.spark.size() < 2 || !ImGui::IsItemVisible()) return;
+    float span = row.spark_max - row.spark_min;
+    float scale = span > 0.0f ? size.y / span : 0.0f;
+    float step = size.x / static_cast<float>(row.spark.size() - 1);
+    points.resize(row.spark.size());
+    for (size_t i = 0; i < row.spark.size(); ++i) {
+        float y = span > 0.0f ? (row.spark_max - row.spark[i]) * scale : size.y * 0.5f;
+        points[i] = ImVec2(origin.x + step * static_cast<float>(i), origin.y + y);
+    }
+    ImU32 color = row.spark.back() >= row.spark.front() ? IM_COL32(0, 200, 0, 255) : IM_COL32(220, 50, 50, 255);
+    ImGui::GetWindowDrawList()->AddPolyline(points.data(), static_cast<int>(points.size()), color, ImDrawFlags_None, 1.0f);
+}
+
+bool DrawWatchlistPanel(WatchlistPanel& panel, Watchlist& watchlist, std::string& selected) {
+    PROFILE_SCOPE("DrawWatchlistPanel");
+    bool clicked = false;
+    if (!ImGui::Begin("Watchlist")) {
+        ImGui::End();
+        return false;
+    }
+    ImGui::SetNextItemWidth(100.0f);
+    bool entered = ImGui::InputText("##symbol", panel.new_symbol, sizeof(panel.new_symbol),
+                                    ImGuiInputTextFlags_EnterReturnsTrue | ImGuiInputTextFlags_CharsUppercase);
+    ImGui::SameLine();
+    if ((ImGui::Button("Add") || entered) && panel.new_symbol[0] != '\0') {
+        watchlist.add(panel.new_symbol);
+        panel.new_symbol[0] = '\0';
+    }
+    ImGui::SameLine();
+    ImGui::Text("%zu symbols", watchlist.size());
+
+    bool grown = panel.order.size() != watchlist.size();
+    for (size_t i = panel.order.size(); i < watchlist.size(); ++i) panel.order.push_back(i);
+
+    ImGuiTableFlags flags = ImGuiTableFlags_Sortable | ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg |
+                            ImGuiTableFlags_ScrollY | ImGuiTableFlags_Resizable;
+    if (ImGui::BeginTable("Watchlist", 5, flags, ImVec2(0, 400))) {
+        ImGui::TableSetupScrollFreeze(0, 1);
+        ImGui::TableSetupColumn("Symbol");
+        ImGui::TableSetupColumn("Last");
+        ImGui::TableSetupColumn("Change %");
+        ImGui::TableSetupColumn("Volume");
+        ImGui::TableSetupColumn("Trend", ImGuiTableColumnFlags_NoSort | ImGuiTableColumnFlags_WidthFixed, 120.0f);
+        ImGui::TableHeadersRow();
+        if (ImGuiTableSortSpecs* specs = ImGui::TableGetSortSpecs()) {
+            if (specs->SpecsDirty || grown) {
+                SortWatchlist(panel.order, watchlist, specs);
+                specs->SpecsDirty = false;
+            }
+        }
+
+        ImGuiListClipper clipper;
+        clipper.Begin(static_cast<int>(panel.order.size()));
+        while (clipper.Step()) {
+            for (int line = clipper.DisplayStart; line < clipper.DisplayEnd; ++line) {
+                const Watchlist::Row& row = watchlist.row(panel.order[static_cast<size_t>(line)]);
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                if (ImGui::Selectable(row.symbol.c_str(), row.symbol == selected, ImGuiSelectableFlags_SpanAllColumns) &&
+                    row.symbol != selected) {
+                    selected = row.symbol;
+                    clicked = true;
+                }
+                if (row.last_time < 0.0) {
+                    ImGui::TableNextColumn();
+                    ImGui::TextDisabled("-");
+                    continue;
+                }
+                ImGui::TableNextColumn();
+                ImGui::Text("%.2f", row.last);
+                ImGui::TableNextColumn();
+                ImGui::TextColored(row.change_pct >= 0.0 ? ImVec4(0.0f, 0.8f, 0.0f, 1.0f) : ImVec4(0.9f, 0.2f, 0.2f, 1.0f),
+                                   "%+.2f", row.change_pct);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.0f", row.volume);
+                ImGui::TableNextColumn();
+                DrawSparkline(row, panel.points);
+            }
+        }
+        ImGui::EndTable();
+    }
+    ImGui::End();
+    return clicked;
+}
+
+static std::vector<SweepResult> RunSweep(std::string path, std::vector<ParameterRange> ranges) {
+    CandleSeries owned;
+    MappedCandles mapped;
+    CandleView candles;
+    if (path.empty()) {
+        owned = syntheticCandles(1000000);
+        candles = owned.view();
+    } else if (mapped.open(path)) {
+        candles = mapped.view();
+    } else if (loadCandlesCsv(path, owned)) {
+        candles = owned.view();
+    } else {
+        return {};
+    }
+
+    StrategyFactory factory = [](const std::vector<double>& p) -> std::unique_ptr<Strategy> {
+        if (p[0] >= p[1]) return nullptr;
+        return makeStrategy<SmaCrossover>(static_cast<size_t>(p[0]), static_cast<size_t>(p[1]));
+    };
+    WorkStealingPool pool;
+    return runSweep(candles, 0, candles.size(), expandGrid(ranges), factory, Backtester(), Objective::Sharpe, pool);
+}
+
+static void SortSweepResults(std::vector<SweepResult>& results, const ImGuiTableSortSpecs* specs, size_t param_count) {
+    if (specs->SpecsCount == 0) return;
+    const ImGuiTableColumnSortSpecs& spec = specs->Specs[0];
+    auto key = [&](const SweepResult& r) -> double {
+        size_t column = static_cast<size_t>(spec.ColumnIndex);
+        if (column < param_count) return r.params[column];
+        switch (column - param_count) {
+            case 0: return r.stats.sharpe;
+            case 1: return r.stats.total_return;
+            case 2: return r.stats.max_drawdown;
+            default: return static_cast<double>(r.stats.fills);
+        }
+    };
+    bool ascending = spec.SortDirection == ImGuiSortDirection_Ascending;
+    std::stable_sort(results.begin(), results.end(), [&](const SweepResult& a, const SweepResult& b) {
+        return ascending ? key(a) < key(b) : key(a) > key(b);
+    });
+}
+
+void DrawSweepPanel(SweepPanel& panel, bool* open) {
+    if (!ImGui::Begin("Optimizer", open)) {
+        ImGui::End();
+        return;
+    }
+
+    bool busy = panel.running.valid();
+    if (busy && panel.running.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+        panel.results = panel.running.get();
+        panel.status = panel.results.empty() ? "No results (could not load candles?)"
+                                             : std::to_string(panel.results.size()) + " runs finished";
+        busy = false;
+    }
+
+    ImGui::InputText("Candles (.bin/.csv)", panel.candle_path, sizeof(panel.candle_path));
+    ImGui::InputInt2("Fast SMA min/max", panel.fast);
+    ImGui::InputInt2("Slow SMA min/max", panel.slow);
+    ImGui::InputInt("Step", &panel.step);
+    panel.step = std::max(panel.step, 1);
+
+    ImGui::BeginDisabled(busy);
+    if (ImGui::Button("Run sweep")) {
+        panel.ranges = {{"fast", static_cast<double>(panel.fast[0]), static_cast<double>(panel.fast[1]), static_cast<double>(panel.step)},
+                        {"slow", static_cast<double>(panel.slow[0]), static_cast<double>(panel.slow[1]), static_cast<double>(panel.step)}};
+        panel.running = std::async(std::launch::async, RunSweep, std::string(panel.candle_path), panel.ranges);
+        panel.status = "Running...";
+    }
+    ImGui::EndDisabled();
+    ImGui::SameLine();
+    ImGui::BeginDisabled(panel.results.empty());
+    if (ImGui::Button("Export CSV")) {
+        panel.status = writeSweepCsv("sweep_results.csv", panel.ranges, panel.results) ? "Wrote sweep_results.csv"
+                                                                                        : "Failed to write sweep_results.csv";
+    }
+    ImGui::EndDisabled();
+    ImGui::SameLine();
+    ImGui::TextUnformatted(panel.status.c_str());
+
+    size_t param_count = panel.ranges.size();
+    int columns = static_cast<int>(param_count) + 4;
+    ImGuiTableFlags flags = ImGuiTableFlags_Sortable | ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg |
+                            ImGuiTableFlags_ScrollY;
+    if (!panel.results.empty() && ImGui::BeginTable("SweepResults", columns, flags, ImVec2(0, 300))) {
+        ImGui::TableSetupScrollFreeze(0, 1);
+        for (const ParameterRange& range : panel.ranges) ImGui::TableSetupColumn(range.name.c_str());
+        ImGui::TableSetupColumn("Sharpe", ImGuiTableColumnFlags_DefaultSort | ImGuiTableColumnFlags_PreferSortDescending);
+        ImGui::TableSetupColumn("Return %");
+        ImGui::TableSetupColumn("Max DD %");
+        ImGui::TableSetupColumn("Fills");
+        ImGui::TableHeadersRow();
+
+        if (ImGuiTableSortSpecs* specs = ImGui::TableGetSortSpecs()) {
+            if (specs->SpecsDirty) {
+                SortSweepResults(panel.results, specs, param_count);
+                specs->SpecsDirty = false;
+            }
+        }
+
+        ImGuiListClipper clipper;
+        clipper.Begin(static_cast<int>(panel.results.size()));
+        while (clipper.Step()) {
+            for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row) {
+                const SweepResult& r = panel.results[static_cast<size_t>(row)];
+                ImGui::TableNextRow();
+                for (double p : r.params) {
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%g", p);
+                }
+                ImGui::TableNextColumn();
+                ImGui::Text("%.2f", r.stats.sharpe);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.2f", r.stats.total_return * 100.0);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.2f", r.stats.max_drawdown * 100.0);
+                ImGui::TableNextColumn();
+                ImGui::Text("%zu", r.stats.fills);
+            }
+        }
+        ImGui::EndTable();
+    }
+    ImGui::End();
+}
+
+void DrawAllocationPanel(AllocationPanel& panel, const CovarianceEngine& covariance, const Portfolio& portfolio,
+                         const std::vector<double>& prices, TradingEngine& engine, AccountId account, bool* open) {
+    if (!ImGui::Begin("Allocation", open)) {
+        ImGui::End();
+        return;
+    }
+
+    bool busy = panel.running.valid();
+    if (busy && panel.running.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+        panel.result = panel.running.get();
+        char line[128];
+        snprintf(line, sizeof(line), "%s in %.1f ms, %d iterations", panel.result.converged ? "Solved" : "Stopped",
+                 panel.result.elapsed_seconds * 1e3, panel.result.iterations);
+        panel.status = line;
+        panel.trades_time = -1.0;
+        busy = false;
+    }
+
+    int method = static_cast<int>(panel.settings.method);
+    const char* methods[] = {allocationMethodName(AllocationMethod::MeanVariance),
+                             allocationMethodName(AllocationMethod::RiskParity)};
+    if (ImGui::Combo("Method", &method, methods, IM_ARRAYSIZE(methods))) {
+        panel.settings.method = static_cast<AllocationMethod>(method);
+    }
+    if (panel.settings.method == AllocationMethod::MeanVariance) {
+        ImGui::InputDouble("Risk aversion", &panel.settings.risk_aversion, 1.0, 10.0, "%.1f");
+        panel.settings.risk_aversion = std::max(panel.settings.risk_aversion, 0.0);
+        float cap = static_cast<float>(panel.settings.max_weight * 100.0);
+        if (ImGui::SliderFloat("Max weight %", &cap, 1.0f, 100.0f, "%.0f")) panel.settings.max_weight = cap / 100.0;
+    }
+
+    ImGui::BeginDisabled(busy || covariance.observations() < 2);
+    if (ImGui::Button("Optimize")) {
+        panel.running = std::async(std::launch::async, optimizeAllocation, allocationProblem(covariance), panel.settings);
+        panel.status = "Solving...";
+    }
+    ImGui::EndDisabled();
+    ImGui::SameLine();
+    ImGui::TextUnformatted(covariance.observations() < 2 ? "Waiting for return history..." : panel.status.c_str());
+
+    const std::vector<double>& weights = panel.result.weights;
+    if (weights.empty()) {
+        ImGui::End();
+        return;
+    }
+    ImGui::Text("Expected return %.4f%% per bar, volatility %.4f%%", panel.result.expected_return * 100.0,
+                panel.result.volatility * 100.0);
+
+    double now = ImGui::GetTime();
+    if (panel.trades_time < 0.0 || panel.trades_fill_count != portfolio.fillCount() || now - panel.trades_time >= 1.0) {
+        panel.trades = rebalanceTrades(portfolio, weights, prices);
+        // trades is much shorter than weights, so rows look theirs up through a per-symbol index
+        panel.trade_of.assign(weights.size(), -1);
+        for (size_t t = 0; t < panel.trades.size(); ++t) panel.trade_of[panel.trades[t].symbol] = static_cast<int>(t);
+        panel.trades_fill_count = portfolio.fillCount();
+        panel.trades_time = now;
+    }
+    const std::vector<RebalanceTrade>& trades = panel.trades;
+    ImGui::BeginDisabled(trades.empty());
+    if (ImGui::Button("Submit rebalance orders")) {
+        for (const RebalanceTrade& trade : trades) {
+            Order order;
+            order.account = account;
+            order.symbol = trade.symbol;
+            order.side = trade.side;
+            order.type = OrderType::Market;
+            order.quantity = trade.quantity;
+            engine.submitOrder(order);
+        }
+        panel.status = std::to_string(trades.size()) + " orders submitted";
+    }
+    ImGui::EndDisabled();
+
+    ImGuiTableFlags flags = ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY;
+    if (ImGui::BeginTable("Targets", 4, flags, ImVec2(0, 300))) {
+        ImGui::TableSetupScrollFreeze(0, 1);
+        ImGui::TableSetupColumn("Symbol");
+        ImGui::TableSetupColumn("Current %");
+        ImGui::TableSetupColumn("Target %");
+        ImGui::TableSetupColumn("Trade");
+        ImGui::TableHeadersRow();
+        double equity = portfolio.equity();
+        ImGuiListClipper clipper;
+        clipper.Begin(static_cast<int>(std::min(weights.size(), static_cast<size_t>(engine.symbolCount()))));
+        while (clipper.Step()) {
+            for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row) {
+                size_t i = static_cast<size_t>(row);
+                SymbolId symbol = static_cast<SymbolId>(i);
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::TextUnformatted(engine.symbolName(symbol).c_str());
+                ImGui::TableNextColumn();
+                double price = i < prices.size() ? prices[i] : 0.0;
+                ImGui::Text("%.2f", equity > 0.0 ? static_cast<double>(portfolio.quantity(symbol)) * price / equity * 100.0 : 0.0);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.2f", weights[i] * 100.0);
+                ImGui::TableNextColumn();
+                if (panel.trade_of[i] >= 0) {
+                    const RebalanceTrade& trade = trades[static_cast<size_t>(panel.trade_of[i])];
+                    ImGui::Text("%s %lld", trade.side == Side::Buy ? "Buy" : "Sell", static_cast<long long>(trade.quantity));
+                }
+            }
+        }
+        ImGui::EndTable();
+    }
+    ImGui::End();
+}
@@ -1,3 +1,364 @@
 //
 // Created by Shazaib malik on 13/05/2025.
 //
+
+#include "user_profile.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <unistd.h>
+#include <vector>
+
+UserStore::~UserStore() {
+    if (log_) std::fclose(log_);
+}
+
+// FNV-1a with a final avalanche, so both the shard bits and the slot bits are well mixed
+uint64_t UserStore::hashKey(const std::string& key) {
+    uint64_t hash = 1469598103934665603ull;
+    for (unsigned char c : key) {
+        hash ^= c;
+        hash *= 1099511628211ull;
+    }
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdull;
+    hash ^= hash >> 33;
+    return hash | 1; // never 0, which marks empty slots
+}
+
+void UserStore::indexReserve(Index& index, size_t entries) {
+    size_t capacity = 16;
+    while (capacity < entries * 2) capacity <<= 1;
+    if (capacity <= index.slots.size()) return;
+    std::vector<Slot> old;
+    old.swap(index.slots);
+    index.slots.assign(capacity, Slot{});
+    index.used = 0;
+    for (const Slot& slot : old) {
+        if (slot.hash != 0) indexInsert(index, slot.hash, slot.id);
+    }
+}
+
+void UserStore::indexInsert(Index& index, uint64_t hash, UserId id) {
+    if ((index.used + 1) * 2 > index.slots.size()) indexReserve(index, std::max<size_t>(index.used + 1, index.slots.size()));
+    size_t mask = index.slots.size() - 1;
+    size_t at = (hash >> kShardBits) & mask;
+    while (index.slots[at].hash != 0) at = (at + 1) & mask;
+    index.slots[at] = {hash, id};
+    index.used++;
+}
+
+UserStore::User::User(const std::string& uid_, const std::string& email_, uint64_t digest, double balance_)
+    : uid{}, email{}, password_digest(digest), balance(balance_) {
+    std::strncpy(uid, uid_.c_str(), sizeof(uid) - 1);
+    std::strncpy(email, email_.c_str(), sizeof(email) - 1);
+}
+
+void UserStore::reserve(size_t users) {
+    size_t per_shard = users / kShards + users / (kShards * 8) + 16; // some slack for uneven hashing
+    for (Shard& shard : shards_) {
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        indexReserve(shard.by_uid, per_shard);
+        indexReserve(shard.by_email, per_shard);
+    }
+}
+
+// Salted FNV-1a, so the store never keeps passwords in memory or in its log. This is not a
+// password hash fit for real credentials; the text file it imports is plaintext anyway.
+uint64_t UserStore::digest(const char* uid, const std::string& password) {
+    uint64_t hash = 1469598103934665603ull;
+    auto mix = [&](unsigned char c) {
+        hash ^= c;
+        hash *= 1099511628211ull;
+    };
+    for (const char* c = uid; *c; ++c) mix(static_cast<unsigned char>(*c));
+    mix(':');
+    for (unsigned char c : password) mix(c);
+    return hash;
+}
+
+bool UserStore::insert(const std::string& uid, const std::string& email, uint64_t password_digest, double balance,
+                       UserId* out, bool log) {
+    if (uid.empty() || uid.size() >= sizeof(UserLogRecord::uid) || email.size() >= sizeof(UserLogRecord::email)) {
+        return false;
+    }
+    std::lock_guard<std::mutex> create_lock(create_mutex_);
+    UserId existing;
+    if (find(uid, false, existing) || (!email.empty() && find(email, true, existing))) return false;
+
+    UserId id;
+    uint64_t uid_hash = hashKey(uid);
+    {
+        size_t s = uid_hash & (kShards - 1);
+        Shard& shard = shards_[s];
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        // The last local index would put kLocalUserId in reach, and one past it doesn't fit an id
+        if (shard.users.size() >= (size_t(kLocalUserId) >> kShardBits)) return false;
+        id = static_cast<UserId>(shard.users.size() << kShardBits | s);
+        shard.users.emplace_back(uid, email, password_digest, balance);
+        indexInsert(shard.by_uid, uid_hash, id);
+    }
+    if (!email.empty()) {
+        uint64_t email_hash = hashKey(email);
+        Shard& shard = shards_[email_hash & (kShards - 1)];
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        indexInsert(shard.by_email, email_hash, id);
+    }
+    count_.fetch_add(1, std::memory_order_relaxed);
+
+    if (log) {
+        UserLogRecord record{};
+        record.type = UserLogType::Create;
+        record.balance = balance;
+        record.password_digest = password_digest;
+        std::strncpy(record.uid, uid.c_str(), sizeof(record.uid) - 1);
+        std::strncpy(record.email, email.c_str(), sizeof(record.email) - 1);
+        append(record);
+    }
+    if (out) *out = id;
+    return true;
+}
+
+bool UserStore::create(const std::string& uid, const std::string& email, const std::string& password, double balance,
+                       UserId* out) {
+    return insert(uid, email, digest(uid.c_str(), password), balance, out, true);
+}
+
+bool UserStore::open(const std::string& log_path) {
+    if (log_) return false;
+    size_t records = 0;
+    FILE* file = std::fopen(log_path.c_str(), "rb");
+    if (file) {
+        std::fseek(file, 0, SEEK_END);
+        long file_size = std::ftell(file);
+        reserve(static_cast<size_t>(std::max(0L, file_size)) / sizeof(UserLogRecord));
+        std::fseek(file, 0, SEEK_SET);
+        // Shorter than the magic: a crash before it reached the disk, so the log starts over below
+        if (file_size < static_cast<long>(sizeof(kUserLogMagic))) {
+            std::fclose(file);
+            file = nullptr;
+        }
+    }
+    if (file) {
+        char magic[sizeof(kUserLogMagic)];
+        if (std::fread(magic, sizeof(magic), 1, file) != 1 || std::memcmp(magic, kUserLogMagic, sizeof(magic)) != 0) {
+            std::fclose(file);
+            return false;
+        }
+        std::vector<UserLogRecord> chunk(4096);
+        size_t read;
+        while ((read = std::fread(chunk.data(), sizeof(UserLogRecord), chunk.size(), file)) > 0) {
+            records += read;
+            for (size_t i = 0; i < read; ++i) {
+                const UserLogRecord& record = chunk[i];
+                std::string uid(record.uid, strnlen(record.uid, sizeof(record.uid)));
+                if (record.type == UserLogType::Create) {
+                    std::string email(record.email, strnlen(record.email, sizeof(record.email)));
+                    insert(uid, email, record.password_digest, record.balance, nullptr, false);
+                } else if (UserId id; find(uid, false, id)) {
+                    withUser(id, [&](const User& user) {
+                        double current = user.balance.load(std::memory_order_relaxed);
+                        user.balance.store(record.type == UserLogType::Adjust ? current + record.balance : record.balance,
+                                           std::memory_order_relaxed);
+                    });
+                }
+            }
+        }
+        std::fclose(file);
+    }
+
+    log_ = std::fopen(log_path.c_str(), "ab");
+    if (!log_) return false;
+    log_path_ = log_path;
+    log_records_ = records;
+    std::fseek(log_, 0, SEEK_END);
+    long size = std::ftell(log_);
+    if (size < static_cast<long>(sizeof(kUserLogMagic))) {
+        // Flushed now: a log that lost its magic in a crash would be refused by every later open()
+        bool ok = (size == 0 || ftruncate(fileno(log_), 0) == 0) &&
+                  std::fwrite(kUserLogMagic, sizeof(kUserLogMagic), 1, log_) == 1 && std::fflush(log_) == 0;
+        if (!ok) {
+            std::fclose(log_);
+            log_ = nullptr;
+        }
+        return ok;
+    }
+    // A torn record from a crash would shift every later one, so cut back to a record boundary
+    long whole = static_cast<long>(sizeof(kUserLogMagic)) +
+                 (size - static_cast<long>(sizeof(kUserLogMagic))) / static_cast<long>(sizeof(UserLogRecord)) *
+                     static_cast<long>(sizeof(UserLogRecord));
+    if (whole != size) {
+        std::fclose(log_);
+        if (truncate(log_path.c_str(), whole) != 0) {
+            log_ = nullptr;
+            return false;
+        }
+        log_ = std::fopen(log_path.c_str(), "ab");
+    }
+    return log_ != nullptr;
+}
+
+size_t UserStore::importText(const std::string& path) {
+    std::ifstream in(path, std::ios::ate);
+    if (!in) return 0;
+    reserve(size() + static_cast<size_t>(in.tellg()) / 32); // rows are ~40 bytes, so this is an upper bound
+    in.seekg(0);
+    size_t added = 0;
+    std::string line;
+    while (std::getline(in, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        size_t a = line.find(',');
+        size_t b = a == std::string::npos ? a : line.find(',', a + 1);
+        size_t c = b == std::string::npos ? b : line.find(',', b + 1);
+        if (c == std::string::npos) continue;
+        double balance = std::strtod(line.c_str() + c + 1, nullptr);
+        if (create(line.substr(0, a), line.substr(a + 1, b - a - 1), line.substr(b + 1, c - b - 1), balance)) {
+            added++;
+        }
+    }
+    return added;
+}
+
+bool UserStore::find(const std::string& key, bool by_email, UserId& out, const std::string* password) const {
+    uint64_t hash = hashKey(key);
+    // Collect candidates under the index shard's lock, then verify each against the user's
+    // own shard; never two shard locks at once
+    UserId candidates[4];
+    size_t count = 0;
+    {
+        const Shard& shard = shards_[hash & (kShards - 1)];
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        const Index& index = by_email ? shard.by_email : shard.by_uid;
+        if (index.slots.empty()) return false;
+        size_t mask = index.slots.size() - 1;
+        for (size_t at = (hash >> kShardBits) & mask; index.slots[at].hash != 0; at = (at + 1) & mask) {
+            if (index.slots[at].hash == hash && count < 4) candidates[count++] = index.slots[at].id;
+        }
+    }
+    for (size_t i = 0; i < count; ++i) {
+        bool match = false;
+        withUser(candidates[i], [&](const User& user) {
+            match = key == (by_email ? user.email : user.uid) &&
+                    (!password || user.password_digest == digest(user.uid, *password));
+        });
+        if (match) {
+            out = candidates[i];
+            return true;
+        }
+    }
+    return false;
+}
+
+bool UserStore::findByUid(const std::string& uid, UserId& out) const {
+    return find(uid, false, out);
+}
+
+bool UserStore::findByEmail(const std::string& email, UserId& out) const {
+    return find(email, true, out);
+}
+
+bool UserStore::login(const std::string& name, const std::string& password, UserId& out) const {
+    return find(name, name.find('@') != std::string::npos, out, &password);
+}
+
+bool UserStore::profile(UserId id, UserProfile& out) const {
+    return withUser(id, [&](const User& user) {
+        out.id = id;
+        out.uid = user.uid;
+        out.email = user.email;
+        out.balance = user.balance.load(std::memory_order_relaxed);
+    });
+}
+
+double UserStore::balance(UserId id) const {
+    double value = 0.0;
+    withUser(id, [&](const User& user) { value = user.balance.load(std::memory_order_relaxed); });
+    return value;
+}
+
+bool UserStore::adjustBalance(UserId id, double delta, double* new_balance) {
+    bool ok = false;
+    double updated = 0.0;
+    withUser(id, [&](const User& user) {
+        // The shard lock only guards the deque; the balance itself is updated with a CAS
+        double current = user.balance.load(std::memory_order_relaxed);
+        do {
+            updated = current + delta;
+            if (updated < 0.0) return;
+        } while (!user.balance.compare_exchange_weak(current, updated, std::memory_order_relaxed));
+        ok = true;
+        logBalance(UserLogType::Adjust, user, delta);
+    });
+    if (ok && new_balance) *new_balance = updated;
+    return ok;
+}
+
+void UserStore::setBalance(UserId id, double balance) {
+    withUser(id, [&](const User& user) {
+        user.balance.store(balance, std::memory_order_relaxed);
+        logBalance(UserLogType::Set, user, balance);
+    });
+}
+
+void UserStore::logBalance(UserLogType type, const User& user, double amount) {
+    UserLogRecord record{};
+    record.type = type;
+    record.balance = amount;
+    std::memcpy(record.uid, user.uid, sizeof(record.uid));
+    append(record);
+}
+
+void UserStore::append(const UserLogRecord& record) {
+    std::lock_guard<std::mutex> lock(log_mutex_);
+    if (log_ && std::fwrite(&record, sizeof(record), 1, log_) == 1) log_records_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void UserStore::flush() {
+    std::lock_guard<std::mutex> lock(log_mutex_);
+    if (log_) std::fflush(log_);
+}
+
+bool UserStore::compact() {
+    std::lock_guard<std::mutex> create_lock(create_mutex_);
+    // A balance update holds its shard's lock from the CAS until it is logged. Holding every
+    // shard exclusively means each update is either in the snapshot and logged before it, or
+    // waits and is logged after it, never both. Shards before the log mutex, the order updates take them in.
+    std::unique_lock<std::shared_mutex> shard_locks[kShards];
+    for (size_t s = 0; s < kShards; ++s) shard_locks[s] = std::unique_lock<std::shared_mutex>(shards_[s].mutex);
+    std::lock_guard<std::mutex> lock(log_mutex_);
+    if (!log_) return false;
+    std::string temp = log_path_ + ".tmp";
+    FILE* out = std::fopen(temp.c_str(), "wb");
+    if (!out) return false;
+    bool ok = std::fwrite(kUserLogMagic, sizeof(kUserLogMagic), 1, out) == 1;
+
+    // Per-shard creation order is kept, so replay hands out the same ids again
+    size_t longest = 0;
+    for (const Shard& shard : shards_) longest = std::max(longest, shard.users.size());
+    for (size_t local = 0; local < longest && ok; ++local) {
+        for (size_t s = 0; s < kShards && ok; ++s) {
+            const Shard& shard = shards_[s];
+            if (local >= shard.users.size()) continue;
+            const User& user = shard.users[local];
+            UserLogRecord record{};
+            record.type = UserLogType::Create;
+            record.balance = user.balance.load(std::memory_order_relaxed);
+            record.password_digest = user.password_digest;
+            std::memcpy(record.uid, user.uid, sizeof(record.uid));
+            std::memcpy(record.email, user.email, sizeof(record.email));
+            ok = std::fwrite(&record, sizeof(record), 1, out) == 1;
+        }
+    }
+    // On disk before it replaces the log, or a crash could leave the rename pointing at nothing
+    ok = ok && std::fflush(out) == 0 && fsync(fileno(out)) == 0;
+    ok = std::fclose(out) == 0 && ok;
+    if (!ok || std::rename(temp.c_str(), log_path_.c_str()) != 0) {
+        std::remove(temp.c_str());
+        return false;
+    }
+    std::fclose(log_);
+    log_ = std::fopen(log_path_.c_str(), "ab");
+    log_records_ = count_.load(std::memory_order_relaxed);
+    return log_ != nullptr;
+}
@@ -5,4 +5,148 @@
 #ifndef USER_PROFILE_H
 #define USER_PROFILE_H
 
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <vector>
+
+using UserId = uint32_t; // local index << kShardBits | shard
+
+// Never issued by UserStore, so an account that lives outside the store (the desktop app's
+// own) can share a leaderboard or snapshot file with server users without colliding
+constexpr UserId kLocalUserId = UINT32_MAX;
+
+struct UserProfile {
+    UserId id = 0;
+    std::string uid;
+    std::string email;
+    double balance = 0.0;
+};
+
+// Fixed-size entry of the append-only user log. Creates carry the profile. Adjust records
+// carry a delta, so concurrent updates replay correctly in whatever order they were
+// logged; Set records carry an absolute balance.
+enum class UserLogType : uint8_t { Create, Adjust, Set };
+
+struct UserLogRecord {
+    UserLogType type;
+    uint8_t reserved[7];
+    double balance; // opening balance, delta or new balance, by type
+    uint64_t password_digest;
+    char uid[32];
+    char email[72];
+};
+
+constexpr char kUserLogMagic[8] = {'T', 'S', 'U', 'S', 'E', 'R', 'S', '1'};
+
+// Users are spread over shards by uid hash. Each shard has its own reader/writer lock, so
+// logins and balance reads on different users rarely touch the same cache line, and
+// balance updates are a CAS on the user's own atomic. The uid and email indexes are flat
+// open-addressing tables of (hash, id), so a lookup is one probe plus one user record.
+class UserStore {
+public:
+    UserStore() = default;
+    ~UserStore();
+
+    UserStore(const UserStore&) = delete;
+    UserStore& operator=(const UserStore&) = delete;
+
+    // Sizes the indexes up front so bulk loads don't rehash
+    void reserve(size_t users);
+
+    // Replays a user log, then appends every change to it from now on
+    bool open(const std::string& log_path);
+    // uid,email,password,balance rows; users whose uid already exists are skipped
+    size_t importText(const std::string& path);
+
+    bool create(const std::string& uid, const std::string& email, const std::string& password, double balance,
+                UserId* out = nullptr);
+
+    bool findByUid(const std::string& uid, UserId& out) const;
+    bool findByEmail(const std::string& email, UserId& out) const;
+    // Accepts either the uid or the email as the login name
+    bool login(const std::string& name, const std::string& password, UserId& out) const;
+
+    bool profile(UserId id, UserProfile& out) const;
+    double balance(UserId id) const;
+    // Fails without changing anything if the balance would go negative
+    bool adjustBalance(UserId id, double delta, double* new_balance = nullptr);
+    // Administrative reset; not ordered against adjustments racing with it
+    void setBalance(UserId id, double balance);
+
+    size_t size() const { return count_.load(std::memory_order_relaxed); }
+
+    void flush();
+    // Rewrites the log with one create per user at the current balance. Every other call
+    // waits while it runs.
+    bool compact();
+    // Records in the log, to decide when compact() is worth it
+    size_t logRecords() const { return log_records_.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr unsigned kShardBits = 6;
+    static constexpr size_t kShards = size_t(1) << kShardBits;
+
+    // Strings are stored inline so verifying a lookup doesn't chase another pointer
+    struct User {
+        User(const std::string& uid_, const std::string& email_, uint64_t digest, double balance_);
+        char uid[sizeof(UserLogRecord::uid)];
+        char email[sizeof(UserLogRecord::email)];
+        uint64_t password_digest;
+        mutable std::atomic<double> balance; // updated under the shard's shared lock
+    };
+
+    struct Slot {
+        uint64_t hash = 0; // 0 marks an empty slot
+        UserId id = 0;
+    };
+
+    struct Index {
+        std::vector<Slot> slots; // power-of-two size, at most half full
+        size_t used = 0;
+    };
+
+    struct Shard {
+        mutable std::shared_mutex mutex;
+        std::deque<User> users; // deque: growing it never moves existing users
+        Index by_uid;
+        Index by_email; // emails whose hash picks this shard; the users may live elsewhere
+    };
+
+    static uint64_t hashKey(const std::string& key);
+    static void indexInsert(Index& index, uint64_t hash, UserId id);
+    static void indexReserve(Index& index, size_t entries);
+    static uint64_t digest(const char* uid, const std::string& password);
+    bool insert(const std::string& uid, const std::string& email, uint64_t digest, double balance, UserId* out,
+                bool log);
+    // With a password, only a user whose digest matches counts as found
+    bool find(const std::string& key, bool by_email, UserId& out, const std::string* password = nullptr) const;
+    template <typename Fn> bool withUser(UserId id, Fn&& fn) const;
+    void append(const UserLogRecord& record);
+    void logBalance(UserLogType type, const User& user, double amount);
+
+    Shard shards_[kShards];
+    std::atomic<size_t> count_{0};
+    std::mutex create_mutex_; // creations are rare; serialising them keeps uid and email unique
+    std::mutex log_mutex_;
+    std::string log_path_;
+    FILE* log_ = nullptr;
+    std::atomic<size_t> log_records_{0};
+};
+
+template <typename Fn>
+bool UserStore::withUser(UserId id, Fn&& fn) const {
+    const Shard& shard = shards_[id & (kShards - 1)];
+    size_t local = id >> kShardBits;
+    std::shared_lock<std::shared_mutex> lock(shard.mutex);
+    if (local >= shard.users.size()) return false;
+    fn(shard.users[local]);
+    return true;
+}
+
 #endif //USER_PROFILE_H
@@ -0,0 +1,173 @@
+#include "profiler.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <mutex>
+
+namespace profiler {
+
+static constexpr uint32_t kNoThread = UINT32_MAX;
+
+static std::atomic<bool> g_enabled{true};
+static std::atomic<uint32_t> g_next_thread{0};
+static std::atomic<uint32_t> g_frame_thread{kNoThread};
+static thread_local uint32_t t_thread = kNoThread;
+static thread_local uint32_t t_depth = 0;
+
+// Only the frame thread touches the ring
+static Frame g_ring[kFrames];
+static size_t g_head = 0; // slot of the open frame, or of the next one between frames
+static size_t g_completed = 0;
+static bool g_open = false;
+static uint64_t g_number = 0;
+
+// Zones ended on other threads, waiting for endFrame()
+static std::mutex g_pending_mutex;
+static std::vector<Zone> g_pending;
+
+static uint32_t threadIndex() {
+    if (t_thread == kNoThread) t_thread = g_next_thread.fetch_add(1, std::memory_order_relaxed);
+    return t_thread;
+}
+
+uint64_t now() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+void setEnabled(bool enabled) {
+    g_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool enabled() {
+    return g_enabled.load(std::memory_order_relaxed);
+}
+
+uint64_t enter() {
+    ++t_depth;
+    return now();
+}
+
+void leave(const char* name, uint64_t start_ns) {
+    uint64_t end_ns = now();
+    uint32_t depth = --t_depth;
+    uint32_t thread = threadIndex();
+    uint32_t frame_thread = g_frame_thread.load(std::memory_order_relaxed);
+    if (frame_thread == kNoThread) return; // nothing runs frames, e.g. a headless bench
+    Zone zone{name, start_ns, end_ns, thread, depth};
+    if (thread == frame_thread) {
+        if (!g_open) return; // between frames, e.g. while the loop waits for events
+        Frame& open = g_ring[g_head];
+        if (open.zones.size() < kZonesPerFrame) {
+            open.zones.push_back(zone);
+        } else {
+            ++open.dropped;
+        }
+        return;
+    }
+    std::lock_guard<std::mutex> lock(g_pending_mutex);
+    if (g_pending.size() < kZonesPerFrame) g_pending.push_back(zone);
+}
+
+void beginFrame() {
+    if (!enabled()) return;
+    g_frame_thread.store(threadIndex(), std::memory_order_relaxed);
+    Frame& open = g_ring[g_head];
+    open.number = ++g_number;
+    open.start_ns = now();
+    open.end_ns = 0;
+    open.zones.clear(); // keeps capacity from the frame this slot held before
+    open.dropped = 0;
+    g_open = true;
+}
+
+void endFrame() {
+    if (!g_open) return;
+    Frame& open = g_ring[g_head];
+    open.end_ns = now();
+    {
+        std::lock_guard<std::mutex> lock(g_pending_mutex);
+        for (const Zone& zone : g_pending) {
+            if (open.zones.size() < kZonesPerFrame) {
+                open.zones.push_back(zone);
+            } else {
+                ++open.dropped;
+            }
+        }
+        g_pending.clear();
+    }
+    g_open = false;
+    g_head = (g_head + 1) % kFrames;
+    g_completed = std::min(g_completed + 1, kFrames);
+}
+
+size_t frameCount() {
+    // The slot at g_head is reused by the next frame, so one fewer than the ring holds
+    return std::min(g_completed, kFrames - 1);
+}
+
+const Frame& frame(size_t age) {
+    return g_ring[(g_head + kFrames - 1 - age) % kFrames];
+}
+
+uint32_t frameThread() {
+    return g_frame_thread.load(std::memory_order_relaxed);
+}
+
+static void writeString(std::ofstream& out, const char* text) {
+    out << '"';
+    for (const char* c = text; *c; ++c) {
+        if (*c == '"' || *c == '\\') out << '\\';
+        out << *c;
+    }
+    out << '"';
+}
+
+// Complete ("X") event; timestamps in microseconds from the oldest frame
+static void writeEvent(std::ofstream& out, const char* name, uint64_t start_ns, uint64_t end_ns, uint32_t thread,
+                       uint64_t origin_ns) {
+    out << ",\n{\"name\":";
+    writeString(out, name);
+    out << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << thread << ",\"ts\":" << (start_ns - origin_ns) / 1e3
+        << ",\"dur\":" << (end_ns - start_ns) / 1e3 << '}';
+}
+
+bool exportChromeTrace(const std::string& path) {
+    std::ofstream out(path);
+    if (!out) return false;
+    out.precision(15);
+    size_t count = frameCount();
+    uint64_t origin_ns = count > 0 ? frame(count - 1).start_ns : 0;
+    uint32_t frame_thread = frameThread();
+
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"TradingSimulator\"}}";
+    uint32_t threads = g_next_thread.load(std::memory_order_relaxed);
+    for (uint32_t thread = 0; thread < threads; ++thread) {
+        out << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << thread << ",\"args\":{\"name\":\"";
+        if (thread == frame_thread) {
+            out << "frame";
+        } else {
+            out << "thread " << thread;
+        }
+        out << "\"}}";
+    }
+    char label[32];
+    for (size_t age = count; age-- > 0;) {
+        const Frame& f = frame(age);
+        snprintf(label, sizeof(label), "Frame %llu", static_cast<unsigned long long>(f.number));
+        writeEvent(out, label, f.start_ns, f.end_ns, frame_thread, origin_ns);
+        for (const Zone& zone : f.zones) {
+            // Zones from other threads may have started, or even ended, before the oldest frame
+            uint64_t end_ns = std::max(zone.end_ns, origin_ns);
+            writeEvent(out, zone.name, std::min(std::max(zone.start_ns, origin_ns), end_ns), end_ns, zone.thread,
+                       origin_ns);
+        }
+    }
+    out << "\n]}\n";
+    return static_cast<bool>(out);
+}
+
+} // namespace profiler
@@ -0,0 +1,90 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Frame profiler. PROFILE_SCOPE("name") times the rest of the enclosing block as a zone.
+// Zones on the thread that calls beginFrame()/endFrame() belong to the open frame; zones
+// that end on other threads are attached to the frame that is open when endFrame() runs.
+// Until some thread has begun a frame, zones are dropped.
+// The last kFrames frames are kept in a ring whose zone buffers are reused, so steady-state
+// recording doesn't allocate. A zone costs two clock reads and a push_back (plus a lock off
+// the frame thread); with recording off, one atomic load. Names must be string literals:
+// only the pointer is stored.
+//
+// The ring is read and exported from the frame thread. Build with -DPROFILER_DISABLED to
+// compile every PROFILE_SCOPE out.
+
+namespace profiler {
+
+constexpr size_t kFrames = 300;
+constexpr size_t kZonesPerFrame = 4096;
+
+struct Zone {
+    const char* name;
+    uint64_t start_ns;
+    uint64_t end_ns;
+    uint32_t thread; // small index, in order of each thread's first zone
+    uint32_t depth;  // nesting on its thread, 0 outermost
+};
+
+struct Frame {
+    uint64_t number = 0;
+    uint64_t start_ns = 0;
+    uint64_t end_ns = 0;
+    std::vector<Zone> zones; // in the order they ended
+    uint32_t dropped = 0;    // zones past kZonesPerFrame
+};
+
+// Monotonic nanoseconds
+uint64_t now();
+
+// Off keeps the ring as it is, e.g. to inspect a spike
+void setEnabled(bool enabled);
+bool enabled();
+
+void beginFrame();
+void endFrame();
+
+// Completed frames, newest first: frame(0) is the last one ended
+size_t frameCount();
+const Frame& frame(size_t age);
+// Index of the thread that runs frames, for telling its zones apart
+uint32_t frameThread();
+
+// Every frame in the ring in Chrome's trace event format (chrome://tracing, Perfetto)
+bool exportChromeTrace(const std::string& path);
+
+uint64_t enter();
+void leave(const char* name, uint64_t start_ns);
+
+class Scope {
+public:
+    explicit Scope(const char* name) : name_(enabled() ? name : nullptr) {
+        if (name_) start_ns_ = enter();
+    }
+    ~Scope() {
+        if (name_) leave(name_, start_ns_);
+    }
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+private:
+    const char* name_;
+    uint64_t start_ns_ = 0;
+};
+
+} // namespace profiler
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#ifdef PROFILER_DISABLED
+#define PROFILE_SCOPE(name) ((void)0)
+#else
+#define PROFILE_SCOPE(name) ::profiler::Scope PROFILE_CONCAT(profile_scope_, __LINE__)(name)
+#endif
+
+#endif // PROFILER_H
@@ -0,0 +1,86 @@
+#include "thread_pool.h"
+#include <chrono>
+
+// Index of the pool queue owned by the current thread, or -1 outside the pool
+static thread_local long current_queue = -1;
+
+WorkStealingPool::WorkStealingPool(size_t threads) {
+    if (threads == 0) threads = 1;
+    for (size_t i = 0; i < threads; ++i) queues_.push_back(std::make_unique<Queue>());
+    for (size_t i = 0; i < threads; ++i) threads_.emplace_back([this, i] { workerLoop(i); });
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    wait();
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+        stopping_ = true;
+    }
+    work_available_.notify_all();
+    for (auto& thread : threads_) thread.join();
+}
+
+void WorkStealingPool::submit(std::function<void()> task) {
+    size_t target = current_queue >= 0 ? static_cast<size_t>(current_queue)
+                                       : next_queue_.fetch_add(1, std::memory_order_relaxed) % queues_.size();
+    pending_.fetch_add(1, std::memory_order_acq_rel);
+    {
+        std::lock_guard<std::mutex> lock(queues_[target]->mutex);
+        queues_[target]->tasks.push_back(std::move(task));
+    }
+    std::lock_guard<std::mutex> lock(sleep_mutex_);
+    work_available_.notify_one();
+}
+
+bool WorkStealingPool::runOne(size_t home) {
+    std::function<void()> task;
+    {
+        Queue& own = *queues_[home];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+        }
+    }
+    for (size_t offset = 1; !task && offset < queues_.size(); ++offset) {
+        Queue& victim = *queues_[(home + offset) % queues_.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+        }
+    }
+    if (!task) return false;
+
+    task();
+    if (pending_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+        all_done_.notify_all();
+    }
+    return true;
+}
+
+void WorkStealingPool::workerLoop(size_t index) {
+    current_queue = static_cast<long>(index);
+    while (true) {
+        if (runOne(index)) continue;
+        std::unique_lock<std::mutex> lock(sleep_mutex_);
+        if (stopping_) return;
+        if (pending_.load(std::memory_order_acquire) == 0) {
+            work_available_.wait(lock);
+        } else {
+            // Work exists but is running elsewhere; poll again shortly in case it spawns more
+            work_available_.wait_for(lock, std::chrono::microseconds(200));
+        }
+    }
+}
+
+void WorkStealingPool::wait() {
+    size_t home = current_queue >= 0 ? static_cast<size_t>(current_queue) : 0;
+    while (pending_.load(std::memory_order_acquire) > 0) {
+        if (runOne(home)) continue;
+        std::unique_lock<std::mutex> lock(sleep_mutex_);
+        all_done_.wait_for(lock, std::chrono::milliseconds(1),
+                           [&] { return pending_.load(std::memory_order_acquire) == 0; });
+    }
+}
@@ -0,0 +1,64 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Each worker has its own deque: it pops its newest task, and when it runs dry it steals
+// the oldest task from a neighbour. Uneven tasks (short vs long backtests) balance out
+// without a single shared queue everyone fights over.
+class WorkStealingPool {
+public:
+    explicit WorkStealingPool(size_t threads = std::thread::hardware_concurrency());
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    void submit(std::function<void()> task);
+    // Runs tasks on the calling thread too until everything submitted so far is done
+    void wait();
+    size_t size() const { return threads_.size(); }
+
+    // fn(i) for i in [0, n), in chunks of `grain` indices per task
+    template <typename Fn>
+    void parallelFor(size_t n, Fn fn, size_t grain = 1);
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    bool runOne(size_t home);
+    void workerLoop(size_t index);
+
+    std::vector<std::unique_ptr<Queue>> queues_;
+    std::vector<std::thread> threads_;
+    std::atomic<size_t> pending_{0};
+    std::atomic<size_t> next_queue_{0};
+    std::mutex sleep_mutex_;
+    std::condition_variable work_available_;
+    std::condition_variable all_done_;
+    bool stopping_ = false;
+};
+
+template <typename Fn>
+void WorkStealingPool::parallelFor(size_t n, Fn fn, size_t grain) {
+    if (grain == 0) grain = 1;
+    for (size_t begin = 0; begin < n; begin += grain) {
+        size_t end = begin + grain < n ? begin + grain : n;
+        submit([fn, begin, end] {
+            for (size_t i = begin; i < end; ++i) fn(i);
+        });
+    }
+    wait();
+}
+
+#endif // THREAD_POOL_H